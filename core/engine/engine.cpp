@@ -421,85 +421,148 @@ rt_void print_lst(rt_pstr mgn, rt_ELEM *elm)
 /******************************************************************************/
 
 /*
- * Initialize platform-specific pool of "thnum" threads (< 0 - no feedback).
- * Local stub below is used when platform threading functions are not provided
- * or during state-logging.
+ * Task of the default thread-pool,
+ * run update/render phase on the current scene's slice.
+ */
+static
+rt_void pool_task(rt_pntr arg, rt_si32 index, rt_si32 cmd)
+{
+    rt_Scene *scn = ((rt_Platform *)arg)->get_cur_scene();
+
+    switch (cmd & 0x3)
+    {
+        case 1:
+        scn->update_slice(index, (cmd >> 2) & 0xFF);
+        break;
+
+        case 2:
+        scn->render_slice(index, (cmd >> 2) & 0xFF);
+        break;
+
+        default:
+        break;
+    };
+}
+
+/*
+ * Task of scene's own thread-group in platform's split mode,
+ * run update/render phase on the scene's slice.
+ */
+static
+rt_void group_task(rt_pntr arg, rt_si32 index, rt_si32 cmd)
+{
+    rt_Scene *scn = (rt_Scene *)arg;
+
+    switch (cmd & 0x3)
+    {
+        case 1:
+        scn->update_slice(index, (cmd >> 2) & 0xFF);
+        break;
+
+        case 2:
+        scn->render_slice(index, (cmd >> 2) & 0xFF);
+        break;
+
+        default:
+        break;
+    };
+}
+
+/*
+ * Initialize default pool of "thnum" threads (< 0 - no feedback).
+ * Used when platform threading functions are not provided.
  */
 static
 rt_void* init_threads(rt_si32 thnum, rt_Platform *pfm)
 {
-    if (thnum > 0)
+    rt_ThreadPool *pool = new rt_ThreadPool(thnum, pool_task, pfm,
+                                            RT_SETAFFINITY, RT_SPIN_COUNT);
+    rt_si32 i;
+
+    for (i = 0; i < pool->get_thnum(); i++)
     {
-        pfm->set_thnum(thnum); /* dummy feedback, pass core-count in platform */
+        pfm->set_node(i, pool->get_node(i));
     }
 
-    return pfm;
+    pfm->set_thnum(pool->get_thnum()); /* feedback, core-count if clamped */
+
+    return pool;
 }
 
 /*
- * Terminate platform-specific pool of "thnum" threads.
- * Local stub below is used when platform threading functions are not provided
- * or during state-logging.
+ * Terminate default pool of "thnum" threads.
+ * Used when platform threading functions are not provided.
  */
 static
-rt_void term_threads(rt_void *tdata, rt_si32 thnum)
+rt_void term_threads(rt_void *tdata, rt_si32 /* thnum */)
 {
+    delete (rt_ThreadPool *)tdata;
+}
 
+/*
+ * Task default pool of "thnum" threads to update scene,
+ * block until finished.
+ * Used when platform threading functions are not provided.
+ */
+static
+rt_void update_threads(rt_void *tdata, rt_si32 /* thnum */, rt_si32 phase)
+{
+    ((rt_ThreadPool *)tdata)->run(1 | ((phase & 0xFF) << 2));
 }
 
 /*
- * Task platform-specific pool of "thnum" threads to update scene,
+ * Task default pool of "thnum" threads to render scene,
  * block until finished.
- * Local stub below is used when platform threading functions are not provided
- * or during state-logging. Simulate threading with sequential run.
+ * Used when platform threading functions are not provided.
  */
 static
-rt_void update_scene(rt_void *tdata, rt_si32 thnum, rt_si32 phase)
+rt_void render_threads(rt_void *tdata, rt_si32 /* thnum */, rt_si32 phase)
 {
-    rt_Scene *scn;
+    ((rt_ThreadPool *)tdata)->run(2 | ((phase & 0xFF) << 2));
+}
 
-    if (thnum < 0)
-    {
-        scn = (rt_Scene *)tdata;
-        thnum = -thnum;
-    }
-    else
-    {
-        scn = ((rt_Platform *)tdata)->get_cur_scene();
-    }
+/*
+ * Update scene's "thnum" (< 0) slices sequentially in the calling thread.
+ * Local stub below is used during state-logging or when multi-threading
+ * is disabled in scene's optimization flags.
+ */
+static
+rt_void update_scene(rt_void *tdata, rt_si32 thnum, rt_si32 phase)
+{
+    rt_Scene *scn = (rt_Scene *)tdata;
 
     rt_si32 i;
 
-    for (i = 0; i < thnum; i++)
+    for (i = 0; i < RT_ABS32(thnum); i++)
     {
         scn->update_slice(i, phase);
     }
 }
 
 /*
- * Task platform-specific pool of "thnum" threads to render scene,
- * block until finished.
- * Local stub below is used when platform threading functions are not provided
- * or during state-logging. Simulate threading with sequential run.
+ * Update scene's "thnum" slices on the render threads running
+ * the pipelined update, called from the leading one.
+ * Local stub below replaces scene's update function for the update.
  */
 static
-rt_void render_scene(rt_void *tdata, rt_si32 thnum, rt_si32 phase)
+rt_void update_pipes(rt_void *tdata, rt_si32 thnum, rt_si32 phase)
 {
-    rt_Scene *scn;
+    ((rt_Scene *)tdata)->update_pipe(thnum - 1, phase);
+}
 
-    if (thnum < 0)
-    {
-        scn = (rt_Scene *)tdata;
-        thnum = -thnum;
-    }
-    else
-    {
-        scn = ((rt_Platform *)tdata)->get_cur_scene();
-    }
+/*
+ * Render scene's "thnum" (< 0) slices sequentially in the calling thread.
+ * Local stub below is used during state-logging or when multi-threading
+ * is disabled in scene's optimization flags.
+ */
+static
+rt_void render_scene(rt_void *tdata, rt_si32 thnum, rt_si32 phase)
+{
+    rt_Scene *scn = (rt_Scene *)tdata;
 
     rt_si32 i;
 
-    for (i = 0; i < thnum; i++)
+    for (i = 0; i < RT_ABS32(thnum); i++)
     {
         scn->render_slice(i, phase);
     }
@@ -522,6 +585,7 @@ rt_Platform::rt_Platform(rt_FUNC_ALLOC f_alloc, rt_FUNC_FREE f_free,
 {
     /* init scene list variables */
     head = tail = cur = RT_NULL;
+    split = 0;
 
     /* allocate root SIMD structure */
     s_inf = (rt_SIMD_INFOX *)
@@ -550,8 +614,11 @@ rt_Platform::rt_Platform(rt_FUNC_ALLOC f_alloc, rt_FUNC_FREE f_free,
     {
         this->f_init = init_threads;
         this->f_term = term_threads;
-        this->f_update = update_scene;
-        this->f_render = render_scene;
+        this->f_update = update_threads;
+        this->f_render = render_threads;
+
+        /* default pool takes all allowed CPUs unless told otherwise */
+        thnum = thnum != 0 ? thnum : RT_THREADS_NUM;
     }
 
     /* init thread management variables */
@@ -559,20 +626,33 @@ rt_Platform::rt_Platform(rt_FUNC_ALLOC f_alloc, rt_FUNC_FREE f_free,
     this->thnum = thnum < 0 ? thnum : -thnum; /* always < 0 at first init */
     this->tdata = RT_NULL;
 
+    /* init thread-to-node map, filled by f_init if topology is known */
+    thsize = thnum < 0 ? -thnum : thnum;
+    thnode = (rt_si32 *)
+            alloc(sizeof(rt_si32) * thsize, RT_ALIGN);
+
+    rt_si32 i;
+
+    for (i = 0; i < thsize; i++)
+    {
+        thnode[i] = -1;
+    }
+
     /* create platform-specific worker threads */
     tdata = this->f_init(thnum, this);
     thnum = this->thnum;
     this->thnum = thnum < 0 ? -thnum : thnum; /* always > 0 upon feedback */
 
-    /* init tile dimensions */
-    tile_w = RT_MAX(RT_TILE_W, 1);
-    tile_h = RT_MAX(RT_TILE_H, 1);
-    tile_w = ((tile_w + RT_SIMD_WIDTH - 1) / RT_SIMD_WIDTH) * RT_SIMD_WIDTH;
-
     /* init rendering backend,
      * default SIMD runtime target will be chosen */
     fsaa  = RT_FSAA_NO;
+    pack  = 0;
+    filt  = 0;
     set_simd(0);
+
+    /* init tile dimensions once
+     * available targets are known */
+    set_tile(RT_TILE_W, RT_TILE_H);
 }
 
 /*
@@ -596,6 +676,25 @@ rt_si32 rt_Platform::set_thnum(rt_si32 thnum)
     return this->thnum;
 }
 
+/*
+ * Get NUMA node of thread with given "index" (< 0 - unknown).
+ */
+rt_si32 rt_Platform::get_node(rt_si32 index)
+{
+    return index >= 0 && index < thsize ? thnode[index] : -1;
+}
+
+/*
+ * Set NUMA node of thread with given "index" (only from within f_init).
+ */
+rt_void rt_Platform::set_node(rt_si32 index, rt_si32 node)
+{
+    if (index >= 0 && index < thsize)
+    {
+        thnode[index] = node;
+    }
+}
+
 /*
  * Initialize SIMD target-selection variable from parameters.
  */
@@ -661,6 +760,44 @@ rt_si32 rt_Platform::get_fsaa()
     return fsaa;
 }
 
+/*
+ * Set primary rays layout, 0 - scanline strips,
+ * 1 - packed square blocks of pixels per SIMD vector.
+ */
+rt_si32 rt_Platform::set_pack(rt_si32 pack)
+{
+    this->pack = pack != 0;
+
+    return this->pack;
+}
+
+/*
+ * Get primary rays layout.
+ */
+rt_si32 rt_Platform::get_pack()
+{
+    return pack;
+}
+
+/*
+ * Set texture filtering mode, 0 - nearest texel,
+ * 1 - bilinear from mip-level chosen by ray footprint.
+ */
+rt_si32 rt_Platform::set_filt(rt_si32 filt)
+{
+    this->filt = filt != 0;
+
+    return this->filt;
+}
+
+/*
+ * Get texture filtering mode.
+ */
+rt_si32 rt_Platform::get_filt()
+{
+    return filt;
+}
+
 /*
  * Get maximmum antialiasing mode
  * for chosen SIMD target.
@@ -688,6 +825,47 @@ rt_si32 rt_Platform::get_tile_w()
     return tile_w;
 }
 
+/*
+ * Return tile height in pixels.
+ */
+rt_si32 rt_Platform::get_tile_h()
+{
+    return tile_h;
+}
+
+/*
+ * Set tile dimensions in pixels for scenes constructed afterwards,
+ * width is rounded up to a multiple of the widest SIMD target
+ * available at runtime (rather than compiled in), so that
+ * any target selected later with "set_simd" fits the tile.
+ * Return actual tile width.
+ */
+rt_si32 rt_Platform::set_tile(rt_si32 tile_w, rt_si32 tile_h)
+{
+    rt_si32 i, simd, width = 1;
+
+    for (i = 0; i < 32; i++)
+    {
+        if ((s_mask & (1 << i)) == 0)
+        {
+            continue;
+        }
+
+        simd = from_mask(1 << i);
+        simd = ((simd & 0xFF) * ((simd >> 16) & 0xFF) * 128) / RT_ELEMENT;
+
+        width = RT_MAX(width, simd);
+    }
+
+    tile_w = RT_MAX(tile_w, 1);
+    tile_h = RT_MAX(tile_h, 1);
+
+    this->tile_w = ((tile_w + width - 1) / width) * width;
+    this->tile_h = tile_h;
+
+    return this->tile_w;
+}
+
 /*
  * Add given "scn" to platform's scene list.
  */
@@ -704,6 +882,8 @@ rt_void rt_Platform::add_scene(rt_Scene *scn)
     }
 
     scn->next = RT_NULL;
+
+    split_threads();
 }
 
 /*
@@ -732,6 +912,8 @@ rt_void rt_Platform::del_scene(rt_Scene *scn)
     {
         cur = head;
     }
+
+    split_threads();
 }
 
 /*
@@ -781,6 +963,87 @@ rt_void rt_Platform::next_scene()
     }
 }
 
+/*
+ * Return platform's split mode.
+ */
+rt_si32 rt_Platform::get_split()
+{
+    return split;
+}
+
+/*
+ * Set platform's split mode, when enabled threads are divided between
+ * scenes and each scene renders on its own thread-group (pinned to its own
+ * subset of CPUs), so that scenes can render concurrently via render_async,
+ * when disabled only the current scene renders on platform's pool.
+ * Takes effect in each scene on its next render.
+ */
+rt_si32 rt_Platform::set_split(rt_si32 split)
+{
+    this->split = split != 0 ? 1 : 0;
+
+    split_threads();
+
+    return this->split;
+}
+
+/*
+ * Divide platform's threads between scenes for split mode:
+ * explicit budgets are granted (scaled down if they don't fit),
+ * remaining threads are shared evenly by scenes without budget,
+ * each scene gets at least one thread, groups follow each other
+ * and wrap around if there are more scenes than threads.
+ */
+rt_void rt_Platform::split_threads()
+{
+    rt_Scene *scn;
+    rt_si32 n_auto = 0, req = 0, avail, rest, first = 0, k;
+
+    for (scn = head; scn != RT_NULL; scn = scn->next)
+    {
+        if (scn->gbudget > 0)
+        {
+            req += RT_MIN(scn->gbudget, thnum);
+        }
+        else
+        {
+            n_auto++;
+        }
+    }
+
+    /* leave at least one thread per scene without budget */
+    avail = RT_MAX(thnum - n_auto, 0);
+    rest = thnum;
+
+    for (scn = head; scn != RT_NULL; scn = scn->next)
+    {
+        if (scn->gbudget > 0)
+        {
+            k = RT_MIN(scn->gbudget, thnum);
+            k = req > avail ? k * avail / req : k;
+
+            scn->gnum = RT_MAX(k, 1);
+            rest -= scn->gnum;
+        }
+    }
+
+    rest = RT_MAX(rest, 0);
+
+    for (k = 0, scn = head; scn != RT_NULL; scn = scn->next)
+    {
+        if (scn->gbudget <= 0)
+        {
+            /* fair share, first scenes take the remainder */
+            scn->gnum = rest / n_auto + (k < rest % n_auto ? 1 : 0);
+            scn->gnum = RT_MAX(scn->gnum, 1);
+            k++;
+        }
+
+        scn->gfirst = first;
+        first = (first + scn->gnum) % thnum;
+    }
+}
+
 /*
  * Deinitialize platform.
  */
@@ -824,6 +1087,9 @@ rt_SceneThread::rt_SceneThread(rt_Scene *scene, rt_si32 index) :
     this->scene = scene;
     this->index = index;
 
+    /* keep thread's data on its NUMA node */
+    set_node(scene->pfm->get_node(index));
+
     /* allocate root SIMD structure */
     s_inf = (rt_SIMD_INFOX *)
             alloc(sizeof(rt_SIMD_INFOX),
@@ -845,8 +1111,8 @@ rt_SceneThread::rt_SceneThread(rt_Scene *scene, rt_si32 index) :
     s_inf->frame   = scene->frame;
 
     /* init tilebuffer's dimensions and pointer */
-    s_inf->tile_w  = scene->pfm->tile_w;
-    s_inf->tile_h  = scene->pfm->tile_h;
+    s_inf->tile_w  = scene->tile_w;
+    s_inf->tile_h  = scene->tile_h;
     s_inf->tls_row = scene->tiles_in_row;
     s_inf->tiles   = scene->tiles;
 
@@ -919,11 +1185,76 @@ rt_SceneThread::rt_SceneThread(rt_Scene *scene, rt_si32 index) :
     /* estimates are done in Scene once all counters have been initialized */
     msize = 0;
 
+    /* lists kept across frames start with the first full rebuild */
+    lpool = RT_NULL;
+    l_chg = 0;
+    l_num = 0;
+    ppool = RT_NULL;
+
+    /* init thread's render-phase profiling counters */
+    t_last = 0;
+    t_busy = 0;
+    t_idle = 0;
+
+    t_phase[0] = t_phase[1] = 0;
+    c_phase[0] = c_phase[1] = 0;
+
+    /* allocate lane occupancy counters, one entry per remaining depth */
+    s_occ = (rt_elem *)
+            alloc(2 * RT_SIMD_WIDTH * sizeof(rt_elem) * (1 + scene->depth),
+                            RT_SIMD_ALIGN);
+
+    memset(s_occ, 0, 2 * RT_SIMD_WIDTH * sizeof(rt_elem) * (1 + scene->depth));
+
+    /* counting is off until enabled with "set_occ" */
+    s_inf->occ = RT_NULL;
+
     /* allocate misc arrays for tiling */
     txmin = (rt_si32 *)alloc(sizeof(rt_si32) * scene->tiles_in_col, RT_ALIGN);
     txmax = (rt_si32 *)alloc(sizeof(rt_si32) * scene->tiles_in_col, RT_ALIGN);
     verts = (rt_VERT *)alloc(sizeof(rt_VERT) * 
                              (2 * RT_VERTS_LIMIT + RT_EDGES_LIMIT), RT_ALIGN);
+
+    /* allocate cones' hash-table for sorting, at most half-full
+     * with surfaces' and arrays' (trnode/bvnode/inner) bounds */
+    rt_si32 n = (scene->srf_num + scene->arr_num * 3) * 2;
+
+    for (c_bits = 4; (1 << c_bits) < n; c_bits++);
+
+    cones = (rt_VCONE *)alloc(sizeof(rt_VCONE) << c_bits, RT_ALIGN);
+    memset(cones, 0, sizeof(rt_VCONE) << c_bits);
+
+    c_num = 0;
+    c_tag = 0;
+    c_obj = RT_NULL;
+
+    nodes = (rt_ELEM **)alloc(sizeof(rt_ELEM *) << c_bits, RT_ALIGN);
+    memset(nodes, 0, sizeof(rt_ELEM *) << c_bits);
+
+    n_num = 0;
+
+    /* allocate cursors of gridded runs for the deepest hierarchy,
+     * candidates' bitmaps of nested runs never exceed all nodes */
+    n = scene->arr_num + 2;
+
+    g_use = 0;
+    g_grd = (rt_GRID **)alloc(sizeof(rt_GRID *) * n, RT_ALIGN);
+    g_pos = (rt_si32 *)alloc(sizeof(rt_si32) * n, RT_ALIGN);
+    g_ofs = (rt_si32 *)alloc(sizeof(rt_si32) * n, RT_ALIGN);
+
+    /* allocate pending nodes of relinked lists, nested as deep */
+    l_end = (rt_ELEM **)alloc(sizeof(rt_ELEM *) * n, RT_ALIGN);
+    l_elm = (rt_ELEM **)alloc(sizeof(rt_ELEM *) * n, RT_ALIGN);
+
+    n += (scene->srf_num + scene->arr_num * 3 + 31) / 32;
+
+    g_bit = (rt_ui32 *)alloc(sizeof(rt_ui32) * n, RT_ALIGN);
+
+    n = (scene->srf_num + scene->arr_num * 3 + 31) / 32;
+
+    q_box = RT_NULL;
+    q_grd = RT_NULL;
+    q_bit = (rt_ui32 *)alloc(sizeof(rt_ui32) * n, RT_ALIGN);
 }
 
 #define RT_UPDATE_TILES_BOUNDS(cy, x1, x2)                                  \
@@ -1106,6 +1437,101 @@ rt_void rt_SceneThread::tiling(rt_vec2 p1, rt_vec2 p2)
     }
 }
 
+/*
+ * Return cone of "nd's" bounding sphere as seen from "obj",
+ * computed once per sorting pass for a given "obj".
+ * Return NULL if the hash-table is full (cone is computed by the caller).
+ */
+rt_VCONE* rt_SceneThread::cone(rt_Object *obj, rt_BOUND *nd)
+{
+    /* new "obj" starts new sorting pass,
+     * cones of the previous pass become stale */
+    if (c_obj != obj->bvbox)
+    {
+        c_obj = obj->bvbox;
+        c_tag++;
+        c_num = 0;
+    }
+
+    rt_ui32 i = ((rt_ui32)((rt_word)nd >> 4) * 2654435761U) >> (32 - c_bits);
+    rt_ui32 m = (1 << c_bits) - 1;
+
+    /* linear probing within current pass */
+    for (; cones[i].tag == c_tag; i = (i + 1) & m)
+    {
+        if (cones[i].nd == nd && cones[i].ob == c_obj)
+        {
+            return &cones[i];
+        }
+    }
+
+    if (c_num * 2 >= (1 << c_bits))
+    {
+        return RT_NULL;
+    }
+
+    c_num++;
+
+    cones[i].nd  = nd;
+    cones[i].ob  = c_obj;
+    cones[i].tag = c_tag;
+    bbox_cone(c_obj, nd, &cones[i]);
+
+    return &cones[i];
+}
+
+/*
+ * Return non-zero if "nd" is a surface with custom clippers,
+ * then its clip relations may order it in "bbox_sort"
+ * regardless of the cones (RT_OPTS_INSERT_EXT2).
+ */
+static
+rt_si32 node_clip(rt_BOUND *nd)
+{
+    return RT_IS_SURFACE(nd) && *((rt_SHAPE *)nd)->ptr != RT_NULL;
+}
+
+/*
+ * Determine the order of "nd1" and "nd2" as seen from "obj"
+ * using cones cached for the current sorting pass.
+ */
+rt_si32 rt_SceneThread::order(rt_Object *obj, rt_BOUND *nd1, rt_BOUND *nd2)
+{
+    /* nodes not found by the grid query for the node being inserted
+     * are outside of its cone, thus neutral to it without "bbox_sort" */
+    if (nd1 == q_box && nd2 != nd1
+    &&  (q_bit[nd2->idx >> 5] & (rt_ui32)1 << (nd2->idx & 31)) == 0)
+    {
+        return 3;
+    }
+
+    return bbox_sort(obj->bvbox, nd1, nd2, cone(obj, nd1), cone(obj, nd2));
+}
+
+/*
+ * Return hash-table slot of trnode/bvnode element with bounds "box"
+ * in the sub-list of "prv" element (top-level list if "prv" is NULL),
+ * slot is empty if such element hasn't been inserted yet.
+ */
+rt_ELEM** rt_SceneThread::search(rt_ELEM *prv, rt_pntr box)
+{
+    rt_ui32 i = ((rt_ui32)((rt_word)box >> 4) * 2654435761U
+              ^  (rt_ui32)((rt_word)prv >> 4) * 2246822519U) >> (32 - c_bits);
+    rt_ui32 m = (1 << c_bits) - 1;
+
+    /* linear probing, elements are never removed within the pass */
+    for (; nodes[i] != RT_NULL; i = (i + 1) & m)
+    {
+        if (nodes[i]->temp == box
+        &&  (rt_ELEM *)RT_GET_PTR(nodes[i]->data) == prv)
+        {
+            break;
+        }
+    }
+
+    return &nodes[i];
+}
+
 /*
  * Insert new element derived from "tem" to a list "ptr"
  * for a given object "obj". If "tem" is NULL and "obj" is LIGHT,
@@ -1163,8 +1589,22 @@ rt_ELEM* rt_SceneThread::insert(rt_Object *obj, rt_ELEM **ptr, rt_ELEM *tem)
         /* search matching existing trnode/bvnode for insertion,
          * run through the list hierarchy to find the inner-most node element,
          * element's "simd" field holds pointer to node's sub-list
-         * along with node's type in the lower 4 bits (tr/bv) */
-        for (nxt = RT_GET_PTR(*ptr); nxt != RT_NULL && lst != RT_NULL;)
+         * along with node's type in the lower 4 bits (tr/bv),
+         * use hash-table to avoid scanning each sub-list in the hierarchy */
+        for (; n_num >= 0 && lst != RT_NULL; lst = lst->next)
+        {
+            nxt = *search(prv, lst->temp);
+            if (nxt == RT_NULL)
+            {
+                break;
+            }
+            prv = nxt;
+            /* set insertion point to existing node's sub-list */
+            ptr = RT_GET_ADR(nxt->simd);
+        }
+        /* fall back to linear search if hash-table has overflown */
+        for (nxt = n_num >= 0 ? RT_NULL : RT_GET_PTR(*ptr);
+             nxt != RT_NULL && lst != RT_NULL;)
         {
             if (nxt->temp == lst->temp)
             {
@@ -1200,6 +1640,17 @@ rt_ELEM* rt_SceneThread::insert(rt_Object *obj, rt_ELEM **ptr, rt_ELEM *tem)
             /* insert element according to found position */
             nxt->next = RT_GET_PTR(*ptr);
             RT_SET_PTR(*ptr, rt_ELEM *, nxt);
+            /* register new element in the hash-table
+             * for as long as it is at most half-full */
+            if (n_num >= 0 && n_num * 2 < (1 << c_bits))
+            {
+                n_num++;
+               *search(prv, lst->temp) = nxt;
+            }
+            else
+            {
+                n_num = -1;
+            }
             /* set insertion point to new node's sub-list */
             ptr = RT_GET_ADR(nxt->simd);
             prv = nxt;
@@ -1234,6 +1685,10 @@ rt_ELEM* rt_SceneThread::insert(rt_Object *obj, rt_ELEM **ptr, rt_ELEM *tem)
         return elm;
     }
 
+    /* find nodes of "elm's" gridded run which overlap its cone,
+     * others are neutral to "elm" in the phases below */
+    gcone(obj, tem);
+
     /* "state" helps avoiding stored-order-value re-computation
      * when the whole sub-list is being moved without interruption,
      * the term sub-list used here and below refers to a continuous portion
@@ -1247,7 +1702,7 @@ rt_ELEM* rt_SceneThread::insert(rt_Object *obj, rt_ELEM **ptr, rt_ELEM *tem)
     for (nxt = elm->next; nxt != RT_NULL; )
     {
         /* compute the order value between "elm" and "nxt" elements */
-        rt_cell op = 7 & bbox_sort(obj->bvbox,
+        rt_cell op = 7 & order(obj,
                      (rt_BOUND *)elm->temp,
                      (rt_BOUND *)nxt->temp);
         switch (op)
@@ -1269,7 +1724,7 @@ rt_ELEM* rt_SceneThread::insert(rt_Object *obj, rt_ELEM **ptr, rt_ELEM *tem)
                 else
                 {
                     RT_SET_FLG(prv->data, rt_cell,
-                         3 & bbox_sort(obj->bvbox,
+                         3 & order(obj,
                          (rt_BOUND *)prv->temp,
                          (rt_BOUND *)nxt->temp));
                 }
@@ -1307,7 +1762,7 @@ rt_ELEM* rt_SceneThread::insert(rt_Object *obj, rt_ELEM **ptr, rt_ELEM *tem)
                 else
                 {
                     RT_SET_FLG(prv->data, rt_cell,
-                         3 & bbox_sort(obj->bvbox,
+                         3 & order(obj,
                          (rt_BOUND *)prv->temp,
                          (rt_BOUND *)nxt->temp));
                 }
@@ -1350,7 +1805,7 @@ rt_ELEM* rt_SceneThread::insert(rt_Object *obj, rt_ELEM **ptr, rt_ELEM *tem)
     {
         rt_bool gr = RT_FALSE;
         /* compute the order value between "elm" and "nxt" elements */
-        rt_cell op = 7 & bbox_sort(obj->bvbox,
+        rt_cell op = 7 & order(obj,
                      (rt_BOUND *)elm->temp,
                      (rt_BOUND *)nxt->temp);
         switch (op)
@@ -1368,7 +1823,7 @@ rt_ELEM* rt_SceneThread::insert(rt_Object *obj, rt_ELEM **ptr, rt_ELEM *tem)
             if (RT_GET_FLG(cur->data) == 0 && cur != tlp)
             {
                 RT_SET_FLG(cur->data, rt_cell,
-                     3 & bbox_sort(obj->bvbox,
+                     3 & order(obj,
                      (rt_BOUND *)cur->temp,
                      (rt_BOUND *)nxt->temp));
             }
@@ -1384,7 +1839,7 @@ rt_ELEM* rt_SceneThread::insert(rt_Object *obj, rt_ELEM **ptr, rt_ELEM *tem)
                 {
                     ipt = tlp->next;
                     RT_SET_FLG(tlp->data, rt_cell,
-                         3 & bbox_sort(obj->bvbox,
+                         3 & order(obj,
                          (rt_BOUND *)tlp->temp,
                          (rt_BOUND *)ipt->temp));
                 }
@@ -1438,7 +1893,7 @@ rt_ELEM* rt_SceneThread::insert(rt_Object *obj, rt_ELEM **ptr, rt_ELEM *tem)
                         /* compute new order value */
                         else
                         {
-                            op = 3 & bbox_sort(obj->bvbox,
+                            op = 3 & order(obj,
                                  (rt_BOUND *)cur->temp,
                                  (rt_BOUND *)jel->temp);
                         }
@@ -1505,7 +1960,7 @@ rt_ELEM* rt_SceneThread::insert(rt_Object *obj, rt_ELEM **ptr, rt_ELEM *tem)
                         {
                             cur = iel->next;
                             RT_SET_FLG(iel->data, rt_cell,
-                                 3 & bbox_sort(obj->bvbox,
+                                 3 & order(obj,
                                  (rt_BOUND *)iel->temp,
                                  (rt_BOUND *)cur->temp));
                         }
@@ -1522,7 +1977,7 @@ rt_ELEM* rt_SceneThread::insert(rt_Object *obj, rt_ELEM **ptr, rt_ELEM *tem)
                 {
                     cur = ipt->next;
                     RT_SET_FLG(ipt->data, rt_cell,
-                         3 & bbox_sort(obj->bvbox,
+                         3 & order(obj,
                          (rt_BOUND *)ipt->temp,
                          (rt_BOUND *)cur->temp));
                 }
@@ -1545,7 +2000,7 @@ rt_ELEM* rt_SceneThread::insert(rt_Object *obj, rt_ELEM **ptr, rt_ELEM *tem)
                 else
                 {
                     RT_SET_FLG(prv->data, rt_cell,
-                         3 & bbox_sort(obj->bvbox,
+                         3 & order(obj,
                          (rt_BOUND *)prv->temp,
                          (rt_BOUND *)cur->temp));
                 }
@@ -1592,7 +2047,7 @@ rt_ELEM* rt_SceneThread::insert(rt_Object *obj, rt_ELEM **ptr, rt_ELEM *tem)
             if (RT_GET_FLG(cur->data) == 0 && cur != tlp)
             {
                 RT_SET_FLG(cur->data, rt_cell,
-                     3 & bbox_sort(obj->bvbox,
+                     3 & order(obj,
                      (rt_BOUND *)cur->temp,
                      (rt_BOUND *)nxt->temp));
             }
@@ -1609,7 +2064,7 @@ rt_ELEM* rt_SceneThread::insert(rt_Object *obj, rt_ELEM **ptr, rt_ELEM *tem)
                 {
                     cur = tlp->next;
                     RT_SET_FLG(tlp->data, rt_cell,
-                         3 & bbox_sort(obj->bvbox,
+                         3 & order(obj,
                          (rt_BOUND *)tlp->temp,
                          (rt_BOUND *)cur->temp));
                 }
@@ -1635,7 +2090,7 @@ rt_ELEM* rt_SceneThread::insert(rt_Object *obj, rt_ELEM **ptr, rt_ELEM *tem)
     if (RT_GET_FLG(tlp->data) == 0 && cur != RT_NULL)
     {
         RT_SET_FLG(tlp->data, rt_cell,
-             3 & bbox_sort(obj->bvbox,
+             3 & order(obj,
              (rt_BOUND *)tlp->temp,
              (rt_BOUND *)cur->temp));
     }
@@ -1741,10 +2196,12 @@ rt_ELEM* rt_SceneThread::filter(rt_Object *obj, rt_ELEM **ptr)
  */
 rt_void rt_SceneThread::snode(rt_Surface *srf)
 {
-    /* as temporary memory pool is released after every frame,
-     * always rebuild the list even if the scene hasn't changed */
+    /* list is kept across frames in thread's heap,
+     * scene calls for rebuild only if surface has changed */
+
+    /* keep and reset surface's trnode/bvnode list */
+    rt_ELEM *top = srf->top, *trn = srf->trn;
 
-    /* reset surface's trnode/bvnode list */
     srf->top = RT_NULL;
     srf->trn = RT_NULL;
 
@@ -1811,6 +2268,25 @@ rt_void rt_SceneThread::snode(rt_Surface *srf)
         elm->next = srf->top;
         srf->top = elm;
     }
+
+    /* kept list was released if all lists are rebuilt */
+    if ((scene->lmode & RT_LISTS_NEW) != 0)
+    {
+        return;
+    }
+
+    /* compare with the kept list, as any difference
+     * changes the hierarchy of the global list
+     * and all lists built from it */
+    for (elm = srf->top; elm != RT_NULL && top != RT_NULL &&
+         elm->temp == top->temp && elm->simd == top->simd;
+         elm = elm->next, top = top->next);
+
+    if (elm != RT_NULL || top != RT_NULL
+    || (srf->trn == RT_NULL) != (trn == RT_NULL))
+    {
+        l_chg |= RT_LISTS_NEW;
+    }
 }
 
 /*
@@ -1820,8 +2296,8 @@ rt_void rt_SceneThread::snode(rt_Surface *srf)
  */
 rt_void rt_SceneThread::sclip(rt_Surface *srf)
 {
-    /* as temporary memory pool is released after every frame,
-     * always rebuild the list even if the scene hasn't changed */
+    /* list is kept across frames in thread's heap,
+     * scene calls for rebuild only if surfaces have changed */
 
     /* init surface's relations template */
     rt_ELEM *lst = srf->rel;
@@ -1967,19 +2443,21 @@ rt_void rt_SceneThread::stile(rt_Surface *srf)
         return;
     }
 
-    rt_ELEM *elm;
     rt_si32 i, j;
-    rt_si32 k;
+    rt_si32 k, h, t;
 
     rt_vec4 vec;
-    rt_real dot;
+    rt_real dot, zed;
     rt_si32 ndx[2];
-    rt_real tag[2], zed[2];
+    rt_VERT tmp;
 
     /* "verts_num" may grow, use "srf->verts_num" if original is needed */
     rt_si32 verts_num = srf->bvbox->verts_num;
     rt_VERT *vrt = srf->bvbox->verts;
 
+    /* convex hull's vertex indices, closed (last equals first) */
+    rt_si32 hul[2 * RT_VERTS_LIMIT + RT_EDGES_LIMIT + 1];
+
     /* project bbox onto the tilebuffer */
     if (verts_num != 0)
     {
@@ -1989,111 +2467,130 @@ rt_void rt_SceneThread::stile(rt_Surface *srf)
             txmax[i] = -1;
         }
 
-        /* process bbox vertices */
-        memset(verts, 0, sizeof(rt_VERT) *
-                         (2 * verts_num + srf->bvbox->edges_num));
-
-        for (k = 0; k < srf->bvbox->verts_num; k++)
+        /* process bbox vertices in a single pass (scalar, at most
+         * RT_VERTS_LIMIT vertices), projections of vertices behind
+         * screen plane are computed as well (with clamped divisor),
+         * but are discarded with their tags */
+        for (k = 0; k < verts_num; k++)
         {
             RT_VEC3_SUB(vec, vrt[k].pos, scene->org);
 
-            dot = RT_VEC3_DOT(vec, scene->nrm);
-
-            verts[k].pos[RT_Z] = dot;
-            verts[k].pos[RT_W] = -1.0f; /* tag: behind screen plane */
-
-            /* process vertices in front of or near screen plane,
-             * the rest are processed with edges */
-            if (dot >= 0.0f || RT_FABS(dot) <= RT_CLIP_THRESHOLD)
-            {
-                RT_VEC3_SUB(vec, vrt[k].pos, scene->pos);
+            zed = RT_VEC3_DOT(vec, scene->nrm);
 
-                dot = RT_VEC3_DOT(vec, scene->nrm) / scene->cam->pov;
+            RT_VEC3_SUB(vec, vrt[k].pos, scene->pos);
 
-                RT_VEC3_MUL_VAL1(vec, vec, 1.0f / dot);
-                /* dot >= (pov - RT_CLIP_THRESHOLD) */
-                /* pov >= (2  *  RT_CLIP_THRESHOLD) */
-                /* thus: (dot >= RT_CLIP_THRESHOLD) */
+            dot = RT_VEC3_DOT(vec, scene->nrm);
 
-                RT_VEC3_SUB(vec, vec, scene->dir);
+            /* for kept vertices (zed >= -RT_CLIP_THRESHOLD): */
+            /* dot >= (pov - RT_CLIP_THRESHOLD) */
+            /* pov >= (2  *  RT_CLIP_THRESHOLD) */
+            /* thus: (dot >= RT_CLIP_THRESHOLD) */
+            /* vertices at or behind eye plane have (dot <= 0),
+             * clamp keeps them finite while kept ones are intact */
+            dot = RT_MAX(dot, RT_CLIP_THRESHOLD) / scene->cam->pov;
 
-                verts[k].pos[RT_X] = RT_VEC3_DOT(vec, scene->htl);
-                verts[k].pos[RT_Y] = RT_VEC3_DOT(vec, scene->vtl);
+            RT_VEC3_MUL_VAL1(vec, vec, 1.0f / dot);
 
-                verts[k].pos[RT_W] = +1.0f; /* tag: in front of screen plane */
+            RT_VEC3_SUB(vec, vec, scene->dir);
 
-                /* slightly behind (near) screen plane,
-                 * generate new vertex */
-                if (verts[k].pos[RT_Z] < 0.0f)
-                {
-                    verts[verts_num].pos[RT_X] = verts[k].pos[RT_X];
-                    verts[verts_num].pos[RT_Y] = verts[k].pos[RT_Y];
-                    verts_num++;
+            verts[k].pos[RT_X] = RT_VEC3_DOT(vec, scene->htl);
+            verts[k].pos[RT_Y] = RT_VEC3_DOT(vec, scene->vtl);
+            verts[k].pos[RT_Z] = zed;
 
-                    verts[k].pos[RT_W] = 0.0f; /* tag: near screen plane */
-                }
-            }
+            /* tag: in front of (+1), near (0) or behind (-1) screen plane */
+            verts[k].pos[RT_W] = zed >= 0.0f ? +1.0f :
+                                 zed >= -RT_CLIP_THRESHOLD ? 0.0f : -1.0f;
         }
 
-        /* process bbox edges */
+        /* process bbox edges crossing screen plane */
         for (k = 0; k < srf->bvbox->edges_num; k++)
         {
-            for (i = 0; i < 2; i++)
-            {
-                ndx[i] = srf->bvbox->edges[k].index[i];
-                zed[i] = verts[ndx[i]].pos[RT_Z];
-                tag[i] = verts[ndx[i]].pos[RT_W];
-            }
+            ndx[0] = srf->bvbox->edges[k].index[0];
+            ndx[1] = srf->bvbox->edges[k].index[1];
 
-            /* skip edge if both vertices are eihter
-             * behind or near screen plane */
-            if (tag[0] <= 0.0f && tag[1] <= 0.0f)
+            /* only process edge with one in front of
+             * and one behind screen plane vertices */
+            if (verts[ndx[0]].pos[RT_W] * verts[ndx[1]].pos[RT_W] >= 0.0f)
             {
                 continue;
             }
 
-            for (i = 0; i < 2; i++)
-            {
-                /* skip vertex if in front of
-                 * or near screen plane */
-                if (tag[i] >= 0.0f)
-                {
-                    continue;
-                }
+            i = verts[ndx[0]].pos[RT_W] < 0.0f ? 0 : 1;
+            j = 1 - i;
+
+            /* clip edge at screen plane crossing,
+             * generate new vertex */
+            RT_VEC3_SUB(vec, vrt[ndx[i]].pos, vrt[ndx[j]].pos);
+
+            zed = verts[ndx[j]].pos[RT_Z];
+            dot = zed / (zed - verts[ndx[i]].pos[RT_Z]); /* () >= THRESHOLD */
 
-                /* process edge with one in front of
-                 * and one behind screen plane vertices */
-                j = 1 - i;
+            RT_VEC3_MUL_VAL1(vec, vec, dot);
 
-                /* clip edge at screen plane crossing,
-                 * generate new vertex */
-                RT_VEC3_SUB(vec, vrt[ndx[i]].pos, vrt[ndx[j]].pos);
+            RT_VEC3_ADD(vec, vec, vrt[ndx[j]].pos);
+            RT_VEC3_SUB(vec, vec, scene->org);
 
-                dot = zed[j] / (zed[j] - zed[i]); /* () >= RT_CLIP_THRESHOLD */
+            verts[verts_num].pos[RT_X] = RT_VEC3_DOT(vec, scene->htl);
+            verts[verts_num].pos[RT_Y] = RT_VEC3_DOT(vec, scene->vtl);
+            verts[verts_num].pos[RT_W] = +1.0f;
 
-                RT_VEC3_MUL_VAL1(vec, vec, dot);
+            verts_num++;
+        }
 
-                RT_VEC3_ADD(vec, vec, vrt[ndx[j]].pos);
-                RT_VEC3_SUB(vec, vec, scene->org);
+        /* keep only vertices in front of or near screen plane,
+         * sort them by x, then y (insertion sort, few vertices) */
+        for (j = 0, k = 0; k < verts_num; k++)
+        {
+            if (verts[k].pos[RT_W] < 0.0f)
+            {
+                continue;
+            }
 
-                verts[verts_num].pos[RT_X] = RT_VEC3_DOT(vec, scene->htl);
-                verts[verts_num].pos[RT_Y] = RT_VEC3_DOT(vec, scene->vtl);
+            tmp = verts[k];
 
-                ndx[i] = verts_num;
-                verts_num++;
+            for (i = j++; i > 0
+            &&  (verts[i-1].pos[RT_X] > tmp.pos[RT_X]
+            ||  (verts[i-1].pos[RT_X] == tmp.pos[RT_X]
+            &&   verts[i-1].pos[RT_Y] > tmp.pos[RT_Y])); i--)
+            {
+                verts[i] = verts[i-1];
             }
 
-            /* tile current edge */
-            tiling(verts[ndx[0]].pos, verts[ndx[1]].pos); 
+            verts[i] = tmp;
         }
 
-        /* tile all newly generated vertex pairs */
-        for (i = srf->bvbox->verts_num; i < verts_num - 1; i++)
+        /* build convex hull of projected vertices (monotone chain),
+         * its row spans in the tilebuffer are the same as those
+         * of all projected edges, but fewer edges need to be tiled */
+        for (h = 0, t = 2, k = 0; k < 2 * j - 1; k++)
         {
-            for (j = i + 1; j < verts_num; j++)
+            i = k < j ? k : 2 * j - 2 - k;
+            t = k != j ? t : h + 1;
+
+            /* pop last vertex while it makes a non-left turn,
+             * lower chain is kept intact when building upper one */
+            while (h >= t
+            && (verts[hul[h-1]].pos[RT_X] - verts[hul[h-2]].pos[RT_X]) *
+               (verts[i].pos[RT_Y] - verts[hul[h-2]].pos[RT_Y]) -
+               (verts[hul[h-1]].pos[RT_Y] - verts[hul[h-2]].pos[RT_Y]) *
+               (verts[i].pos[RT_X] - verts[hul[h-2]].pos[RT_X]) <= 0.0f)
             {
-                tiling(verts[i].pos, verts[j].pos); 
+                h--;
             }
+
+            hul[h++] = i;
+        }
+
+        /* tile convex hull's edges */
+        for (k = 0; k < h - 1; k++)
+        {
+            tiling(verts[hul[k]].pos, verts[hul[k+1]].pos);
+        }
+
+        /* tile single vertex */
+        if (j == 1)
+        {
+            tiling(verts[0].pos, verts[0].pos);
         }
     }
     else
@@ -2106,25 +2603,366 @@ rt_void rt_SceneThread::stile(rt_Surface *srf)
         }
     }
 
-    rt_ELEM **ptr = RT_GET_ADR(srf->s_srf->msc_p[0]);
+    /* find the range of rows occupied by projected bbox */
+    for (i = 0; i < scene->tiles_in_col && txmin[i] > txmax[i]; i++);
+    for (j = scene->tiles_in_col - 1; j >= i && txmin[j] > txmax[j]; j--);
+
+    /* keep only a coarse record of occupied rows' spans,
+     * elements for single tiles are allocated lazily by "sbins"
+     * on the thread which bins respective row-band, thus large
+     * surfaces don't fill thousands of tiles in this thread */
+    rt_si32 *spn = (rt_si32 *)alloc(sizeof(rt_si32) * (2 + 2 * (j - i + 1)),
+                                                                RT_ALIGN);
+    spn[0] = i;
+    spn[1] = j;
+
+    for (k = i; k <= j; k++)
+    {
+        spn[2 + 2 * (k - i)] = txmin[k];
+        spn[3 + 2 * (k - i)] = txmax[k];
+    }
+
+    srf->s_srf->msc_p[0] = spn;
+}
+
+/*
+ * Bin surfaces' tiles recorded in "stile" into scene's tilebuffer
+ * for thread's own row-band, traverse reversed camera's list "lst"
+ * to keep original "clist's" order and trnode grouping in each tile,
+ * with tile lists in runs (RT_OPTS_TILING_RUNS) "lst" is "clist" itself
+ * and elements are appended to each tile in contiguous runs.
+ */
+rt_void rt_SceneThread::sbins(rt_ELEM *lst)
+{
+    rt_si32 i, j, k, m, t, tline;
+
+    rt_si32 n = scene->thnum;
+    rt_si32 tiles_in_row = scene->tiles_in_row;
+    rt_ELEM **tiles = scene->tiles;
+
+    /* reset thread's own row-band of tilebuffer */
+    rt_si32 r0 = (index + 0) * scene->tiles_in_col / n;
+    rt_si32 r1 = (index + 1) * scene->tiles_in_col / n;
+
+    memset(tiles + r0 * tiles_in_row, 0, sizeof(rt_ELEM *) * (r1 - r0) *
+                                                           tiles_in_row);
+
+    rt_VCONE *tcn;
+    rt_vec4 vec, htl, vtl;
+    rt_real dot, rad, len;
+
+    /* world-space steps of one tile along screen axes */
+    RT_VEC3_MUL_VAL1(htl, scene->htl, 1.0f / RT_VEC3_DOT(scene->htl,
+                                                        scene->htl));
+    RT_VEC3_MUL_VAL1(vtl, scene->vtl, 1.0f / RT_VEC3_DOT(scene->vtl,
+                                                        scene->vtl));
 
-    /* fill marked tiles with surface data */
-    for (i = 0; i < scene->tiles_in_col; i++)
+    /* update view-cones of thread's own row-band of tilebuffer,
+     * cone's axis goes through tile's center, its half-angle
+     * covers all four corners, thus the entire tile's frustum */
+    for (i = r0; i < r1; i++)
     {
-        for (j = txmin[i]; j <= txmax[i]; j++)
+        for (j = 0; j < tiles_in_row; j++)
         {
-            /* alloc new element for each tile of "srf" */
-            elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
-            elm->data = i << 16 | j;
-            elm->simd = srf->s_srf;
-            elm->temp = srf->bvbox;
-            /* insert element as list's tail */
-           *ptr = elm;
-            ptr = &elm->next;
+            tcn = &scene->tcones[i * tiles_in_row + j];
+
+            RT_VEC3_SET(vec, scene->dir);
+            RT_VEC3_MAD_VAL1(vec, htl, j + 0.5f);
+            RT_VEC3_MAD_VAL1(vec, vtl, i + 0.5f);
+
+            len = RT_VEC3_LEN(vec);
+            RT_VEC3_MUL_VAL1(tcn->vec, vec, 1.0f / len);
+            tcn->cos = 1.0f;
+
+            for (k = 0; k < 4; k++)
+            {
+                RT_VEC3_SET(vec, scene->dir);
+                RT_VEC3_MAD_VAL1(vec, htl, j + (k & 1));
+                RT_VEC3_MAD_VAL1(vec, vtl, i + (k >> 1));
+
+                dot = RT_VEC3_DOT(vec, tcn->vec) / RT_VEC3_LEN(vec);
+                tcn->cos = RT_MIN(tcn->cos, dot);
+            }
+
+            tcn->sin = RT_SQRT(1.0f - tcn->cos * tcn->cos);
         }
     }
 
-   *ptr = RT_NULL;
+    rt_ELEM *elm, *tls, *trn;
+
+    /* tiles' last elements, open trnode groups
+     * and ends of current runs for tile lists in runs */
+    rt_ELEM **tlst = RT_NULL, **tgrp = RT_NULL, **tend = RT_NULL;
+
+#if RT_OPTS_TILING_RUNS != 0
+    if ((scene->opts & RT_OPTS_TILING_RUNS) != 0)
+    {
+        t = (r1 - r0) * tiles_in_row;
+
+        tlst = (rt_ELEM **)alloc(sizeof(rt_ELEM *) * 3 * t, RT_ALIGN);
+        tgrp = tlst + t;
+        tend = tgrp + t;
+
+        memset(tlst, 0, sizeof(rt_ELEM *) * 3 * t);
+    }
+#endif /* RT_OPTS_TILING_RUNS */
+
+    for (elm = lst; elm != RT_NULL; elm = elm->next)
+    {
+        rt_Node *nd = (rt_Node *)((rt_BOUND *)elm->temp)->obj;
+
+        /* skip trnode elements from "clist"
+         * as they are handled separately for each tile */
+        if (RT_IS_ARRAY(nd))
+        {
+            continue;
+        }
+
+        rt_Surface *srf = (rt_Surface *)nd;
+
+        rt_si32 *spn = (rt_si32 *)srf->s_srf->msc_p[0];
+
+        /* surface's occupied rows within thread's own row-band */
+        i = RT_MAX(spn[0], r0);
+        k = RT_MIN(spn[1], r1 - 1);
+
+        /* tiles claimed by projected bbox are culled further with
+         * exact bounding sphere, which is cheap for spheres clipped
+         * only within their full bbox and without own scaling,
+         * center and radius are taken from world-space bbox */
+        rad = -1.0f;
+
+        if (i <= k && srf->tag == RT_TAG_SPHERE
+        &&  srf->bvbox->verts_num == 8
+        &&  RT_FABS(srf->trm->scl[RT_X]) == 1.0f
+        &&  RT_FABS(srf->trm->scl[RT_Y]) == 1.0f
+        &&  RT_FABS(srf->trm->scl[RT_Z]) == 1.0f)
+        {
+            rt_BOUND *box = srf->bvbox;
+            rt_VERT *vrt = box->verts;
+
+            len = 2.0f * RT_SQRT(srf->shape->sci[RT_W]);
+            len = len * (1.0f - RT_CULL_THRESHOLD);
+
+            if (box->bmax[RT_X] - box->bmin[RT_X] >= len
+            &&  box->bmax[RT_Y] - box->bmin[RT_Y] >= len
+            &&  box->bmax[RT_Z] - box->bmin[RT_Z] >= len)
+            {
+                RT_VEC3_SET_VAL1(vec, 0.0f);
+
+                for (j = 0; j < 8; j++)
+                {
+                    RT_VEC3_ADD(vec, vec, vrt[j].pos);
+                }
+
+                RT_VEC3_MUL_VAL1(vec, vec, 0.125f);
+                RT_VEC3_SUB(vec, vec, scene->pos);
+
+                /* bbox's edges from vertex 6 along each axis,
+                 * the longest covers non-uniform parent's scaling */
+                rt_vec4 edg;
+                RT_VEC3_SUB(edg, vrt[7].pos, vrt[6].pos);
+                rad = RT_VEC3_DOT(edg, edg);
+                RT_VEC3_SUB(edg, vrt[5].pos, vrt[6].pos);
+                rad = RT_MAX(rad, RT_VEC3_DOT(edg, edg));
+                RT_VEC3_SUB(edg, vrt[2].pos, vrt[6].pos);
+                rad = RT_MAX(rad, RT_VEC3_DOT(edg, edg));
+
+                rad = 0.5f * RT_SQRT(rad) * (1.0f + RT_CULL_THRESHOLD);
+                len = RT_VEC3_DOT(vec, vec);
+            }
+        }
+
+        for (; i <= k; i++)
+        {
+            tline = i * tiles_in_row;
+
+            for (j = spn[2 + 2 * (i - spn[0])];
+                 j <= spn[3 + 2 * (i - spn[0])]; j++)
+            {
+                /* skip tile if sphere is outside of its view-cone,
+                 * distance to cone's side is never overestimated */
+                if (rad >= 0.0f)
+                {
+                    tcn = &scene->tcones[tline + j];
+
+                    dot = RT_VEC3_DOT(vec, tcn->vec);
+
+                    if (RT_SQRT(RT_MAX(len - dot * dot, 0.0f)) * tcn->cos
+                                                 - dot * tcn->sin > rad)
+                    {
+                        continue;
+                    }
+                }
+
+                /* append elements to the tile's contiguous run,
+                 * new trnode element first if tile's last element
+                 * isn't in surface's trnode group already */
+                if (tlst != RT_NULL)
+                {
+                    t = tline + j - r0 * tiles_in_row;
+                    trn = tgrp[t];
+                    m = 1;
+
+                    if (srf->trnode != RT_NULL && srf->trnode != srf
+                    && (trn == RT_NULL || trn->temp != srf->trn->temp
+                    ||  (rt_ELEM *)trn->data != tlst[t]))
+                    {
+                        m = 0;
+                    }
+
+                    for (; m < 2; m++)
+                    {
+                        tls = tlst[t];
+
+                        /* start new run if current one is full */
+                        if (tls == RT_NULL || tls + 1 == tend[t])
+                        {
+                            tls = (rt_ELEM *)alloc(sizeof(rt_ELEM) *
+                                        RT_TILE_RUN, RT_QUAD_ALIGN);
+                            tend[t] = tls + RT_TILE_RUN;
+                        }
+                        else
+                        {
+                            tls = tls + 1;
+                        }
+
+                        if (tlst[t] != RT_NULL)
+                        {
+                            tlst[t]->next = tls;
+                        }
+                        else
+                        {
+                            tiles[tline + j] = tls;
+                        }
+
+                        tlst[t] = tls;
+                        tls->next = RT_NULL;
+
+                        if (m == 0)
+                        {
+                            tls->data = 0;
+                            tls->simd = ((rt_Array *)srf->trnode)->s_srf;
+                            tls->temp = srf->trn->temp;
+
+                            tgrp[t] = tls;
+                        }
+                        else
+                        {
+                            tls->data = 0;
+                            tls->simd = srf->s_srf;
+                            tls->temp = srf->bvbox;
+                        }
+                    }
+
+                    /* trnode's last element */
+                    if (srf->trnode != RT_NULL && srf->trnode != srf)
+                    {
+                        tgrp[t]->data = (rt_cell)tls;
+                    }
+
+                    continue;
+                }
+
+                /* alloc new element for each tile of "srf" */
+                tls = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+                tls->data = 0;
+                tls->simd = srf->s_srf;
+                tls->temp = srf->bvbox;
+
+                if (srf->trnode != RT_NULL && srf->trnode != srf)
+                {
+                    /* check matching existing trnode for insertion,
+                     * only tile list's head needs to be checked as elements
+                     * grouping for cached transform is retained from "clist" */
+                    trn = tiles[tline + j];
+
+                    rt_Array *arr = (rt_Array *)srf->trnode;
+                    rt_BOUND *trb = (rt_BOUND *)srf->trn->temp;
+
+                    if (trn != RT_NULL && trn->temp == trb)
+                    {
+                        /* insert element under existing trnode */
+                        tls->next = trn->next;
+                        trn->next = tls;
+                    }
+                    else
+                    {
+                        /* insert element as list's head */
+                        tls->next = tiles[tline + j];
+                        tiles[tline + j] = tls;
+
+                        /* alloc new trnode element as none has been found */
+                        trn = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+                        trn->data = (rt_cell)tls; /* trnode's last element */
+                        trn->simd = arr->s_srf;
+                        trn->temp = trb;
+                        /* insert element as list's head */
+                        trn->next = tiles[tline + j];
+                        tiles[tline + j] = trn;
+                    }
+                }
+                else
+                {
+                    /* insert element as list's head */
+                    tls->next = tiles[tline + j];
+                    tiles[tline + j] = tls;
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Mark tile rows to re-render within thread's own row-band of the
+ * tilebuffer for dirty tiles' render (RT_OPTS_RENDER_EXT2), a tile is
+ * dirty if its list differs from the one in the last frame or has
+ * any of the dirty surfaces selected in "update_dirty".
+ */
+rt_void rt_SceneThread::sdirt()
+{
+    rt_si32 i, j, k, tline;
+
+    rt_si32 n = scene->thnum;
+    rt_si32 tiles_in_row = scene->tiles_in_row;
+    rt_ELEM **tiles = scene->tiles;
+
+    rt_si32 r0 = (index + 0) * scene->tiles_in_col / n;
+    rt_si32 r1 = (index + 1) * scene->tiles_in_col / n;
+
+    rt_ELEM *elm;
+    rt_ui64 sgn;
+
+    for (i = r0; i < r1; i++)
+    {
+        tline = i * tiles_in_row;
+        k = scene->dall;
+
+        for (j = 0; j < tiles_in_row; j++)
+        {
+            /* list's signature from bounds of its elements,
+             * which are kept for surfaces and trnodes across frames */
+            sgn = ULL(0xCBF29CE484222325);
+
+            for (elm = tiles[tline + j]; elm != RT_NULL; elm = elm->next)
+            {
+                rt_Node *nd = (rt_Node *)((rt_BOUND *)elm->temp)->obj;
+
+                sgn = (sgn ^ (rt_ui64)(rt_word)elm->temp)
+                                    * ULL(0x00000100000001B3);
+
+                if (RT_IS_SURFACE(nd))
+                {
+                    k |= ((rt_Surface *)nd)->srf_dirty;
+                }
+            }
+
+            k |= scene->dsign[tline + j] != sgn;
+            scene->dsign[tline + j] = sgn;
+        }
+
+        scene->drows[i] = k;
+    }
 }
 
 /*
@@ -2133,8 +2971,15 @@ rt_void rt_SceneThread::stile(rt_Surface *srf)
  */
 rt_ELEM* rt_SceneThread::ssort(rt_Object *obj)
 {
-    /* as temporary memory pool is released after every frame,
-     * always rebuild the list even if the scene hasn't changed */
+    /* surfaces' lists are kept across frames in thread's heap,
+     * scene calls for rebuild only if surfaces have changed,
+     * camera's list is temporary and rebuilt every frame */
+
+    /* start new sorting pass as bounds
+     * may have changed since the last call,
+     * grids may have been rebuilt as well */
+    c_obj = RT_NULL;
+    q_grd = RT_NULL;
 
     rt_Surface *srf = RT_NULL;
     rt_ELEM **pto = RT_NULL;
@@ -2181,6 +3026,10 @@ rt_ELEM* rt_SceneThread::ssort(rt_Object *obj)
     {
         rt_Surface *ref;
 
+        /* reset node elements' hash-table */
+        memset(nodes, 0, sizeof(rt_ELEM *) << c_bits);
+        n_num = 0;
+
         /* linear traversal across surfaces */
         for (ref = scene->srf_head; ref != RT_NULL; ref = ref->next)
         {
@@ -2455,8 +3304,12 @@ rt_ELEM* rt_SceneThread::ssort(rt_Object *obj)
  */
 rt_ELEM* rt_SceneThread::lsort(rt_Object *obj)
 {
-    /* as temporary memory pool is released after every frame,
-     * always rebuild the list even if the scene hasn't changed */
+    /* lists are kept across frames in thread's heap, scene calls
+     * for rebuild only if lights or surfaces have changed */
+
+    /* start new sorting pass as bounds
+     * may have changed since the last call */
+    c_obj = RT_NULL;
 
     rt_Surface *srf = RT_NULL;
     rt_ELEM **pto = RT_NULL;
@@ -2498,6 +3351,22 @@ rt_ELEM* rt_SceneThread::lsort(rt_Object *obj)
         rt_ELEM **psi = RT_NULL;
         rt_ELEM **psr = RT_NULL;
 
+        /* skip light sources with limited range (non-zero) if
+         * surface's bounding sphere is entirely out of reach,
+         * tracer masks the same range per ray for the rest */
+        if (srf != RT_NULL && lgt->lgt->atn[0] > 0.0f
+        &&  srf->bvbox->verts_num != 0)
+        {
+            rt_vec4 vec;
+            RT_VEC3_SUB(vec, srf->bvbox->mid, lgt->bvbox->mid);
+            rt_real rng = lgt->lgt->atn[0] + srf->bvbox->rad;
+
+            if (RT_VEC3_DOT(vec, vec) > rng * rng)
+            {
+                continue;
+            }
+        }
+
 #if RT_OPTS_2SIDED != 0
         if ((scene->opts & RT_OPTS_2SIDED) != 0 && srf != RT_NULL)
         {
@@ -2552,12 +3421,32 @@ rt_ELEM* rt_SceneThread::lsort(rt_Object *obj)
            *psr = RT_NULL;
         }
 
-        rt_si32 c = 0, s = 0;
-        rt_ELEM *elm, *cur = RT_NULL, *prv = RT_NULL;
+        rt_si32 c = 0, s = 0, lvl = 0;
+        rt_ELEM *elm, *nxt, *cur = RT_NULL, *prv = RT_NULL;
         rt_ELEM *cuo, *cui, *pro = RT_NULL, *pri = RT_NULL;
 
-        /* hierarchical traversal across nodes */
-        for (elm = scene->hlist; elm != RT_NULL;)
+        /* set query capsule for gridded runs of nodes around
+         * the segment from light's position to surface's "mid"
+         * with surface's radius, which contains all shadow rays
+         * (cone from light's position to surface's bounding sphere) */
+        g_use = srf->bvbox->rad != RT_INF;
+
+#if RT_OPTS_SHADOW_EXT1 != 0
+        g_use &= (scene->opts & RT_OPTS_SHADOW_EXT1) != 0;
+#else /* RT_OPTS_SHADOW_EXT1 */
+        g_use = 0;
+#endif /* RT_OPTS_SHADOW_EXT1 */
+
+        if (g_use)
+        {
+            RT_VEC3_SET(g_org, lgt->bvbox->mid);
+            RT_VEC3_SUB(g_vec, srf->bvbox->mid, lgt->bvbox->mid);
+            g_rad = srf->bvbox->rad * (1.0f + RT_LINE_THRESHOLD);
+        }
+
+        /* hierarchical traversal across nodes,
+         * gridded runs only visit nodes near the query capsule */
+        for (elm = gfirst(scene->hlist, lvl); elm != RT_NULL;)
         {
             rt_BOUND *box = (rt_BOUND *)elm->temp;
 
@@ -2602,9 +3491,16 @@ rt_ELEM* rt_SceneThread::lsort(rt_Object *obj)
                 }
 
                 /* if array's bbox is only seen from one side of the surface
-                 * so are all of array's contents, thus skip "bbox_side" call */
+                 * so are all of array's contents, thus skip "bbox_side" call,
+                 * array without contents near query capsule is a leaf */
+                nxt = RT_NULL;
                 if (RT_IS_ARRAY(box) && c != 0 && s
                 && (cuo != RT_NULL || cui != RT_NULL))
+                {
+                    nxt = gfirst(RT_GET_PTR(elm->simd), lvl + 1);
+                }
+
+                if (nxt != RT_NULL)
                 {
                     /* set array for skipping "bbox_side" call above */
                     if (cur == RT_NULL && c < 3)
@@ -2624,11 +3520,14 @@ rt_ELEM* rt_SceneThread::lsort(rt_Object *obj)
                     }
 
                     prv = elm;
-                    elm = RT_GET_PTR(elm->simd);
+                    elm = nxt;
+                    lvl++;
                 }
                 else
                 {
-                    while (elm != RT_NULL && elm->next == RT_NULL)
+                    nxt = gnext(elm, lvl);
+
+                    while (elm != RT_NULL && nxt == RT_NULL)
                     {
                         if ((cur == RT_NULL || c & 2) && pso != RT_NULL)
                         {
@@ -2646,18 +3545,18 @@ rt_ELEM* rt_SceneThread::lsort(rt_Object *obj)
                         }
 
                         elm = RT_GET_PTR(elm->data);
+                        lvl--;
 
                         if (elm == cur)
                         {
                             cur = RT_NULL;
                         }
-                    }
 
-                    if (elm != RT_NULL)
-                    {
-                        elm = elm->next;
+                        nxt = elm != RT_NULL ? gnext(elm, lvl) : RT_NULL;
                     }
 
+                    elm = nxt;
+
                     prv = RT_NULL;
                 }
             }
@@ -2673,27 +3572,37 @@ rt_ELEM* rt_SceneThread::lsort(rt_Object *obj)
                     }
                 }
 
+                /* array without contents near query capsule is a leaf */
+                nxt = RT_NULL;
                 if (RT_IS_ARRAY(box) && cur != RT_NULL && s)
+                {
+                    nxt = gfirst(RT_GET_PTR(elm->simd), lvl + 1);
+                }
+
+                if (nxt != RT_NULL)
                 {
                     prv = cur;
                     psr = RT_GET_ADR(cur->simd);
-                    elm = RT_GET_PTR(elm->simd);
+                    elm = nxt;
+                    lvl++;
                 }
                 else
                 {
-                    while (elm != RT_NULL && elm->next == RT_NULL)
+                    nxt = gnext(elm, lvl);
+
+                    while (elm != RT_NULL && nxt == RT_NULL)
                     {
                         prv = prv != RT_NULL ? RT_GET_PTR(prv->data) :
                               RT_NULL;
                         psr = prv != RT_NULL ? RT_GET_ADR(prv->simd) :
                               RT_GET_ADR((*ptr)->data);
                         elm = RT_GET_PTR(elm->data);
-                    }
+                        lvl--;
 
-                    if (elm != RT_NULL)
-                    {
-                        elm = elm->next;
+                        nxt = elm != RT_NULL ? gnext(elm, lvl) : RT_NULL;
                     }
+
+                    elm = nxt;
                 }
             }
         }
@@ -2753,582 +3662,2830 @@ rt_ELEM* rt_SceneThread::lsort(rt_Object *obj)
 }
 
 /*
- * Deinitialize scene thread.
+ * Return grid's cell index along axis "a" for coordinate "val",
+ * coordinates outside of the grid are clamped to its border cells.
  */
-rt_SceneThread::~rt_SceneThread()
+static
+rt_si32 grid_cell(rt_GRID *grd, rt_real val, rt_si32 a)
 {
-    ASM_DONE(s_inf)
-}
+    rt_real t = (val - grd->org[a]) * grd->scl[a];
 
-/******************************************************************************/
-/**********************************   SCENE   *********************************/
-/******************************************************************************/
+    t = RT_MIN(RT_MAX(t, 0.0f), (rt_real)(grd->dim[a] - 1));
+
+    return (rt_si32)t;
+}
 
 /*
- * Allocate scene in custom heap.
- * Heap "hp" must be the same object as platform "pfm" in constructor.
+ * Build grids over runs of at least RT_GRID_MIN sibling elements
+ * in the given run "lst" of "hlist" and in runs of arrays below it,
+ * grids are added to the list "top", return number of elements visited.
  */
-rt_pntr rt_Scene::operator new(size_t size, rt_Heap *hp)
+rt_si32 rt_SceneThread::sgrid(rt_ELEM *lst, rt_GRID **top)
 {
-    return hp->obj_alloc(size, RT_ALIGN);
-}
+    rt_ELEM *elm;
+    rt_BOUND *box;
+    rt_si32 i, j, k, a, n = 0, t = 0;
 
-/*
- * Delete scene from custom heap.
- */
-rt_void rt_Scene::operator delete(rt_pntr ptr)
-{
-    ((rt_Scene *)ptr)->pfm->obj_free(ptr);
-}
+    for (elm = lst; elm != RT_NULL; elm = elm->next, n++)
+    {
+        box = (rt_BOUND *)elm->temp;
 
-/*
- * Instantiate scene.
- * Can only be called from single (main) thread.
- * Platform "pfm" must be the same object as heap "hp" in custom "new".
- */
-rt_Scene::rt_Scene(rt_SCENE *scn, /* "frame" must be SIMD-aligned or NULL */
-                   rt_si32 x_res, rt_si32 y_res, rt_si32 x_row, rt_ui32 *frame,
-                   rt_Platform *pfm) :
+        if (RT_IS_ARRAY(box) && RT_GET_PTR(elm->simd) != RT_NULL)
+        {
+            t += sgrid(RT_GET_PTR(elm->simd), top);
+        }
+    }
 
-    rt_Registry(pfm->f_alloc, pfm->f_free),
-    rt_List<rt_Scene>(RT_NULL)
-{
-    this->pfm = pfm;
+    if (n < RT_GRID_MIN)
+    {
+        return t + n;
+    }
 
-    pfm->add_scene(this);
+    rt_GRID *grd = (rt_GRID *)alloc(sizeof(rt_GRID), RT_ALIGN);
 
-    thnum = pfm->thnum;
-    tdata = pfm->tdata;
+    grd->elm = (rt_ELEM **)alloc(sizeof(rt_ELEM *) * n, RT_ALIGN);
+    grd->num = n;
+    grd->inf = (rt_si32 *)alloc(sizeof(rt_si32) * n, RT_ALIGN);
+    grd->inf_num = 0;
+    grd->clp = (rt_si32 *)alloc(sizeof(rt_si32) * n, RT_ALIGN);
+    grd->clp_num = 0;
 
-    f_update = pfm->f_update;
-    f_render = pfm->f_render;
+    /* grid spans bounding spheres of bounded elements */
+    rt_vec4 gmin, gmax, vmin, vmax;
 
-    this->scn = scn;
+    RT_VEC3_SET_VAL1(gmin, +RT_INF);
+    RT_VEC3_SET_VAL1(gmax, -RT_INF);
 
-    /* check for locked scene data, not thread safe! (it's ok, not a bug) */
-    if (scn->lock != RT_NULL)
+    for (elm = lst, i = 0; elm != RT_NULL; elm = elm->next, i++)
     {
-        throw rt_Exception("scene data is locked by another instance");
+        grd->elm[i] = elm;
+        box = (rt_BOUND *)elm->temp;
+        box->idx = i;
+
+        if (node_clip(box))
+        {
+            grd->clp[grd->clp_num++] = i;
+        }
+
+        if (box->rad == RT_INF)
+        {
+            continue;
+        }
+
+        RT_VEC3_SET_VAL1(vmin, -box->rad);
+        RT_VEC3_ADD(vmin, vmin, box->mid);
+        RT_VEC3_SET_VAL1(vmax, +box->rad);
+        RT_VEC3_ADD(vmax, vmax, box->mid);
+
+        RT_VEC3_MIN(gmin, gmin, vmin);
+        RT_VEC3_MAX(gmax, gmax, vmax);
     }
 
-    /* "x_row", frame's stride (in 32-bit pixels, not bytes!),
-     * can be greater than "x_res", in which case the frame
-     * occupies only a portion (rectangle) of the framebuffer,
-     * or negative, in which case frame starts at the last line
-     * and consecutive lines are located backwards in memory,
-     * "x_row" must contain the whole number of SIMD widths */
-    if (x_res == 0 || y_res == 0 || RT_ABS32(x_row) < x_res)
+    /* pick number of cells per axis proportionally to grid's
+     * extents, until there are at least as many cells as elements,
+     * thus flat runs get more cells along their non-flat axes */
+    rt_real ext[3], emax = 0.0f;
+
+    for (a = 0; a < 3; a++)
     {
-        throw rt_Exception("frambuffer's dimensions are not valid");
+        ext[a] = gmax[a] > gmin[a] ? gmax[a] - gmin[a] : 0.0f;
+        emax = RT_MAX(emax, ext[a]);
     }
 
-#if (RT_POINTER - RT_ADDRESS) != 0
+    rt_si32 c = 1;
 
-    /* always reallocate frame in custom heap for 64-bit
-     * if 32-bit address range is enabled in makefiles */
-    frame = RT_NULL;
+    for (j = 1; j <= n; j++)
+    {
+        for (c = 1, a = 0; a < 3; a++)
+        {
+            grd->dim[a] = emax > 0.0f ?
+                    RT_MAX(1, (rt_si32)(j * ext[a] / emax + 0.5f)) : 1;
+            c *= grd->dim[a];
+        }
 
-#endif /* (RT_POINTER - RT_ADDRESS) */
+        if (c >= n)
+        {
+            break;
+        }
+    }
 
-    if (((rt_word)frame & (RT_SIMD_ALIGN - 1)) != 0 || frame == RT_NULL
-    || (RT_ABS32(x_row) & (RT_SIMD_WIDTH - 1)) != 0)
+    for (a = 0; a < 3; a++)
     {
-        rt_si32 y_sgn = RT_SIGN(x_row);
+        grd->org[a] = emax > 0.0f ? gmin[a] : 0.0f;
+        grd->scl[a] = ext[a] > 0.0f ? grd->dim[a] / ext[a] : 0.0f;
+    }
 
-        x_row = RT_ABS32(x_row);
-        x_row = ((x_row + RT_SIMD_WIDTH - 1) / RT_SIMD_WIDTH) * RT_SIMD_WIDTH;
+    grd->cel = (rt_si32 *)alloc(sizeof(rt_si32) * (c + 1), RT_ALIGN);
+    memset(grd->cel, 0, sizeof(rt_si32) * (c + 1));
 
-        frame = (rt_ui32 *)
-                alloc(x_row * y_res * sizeof(rt_ui32), RT_SIMD_ALIGN);
+    rt_si32 *r0 = (rt_si32 *)alloc(sizeof(rt_si32) * 3 * n, RT_ALIGN);
+    rt_si32 *r1 = (rt_si32 *)alloc(sizeof(rt_si32) * 3 * n, RT_ALIGN);
 
-        x_row *= y_sgn;
+    /* count elements per cell, elements without bounds or
+     * covering more than half of the cells are kept apart */
+    for (i = 0; i < n; i++)
+    {
+        box = (rt_BOUND *)grd->elm[i]->temp;
 
-        if (x_row < 0)
+        for (k = 1, a = 0; a < 3 && box->rad != RT_INF; a++)
         {
-            frame += RT_ABS32(x_row) * (y_res - 1);
+            r0[i*3+a] = grid_cell(grd, box->mid[a] - box->rad, a);
+            r1[i*3+a] = grid_cell(grd, box->mid[a] + box->rad, a);
+            k *= r1[i*3+a] - r0[i*3+a] + 1;
         }
-    }
 
-    memset(frame, 0, x_row * y_res * sizeof(rt_ui32));
-
-    /* init framebuffer's dimensions and pointer */
-    this->x_res = x_res;
-    this->y_res = y_res;
-    this->x_row = x_row;
-    this->frame = frame;
+        if (box->rad == RT_INF || (c > 1 && k * 2 > c))
+        {
+            grd->inf[grd->inf_num++] = i;
 
-    /* init tilebuffer's dimensions and pointer */
-    tiles_in_row = (x_res + pfm->tile_w - 1) / pfm->tile_w;
-    tiles_in_col = (y_res + pfm->tile_h - 1) / pfm->tile_h;
+            for (a = 0; a < 3; a++)
+            {
+                r0[i*3+a] = 1;
+                r1[i*3+a] = 0;
+            }
 
-    tiles = (rt_ELEM **)
-            alloc(tiles_in_row * tiles_in_col * sizeof(rt_ELEM *), RT_ALIGN);
+            continue;
+        }
 
-    memset(tiles, 0, tiles_in_row * tiles_in_col * sizeof(rt_ELEM *));
+        rt_si32 x, y, z;
 
-    /* init pixel-width, aspect-ratio, ray-depth */
-    factor = 1.0f / (rt_real)x_res;
-    aspect = (rt_real)y_res * factor;
-    depth = RT_MAX(RT_STACK_DEPTH, 0);
-    opts &= ~scn->opts;
+        for (z = r0[i*3+2]; z <= r1[i*3+2]; z++)
+        for (y = r0[i*3+1]; y <= r1[i*3+1]; y++)
+        for (x = r0[i*3+0]; x <= r1[i*3+0]; x++)
+        {
+            grd->cel[(z * grd->dim[1] + y) * grd->dim[0] + x + 1]++;
+        }
+    }
 
-    if ((opts & RT_OPTS_PT) == 0)
+    for (k = 0; k < c; k++)
     {
-        /* alloc framebuffer's seed-plane for path-tracer */
-        pseed = (rt_elem *)
-                alloc(4 * x_row * y_res * sizeof(rt_elem), RT_SIMD_ALIGN);
+        grd->cel[k + 1] += grd->cel[k];
+    }
 
-                /* pseed is initialized in reset_pseed() */
+    grd->idx = (rt_si32 *)alloc(sizeof(rt_si32) * grd->cel[c], RT_ALIGN);
 
-        /* alloc framebuffer's color-planes for path-tracer */
-        ptr_r = (rt_real *)
-                alloc(4 * x_row * y_res * sizeof(rt_real), RT_SIMD_ALIGN);
-        ptr_g = (rt_real *)
-                alloc(4 * x_row * y_res * sizeof(rt_real), RT_SIMD_ALIGN);
-        ptr_b = (rt_real *)
-                alloc(4 * x_row * y_res * sizeof(rt_real), RT_SIMD_ALIGN);
+    /* fill cells in elements' order */
+    rt_si32 *cur = (rt_si32 *)alloc(sizeof(rt_si32) * c, RT_ALIGN);
+    memcpy(cur, grd->cel, sizeof(rt_si32) * c);
 
-                /* ptr_* is initialized in reset_color() */
-    }
-    else
+    for (i = 0; i < n; i++)
     {
-        pseed = RT_NULL;
-        ptr_r = RT_NULL;
-        ptr_g = RT_NULL;
-        ptr_b = RT_NULL;
+        rt_si32 x, y, z;
+
+        for (z = r0[i*3+2]; z <= r1[i*3+2]; z++)
+        for (y = r0[i*3+1]; y <= r1[i*3+1]; y++)
+        for (x = r0[i*3+0]; x <= r1[i*3+0]; x++)
+        {
+            grd->idx[cur[(z * grd->dim[1] + y) * grd->dim[0] + x]++] = i;
+        }
     }
 
-    pt_on = RT_FALSE;
+    grd->next = *top;
+    *top = grd;
 
-    /* instantiate object hierarchy */
-    memset(&rootobj, 0, sizeof(rt_OBJECT));
+    return t + n;
+}
 
-    rootobj.trm.scl[RT_I] = 1.0f;
-    rootobj.trm.scl[RT_J] = 1.0f;
-    rootobj.trm.scl[RT_K] = 1.0f;
-    rootobj.obj = scn->root;
+/*
+ * Copy flat list "lst" kept across frames into the thread's heap,
+ * elements are relinked to the current backend structs of their objects
+ * and nodes to copies of their last leaf elements, as in pipelined mode
+ * the update swaps in twins of the structs while kept lists are moved
+ * to the heaps' twin chains released after the render. Return the copy.
+ */
+rt_ELEM* rt_SceneThread::flink(rt_ELEM *lst)
+{
+    rt_ELEM *elm, *nxt, *top = RT_NULL, **ptr = &top;
+    rt_si32 n = 0;
 
-    if (!RT_IS_ARRAY(&scn->root))
+    for (elm = lst; elm != RT_NULL; elm = elm->next)
     {
-        throw rt_Exception("scene's root is not an array");
-    }
+        rt_BOUND *box = (rt_BOUND *)elm->temp;
 
-    root = new(this) rt_Array(this, RT_NULL, &rootobj); /* also init "*_num" */
+        /* alloc new element as "elm's" copy */
+        nxt = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+        nxt->data = elm->data;
+        nxt->simd = elm->simd;
+        nxt->temp = elm->temp;
+        /* insert element as list's tail */
+       *ptr = nxt;
+        ptr = &nxt->next;
 
-    if (cam_head == RT_NULL)
-    {
-        throw rt_Exception("scene doesn't contain camera");
-    }
+        /* accum markers are copied as is */
+        if (box != RT_NULL && RT_IS_SURFACE(box))
+        {
+            nxt->simd = ((rt_Surface *)box->obj)->s_srf;
+        }
+        else
+        if (box != RT_NULL && RT_IS_ARRAY(box))
+        {
+            rt_Array *arr = (rt_Array *)box->obj;
+            rt_cell k = RT_GET_FLG(elm->data);
 
-    cam = cam_head;
-    cam_idx = 0;
+            nxt->simd = k == 0 ? arr->s_srf :
+                        box == arr->bvbox ? arr->s_bvb :
+                        box == arr->inbox ? arr->s_inb : RT_NULL;
 
-    /* lock scene data, when scene's constructor can no longer fail */
-    scn->lock = this;
+            /* node's last leaf element is set once copied */
+            if (RT_GET_PTR(elm->data) != RT_NULL)
+            {
+                l_end[n] = RT_GET_PTR(elm->data);
+                l_elm[n] = nxt;
+                n++;
+            }
+        }
+        else
+        if (box != RT_NULL && RT_IS_LIGHT(box))
+        {
+            nxt->simd = ((rt_Light *)box->obj)->s_lgt;
+        }
 
-    /* create scene threads array */
-    tharr = (rt_SceneThread **)
-            alloc(sizeof(rt_SceneThread *) * thnum, RT_ALIGN);
+        /* nodes ending with "elm" are nested in list order */
+        for (; n > 0 && l_end[n - 1] == elm; n--)
+        {
+            RT_SET_PTR(l_elm[n - 1]->data, rt_cell, nxt);
+        }
+    }
 
-    rt_si32 i;
+   *ptr = RT_NULL;
 
-    for (i = 0; i < thnum; i++)
+    /* relink lights' shadow lists once the list is copied
+     * as the pending nodes above are kept per thread */
+    for (nxt = top; nxt != RT_NULL; nxt = nxt->next)
     {
-        tharr[i] = new(this) rt_SceneThread(this, i);
+        rt_BOUND *box = (rt_BOUND *)nxt->temp;
 
-        /* estimate per-frame allocs to reduce system calls per thread */
-        tharr[i]->msize =  /* upper bound per surface for tiling */
-            (tiles_in_row * tiles_in_col + /* plus array nodes list */
-             (arr_num + 2) +     /* plus reflections/refractions */
-             (srf_num + arr_num * 2 + /* plus lights and shadows */
-             (srf_num + arr_num * 2 + 1) * lgt_num) * 2) * /* for both sides */
-            sizeof(rt_ELEM) * (srf_num + thnum - 1) / thnum; /* per thread */
+        if (box != RT_NULL && RT_IS_LIGHT(box))
+        {
+            nxt->data = (rt_cell)llink((rt_ELEM *)nxt->data);
+        }
     }
 
-    pending = 0;
-
-    /* init memory pool in the heap for temporary per-frame allocs */
-    mpool = RT_NULL; /* rough estimate for surface relations/templates */
-    msize = ((srf_num + 1) * (srf_num + 1) * 2 + /* plus two surface lists */
-             (srf_num + arr_num * 1) * 2 + /* plus lights and shadows list */
-             (srf_num + arr_num * 2 + 1) * lgt_num + /* plus array nodes */
-             tiles_in_row * tiles_in_col * arr_num) *  /* for tiling */
-            sizeof(rt_ELEM);                        /* for main thread */
-
-    /* in the estimates above ("arr_num" * x) depends on whether both
-     * trnode/bvnode are allowed in the list or just one of them,
-     * if the estimates are not accurate the engine should still work,
-     * though not as efficient due to unnecessary allocations per frame
-     * or unused extra memory reservation resulting in larger footprint */
+    return top;
 }
 
 /*
- * Update current camera with given "action" for a given "time".
+ * Relink list "lst" kept by a surface or a light across frames,
+ * global lists (or their relinked originals) are mapped to the ones
+ * relinked in the current update, other lists are copied.
  */
-rt_void rt_Scene::update(rt_time time, rt_si32 action)
+rt_ELEM* rt_SceneThread::llink(rt_ELEM *lst)
 {
-    cam->update_action(time, action);
+    if (lst == RT_NULL)
+    {
+        return lst;
+    }
+
+    if (lst == scene->s_old[0] || lst == scene->s_old[1])
+    {
+        return scene->slist;
+    }
+
+    if (lst == scene->l_old[0] || lst == scene->l_old[1])
+    {
+        return scene->llist;
+    }
+
+    return flink(lst);
 }
 
 /*
- * Update backend data structures and render frame for a given "time".
+ * Copy hierarchical list "lst" kept across frames into the thread's heap
+ * linking its elements up to "prv" (recursive), surfaces are relinked
+ * to their current backend structs, arrays to copies of their sub-lists,
+ * order and node's type flags are kept. Return the copy.
  */
-rt_void rt_Scene::render(rt_time time)
+rt_ELEM* rt_SceneThread::hlink(rt_ELEM *lst, rt_ELEM *prv)
 {
-    rt_si32 i;
-
-#if RT_OPTS_UPDATE_EXT0 != 0
-    if ((opts & RT_OPTS_UPDATE_EXT0) == 0 || rootobj.time == -1)
-    { /* -->---->-- skip update1 -->---->-- */
-#endif /* RT_OPTS_UPDATE_EXT0 */
+    rt_ELEM *elm, *nxt, *top = RT_NULL, **ptr = &top;
 
-    if (pending)
+    for (elm = lst; elm != RT_NULL; elm = elm->next)
     {
-        pending = 0;
+        rt_BOUND *box = (rt_BOUND *)elm->temp;
 
-        /* release memory for temporary per-frame allocs */
-        for (i = 0; i < thnum; i++)
+        /* alloc new element as "elm's" copy */
+        nxt = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+        nxt->data = (rt_cell)prv | RT_GET_FLG(elm->data); /* link up */
+        nxt->temp = elm->temp;
+        /* insert element as list's tail */
+       *ptr = nxt;
+        ptr = &nxt->next;
+
+        if (RT_IS_ARRAY(box))
         {
-            tharr[i]->release(tharr[i]->mpool);
+            nxt->simd = hlink(RT_GET_PTR(elm->simd), nxt);
+            RT_SET_FLG(nxt->simd, rt_pntr, RT_GET_FLG(elm->simd));
+        }
+        else
+        {
+            nxt->simd = ((rt_Surface *)box->obj)->s_srf;
         }
-
-        release(mpool);
     }
 
-    /* reserve memory for temporary per-frame allocs */
-    mpool = reserve(msize, RT_QUAD_ALIGN);
+   *ptr = RT_NULL;
 
-    for (i = 0; i < thnum; i++)
-    {
-        tharr[i]->mpool = tharr[i]->reserve(tharr[i]->msize, RT_QUAD_ALIGN);
-    }
+    return top;
+}
 
-    /* print state init */
-    if (g_print)
+/*
+ * Relink lists kept by surface "srf" across frames (see "flink"),
+ * its trnode/bvnode list, custom clippers list and light/shadow
+ * and rfl/rfr surface lists shared between sides.
+ */
+rt_void rt_SceneThread::slink(rt_Surface *srf)
+{
+    rt_ELEM *elm, *nxt, **ptr;
+
+    /* node list keeps node's type in "simd" field */
+    elm = srf->top;
+    ptr = &srf->top;
+
+    for (; elm != RT_NULL; elm = elm->next)
     {
-        RT_PRINT_STATE_INIT();
-        RT_PRINT_TIME(time);
+        nxt = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+        nxt->data = elm->data;
+        nxt->simd = elm->simd;
+        nxt->temp = elm->temp;
+       *ptr = nxt;
+        ptr = &nxt->next;
     }
 
-    /* phase 0.5, hierarchical update of arrays' transform matrices */
-    root->update_object(time, 0, RT_NULL, iden4);
+   *ptr = RT_NULL;
 
-    /* 1st phase of multi-threaded update */
-#if RT_OPTS_THREAD != 0
-    if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene() && !g_print
-#if RT_OPTS_UPDATE_EXT1 != 0
-    &&  (opts & RT_OPTS_UPDATE_EXT1) == 0
-#endif /* RT_OPTS_UPDATE_EXT1 */
-       )
+    if (srf->trn != RT_NULL)
     {
-        this->f_update(tdata, thnum, 1);
+        elm = srf->trn;
+
+        nxt = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+        nxt->data = elm->data;
+        nxt->simd = elm->simd;
+        nxt->temp = elm->temp;
+        nxt->next = RT_NULL;
+        srf->trn = nxt;
     }
-    else
-#endif /* RT_OPTS_THREAD */
-    {
-        update_scene(this, -thnum, 1);
-    }
-
-    /* update ray positioning and steppers */
-    rt_real h, v;
 
-    RT_VEC3_SET(pos, cam->pos);
-    RT_VEC3_SET(hor, cam->hor);
-    RT_VEC3_SET(ver, cam->ver);
-    RT_VEC3_SET(nrm, cam->nrm);
+    /* lists are taken from the struct being rendered,
+     * the one swapped in may not have been copied over */
+    rt_pntr *lst = srf->s_srf->lst_p;
+    rt_pntr *old = srf->t_srf->lst_p;
 
-    h = -0.5f * 1.0f;
-    v = -0.5f * aspect;
-
-    /* aim rays at camera's top-left corner */
-    RT_VEC3_MUL_VAL1(dir, nrm, cam->pov);
-    RT_VEC3_MAD_VAL1(dir, hor, h);
-    RT_VEC3_MAD_VAL1(dir, ver, v);
+    srf->s_srf->msc_p[2] = flink((rt_ELEM *)srf->t_srf->msc_p[2]);
 
-    /* update tile positioning and steppers */
-    RT_VEC3_ADD(org, pos, dir);
+    lst[0] = llink((rt_ELEM *)old[0]);
+    lst[1] = llink((rt_ELEM *)old[1]);
+    lst[2] = old[2] == old[0] ? lst[0] : llink((rt_ELEM *)old[2]);
+    lst[3] = old[3] == old[1] ? lst[1] : llink((rt_ELEM *)old[3]);
+}
 
-    h = 1.0f / (factor * pfm->tile_w); /* x_res / tile_w */
-    v = 1.0f / (factor * pfm->tile_h); /* x_res / tile_h */
+/*
+ * Start traversal of the run "lst" at hierarchy level "lvl"
+ * in "lsort", if the run is gridded and the query capsule is set,
+ * only elements with cells overlapping the capsule are visited
+ * (in list order), return the first element to visit or NULL.
+ */
+rt_ELEM* rt_SceneThread::gfirst(rt_ELEM *lst, rt_si32 lvl)
+{
+    rt_GRID *grd = RT_NULL;
 
-    RT_VEC3_MUL_VAL1(htl, hor, h);
-    RT_VEC3_MUL_VAL1(vtl, ver, v);
+    g_ofs[lvl] = lvl == 0 ? 0 : g_ofs[lvl - 1] + (g_grd[lvl - 1] == RT_NULL ?
+                                0 : (g_grd[lvl - 1]->num + 31) / 32);
 
-    /* 2nd phase of multi-threaded update */
-#if RT_OPTS_THREAD != 0
-    if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene() && !g_print
-#if RT_OPTS_UPDATE_EXT2 != 0
-    &&  (opts & RT_OPTS_UPDATE_EXT2) == 0
-#endif /* RT_OPTS_UPDATE_EXT2 */
-       )
-    {
-        this->f_update(tdata, thnum, 2);
-    }
-    else
-#endif /* RT_OPTS_THREAD */
+    if (g_use && lst != RT_NULL)
     {
-        update_scene(this, -thnum, 2);
+        for (grd = scene->hgrid; grd != RT_NULL; grd = grd->next)
+        {
+            if (grd->elm[0] == lst)
+            {
+                break;
+            }
+        }
     }
 
-    /* phase 2.5, hierarchical update of arrays' bounds from surfaces */
-    root->update_bounds();
-
-    rt_Surface *srf;
+    g_grd[lvl] = grd;
 
-    /* update surfaces' node lists */
-    for (srf = srf_head; srf != RT_NULL; srf = srf->next)
+    if (grd == RT_NULL)
     {
-        /* rebuild surface's node list (per-surface)
-         * based on transform flags and arrays' bounds */
-        tharr[0]->snode(srf);
+        return lst;
     }
 
-    /* rebuild global hierarchical list */
-    hlist = tharr[0]->ssort(RT_NULL);
+    rt_ui32 *bit = g_bit + g_ofs[lvl];
 
-    /* rebuild global surface/node list */
-    slist = tharr[0]->ssort(RT_NULL);
-    tharr[0]->filter(RT_NULL, &slist);
+    memset(bit, 0, sizeof(rt_ui32) * ((grd->num + 31) / 32));
 
-    /* rebuild global light/shadow list,
-     * "slist" is needed inside */
-    llist = tharr[0]->lsort(RT_NULL);
+    gwalk(grd, bit, 0, g_org, g_vec, g_rad, 0.0f);
 
-    /* rebuild camera's surface/node list,
-     * "slist" is needed inside */
-    clist = tharr[0]->ssort(cam);
+    g_pos[lvl] = -1;
 
-    if (g_print)
+    return gnext(RT_NULL, lvl);
+}
+
+/*
+ * Mark elements of the grid "grd" in cells overlapping the query capsule
+ * (segment from "org" along "vec" with radius "rad" growing by "tan"
+ * towards its end to query cones) along with grid's boundless elements
+ * as candidates in the bitmap "bit" by their positions in the run,
+ * or by their nodes' indices if "idx" is set (the same node
+ * can be found in a run twice as trnode/bvnode).
+ */
+rt_void rt_SceneThread::gwalk(rt_GRID *grd, rt_ui32 *bit, rt_si32 idx,
+                       rt_real *org, rt_real *vec, rt_real rad, rt_real tan)
+{
+    rt_si32 i, j, k, e, a, b, c, x, y, r0[3], r1[3];
+
+    for (i = 0; i < grd->inf_num; i++)
     {
-        RT_PRINT_GLB();
-        RT_PRINT_SRF_LST(slist);
-        RT_PRINT_LGT_LST(llist);
-        RT_PRINT_CAM(cam);
-        RT_PRINT_SRF_LST(clist);
+        e = grd->inf[i];
+        e = idx ? ((rt_BOUND *)grd->elm[e]->temp)->idx : e;
+        bit[e >> 5] |= (rt_ui32)1 << (e & 31);
     }
 
-    /* 3rd phase of multi-threaded update */
-#if RT_OPTS_THREAD != 0
-    if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene() && !g_print
-#if RT_OPTS_UPDATE_EXT3 != 0
-    &&  (opts & RT_OPTS_UPDATE_EXT3) == 0
-#endif /* RT_OPTS_UPDATE_EXT3 */
-       )
+    /* walk cell slabs along capsule's major axis "a",
+     * in each slab only cover capsule's part within it,
+     * radius at the far end is used to select the slabs */
+    a = RT_FABS(vec[RT_X]) > RT_FABS(vec[RT_Y]) ? RT_X : RT_Y;
+    a = RT_FABS(vec[RT_Z]) > RT_FABS(vec[a]) ? RT_Z : a;
+    b = (a + 1) % 3;
+    c = (a + 2) % 3;
+
+    rt_real t0, t1, v0, v1, lo, hi, r = rad + tan;
+    rt_real tmn = 0.0f, tmx = 1.0f;
+
+    /* clip segment to grid's bounds (extended by radius) */
+    for (k = 0; k < 3; k++)
     {
-        this->f_update(tdata, thnum, 3);
+        lo = grd->org[k] - r;
+        hi = grd->org[k] + r + (grd->scl[k] > 0.0f ?
+                                  grd->dim[k] / grd->scl[k] : 0.0f);
+
+        if (vec[k] == 0.0f)
+        {
+            if (org[k] < lo || org[k] > hi)
+            {
+                return;
+            }
+            continue;
+        }
+
+        t0 = (lo - org[k]) / vec[k];
+        t1 = (hi - org[k]) / vec[k];
+
+        tmn = RT_MAX(tmn, RT_MIN(t0, t1));
+        tmx = RT_MIN(tmx, RT_MAX(t0, t1));
     }
-    else
-#endif /* RT_OPTS_THREAD */
+
+    if (tmn > tmx)
     {
-        update_scene(this, -thnum, 3);
+        return;
     }
 
-    /* screen tiling */
-    rt_si32 tline, j;
+    v0 = org[a] + vec[a] * tmn;
+    v1 = org[a] + vec[a] * tmx;
 
-#if RT_OPTS_TILING != 0
-    if ((opts & RT_OPTS_TILING) != 0)
-    {
-        memset(tiles, 0, sizeof(rt_ELEM *) * tiles_in_row * tiles_in_col);
+    r0[a] = grid_cell(grd, RT_MIN(v0, v1) - r, a);
+    r1[a] = grid_cell(grd, RT_MAX(v0, v1) + r, a);
 
-        rt_ELEM *elm, *nxt, *ctail = RT_NULL, **ptr = &ctail;
+    for (j = r0[a]; j <= r1[a]; j++)
+    {
+        t0 = tmn;
+        t1 = tmx;
 
-        /* build exact copy of reversed "clist" (should be cheap),
-         * trnode elements become tailing rather than heading,
-         * elements grouping for cached transform is retained */
-        for (nxt = clist; nxt != RT_NULL; nxt = nxt->next)
+        /* segment's part within slab (extended by radius) */
+        if (grd->dim[a] > 1 && vec[a] != 0.0f)
         {
-            /* alloc new element as "nxt's" copy */
-            elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
-            elm->data = nxt->data;
-            elm->simd = nxt->simd;
-            elm->temp = nxt->temp;
-            /* insert element as list's head */
-            elm->next = *ptr;
-           *ptr = elm;
-        }
+            lo = grd->org[a] + (j + 0) / grd->scl[a] - rad - tan;
+            hi = grd->org[a] + (j + 1) / grd->scl[a] + rad + tan;
 
-        /* traverse reversed "clist" to keep original "clist's" order
-         * and optimize trnode handling for each tile */
-        for (elm = ctail; elm != RT_NULL; elm = elm->next)
-        {
-            rt_Node *nd = (rt_Node *)((rt_BOUND *)elm->temp)->obj;
+            t0 = (lo - org[a]) / vec[a];
+            t1 = (hi - org[a]) / vec[a];
 
-            /* skip trnode elements from reversed "clist"
-             * as they are handled separately for each tile */
-            if (RT_IS_ARRAY(nd))
+            if (t0 > t1)
             {
-                continue;
+                v0 = t0;
+                t0 = t1;
+                t1 = v0;
             }
 
-            rt_Surface *srf = (rt_Surface *)nd;
+            t0 = RT_MAX(t0, tmn);
+            t1 = RT_MIN(t1, tmx);
 
-            rt_ELEM *tls = (rt_ELEM *)srf->s_srf->msc_p[0], *trn;
-
-            if (srf->trnode != RT_NULL && srf->trnode != srf)
+            if (t0 > t1)
             {
-                for (; tls != RT_NULL; tls = nxt)
-                {
-                    i = (rt_word)tls->data >> 16;
-                    j = (rt_word)tls->data & 0xFFFF;
-
-                    nxt = tls->next;
-
-                    tls->data = 0;
-
-                    tline = i * tiles_in_row;
+                continue;
+            }
+        }
 
-                    /* check matching existing trnode for insertion,
-                     * only tile list's head needs to be checked as elements
-                     * grouping for cached transform is retained from "clist" */
-                    trn = tiles[tline + j];
+        /* radius at slab's far end */
+        r = rad + tan * t1;
 
-                    rt_Array *arr = (rt_Array *)srf->trnode;
-                    rt_BOUND *trb = (rt_BOUND *)srf->trn->temp;
+        for (i = 1; i < 3; i++)
+        {
+            k = (a + i) % 3;
 
-                    if (trn != RT_NULL && trn->temp == trb)
-                    {
-                        /* insert element under existing trnode */
-                        tls->next = trn->next;
-                        trn->next = tls;
-                    }
-                    else
-                    {
-                        /* insert element as list's head */
-                        tls->next = tiles[tline + j];
-                        tiles[tline + j] = tls;
+            v0 = org[k] + vec[k] * t0;
+            v1 = org[k] + vec[k] * t1;
 
-                        /* alloc new trnode element as none has been found */
-                        trn = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
-                        trn->data = (rt_cell)tls; /* trnode's last element */
-                        trn->simd = arr->s_srf;
-                        trn->temp = trb;
-                        /* insert element as list's head */
-                        trn->next = tiles[tline + j];
-                        tiles[tline + j] = trn;
-                    }
-                }
-            }
-            else
-            {
-                for (; tls != RT_NULL; tls = nxt)
-                {
-                    i = (rt_word)tls->data >> 16;
-                    j = (rt_word)tls->data & 0xFFFF;
+            r0[k] = grid_cell(grd, RT_MIN(v0, v1) - r, k);
+            r1[k] = grid_cell(grd, RT_MAX(v0, v1) + r, k);
+        }
 
-                    nxt = tls->next;
+        for (y = r0[c]; y <= r1[c]; y++)
+        for (x = r0[b]; x <= r1[b]; x++)
+        {
+            rt_si32 p[3];
 
-                    tls->data = 0;
+            p[a] = j;
+            p[b] = x;
+            p[c] = y;
 
-                    tline = i * tiles_in_row;
+            k = (p[2] * grd->dim[1] + p[1]) * grd->dim[0] + p[0];
 
-                    /* insert element as list's head */
-                    tls->next = tiles[tline + j];
-                    tiles[tline + j] = tls;
-                }
+            for (i = grd->cel[k]; i < grd->cel[k + 1]; i++)
+            {
+                e = grd->idx[i];
+                e = idx ? ((rt_BOUND *)grd->elm[e]->temp)->idx : e;
+                bit[e >> 5] |= (rt_ui32)1 << (e & 31);
             }
         }
+    }
+}
 
-        if (g_print)
-        {
-            rt_si32 i = 0, j = 0;
+/*
+ * Query the gridded run of "tem" (if any) with the cone of "tem's"
+ * bounding sphere as seen from "obj" in "insert", run's nodes overlapping
+ * the cone are marked as candidates in thread's bitmap, other nodes are
+ * neutral to "tem" in "order", thus "bbox_sort" is only called for
+ * nearby pairs (bitmap is sized for the longest gridded run).
+ */
+rt_void rt_SceneThread::gcone(rt_Object *obj, rt_ELEM *tem)
+{
+    rt_BOUND *box = (rt_BOUND *)tem->temp;
+    rt_ELEM *par = RT_GET_PTR(tem->data);
 
-            tline = i * tiles_in_row;
+    q_box = RT_NULL;
 
-            RT_PRINT_TLS_LST(tiles[tline + j], i, j);
-        }
+    if (box->rad == RT_INF)
+    {
+        return;
     }
-    else
-#endif /* RT_OPTS_TILING */
+
+    if (q_grd == RT_NULL || RT_GET_PTR(q_grd->elm[0]->data) != par)
     {
-        for (i = 0; i < tiles_in_col; i++)
+        for (q_grd = scene->hgrid; q_grd != RT_NULL; q_grd = q_grd->next)
         {
-            tline = i * tiles_in_row;
-
-            for (j = 0; j < tiles_in_row; j++)
+            if (RT_GET_PTR(q_grd->elm[0]->data) == par)
             {
-                tiles[tline + j] = clist;
+                break;
             }
         }
     }
 
-    /* aim rays at pixel centers */
-    RT_VEC3_MUL_VAL1(hor, hor, factor);
-    RT_VEC3_MUL_VAL1(ver, ver, factor);
-
-    RT_VEC3_MAD_VAL1(dir, hor, 0.5f);
-    RT_VEC3_MAD_VAL1(dir, ver, 0.5f);
+    if (q_grd == RT_NULL)
+    {
+        return;
+    }
 
-    /* accumulate ambient from camera and all light sources */
-    RT_VEC3_MUL_VAL1(amb, cam->cam->col.hdr, cam->cam->lum[0]);
-    amb[RT_A] = cam->cam->lum[0];
+    rt_si32 a, e, clp = 0;
 
-    rt_Light *lgt = RT_NULL;
+#if RT_OPTS_INSERT_EXT2 != 0
+    clp = (scene->opts & RT_OPTS_INSERT_EXT2) != 0;
+#endif /* RT_OPTS_INSERT_EXT2 */
 
-    for (lgt = lgt_head; lgt != RT_NULL; lgt = lgt->next)
+    /* clip relations of the node may order it regardless of the cones */
+    if (clp && node_clip(box))
     {
-        RT_VEC3_MAD_VAL1(amb, lgt->lgt->col.hdr, lgt->lgt->lum[0]);
-        amb[RT_A] += lgt->lgt->lum[0];
+        return;
     }
 
-#if RT_OPTS_UPDATE_EXT0 != 0
-    } /* --<----<-- skip update1 --<----<-- */
-#endif /* RT_OPTS_UPDATE_EXT0 */
-
+    rt_VCONE cn;
+    bbox_cone(obj->bvbox, box, &cn);
 
-#if RT_OPTS_RENDER_EXT0 != 0
-    if ((opts & RT_OPTS_RENDER_EXT0) == 0)
-    { /* -->---->-- skip render0 -->---->-- */
-#endif /* RT_OPTS_RENDER_EXT0 */
+    /* wide cones (or those from within the bounding sphere)
+     * overlap most of the run, leave them to "bbox_sort",
+     * others are widened to cover its thresholds */
+    rt_real ang = cn.ang + RT_GRID_ANG;
 
-    /* multi-threaded render */
-#if RT_OPTS_THREAD != 0
-    if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene()
-#if RT_OPTS_RENDER_EXT1 != 0
-    &&  (opts & RT_OPTS_RENDER_EXT1) == 0
-#endif /* RT_OPTS_RENDER_EXT1 */
-       )
+    if (ang > (rt_real)RT_PI / 3.0f)
     {
-        this->f_render(tdata, thnum, 1);
+        return;
     }
-    else
-#endif /* RT_OPTS_THREAD */
+
+    /* query the cone up to the grid's far corner from "obj" */
+    rt_real *pps = obj->bvbox->mid;
+    rt_real d0, d1, len = 0.0f;
+
+    for (a = 0; a < 3; a++)
     {
-        render_scene(this, -thnum, 1);
+        d0 = RT_FABS(q_grd->org[a] - pps[a]);
+        d1 = q_grd->scl[a] > 0.0f ? RT_FABS(q_grd->org[a]
+                        + q_grd->dim[a] / q_grd->scl[a] - pps[a]) : d0;
+        d0 = RT_MAX(d0, d1);
+        len += d0 * d0;
     }
 
-#if RT_OPTS_RENDER_EXT0 != 0
-    } /* --<----<-- skip render0 --<----<-- */
-#endif /* RT_OPTS_RENDER_EXT0 */
+    len = RT_SQRT(len);
+    ang = ang * (rt_real)(180.0 / RT_PI);
 
+    rt_vec4 vec;
+    RT_VEC3_MUL_VAL1(vec, cn.vec, len / cn.len);
 
-#if RT_OPTS_UPDATE_EXT0 != 0
-    if ((opts & RT_OPTS_UPDATE_EXT0) == 0)
-    { /* -->---->-- skip update2 -->---->-- */
-#endif /* RT_OPTS_UPDATE_EXT0 */
+    memset(q_bit, 0, sizeof(rt_ui32) * ((q_grd->num + 31) / 32));
 
-    /* print state done */
-    if (g_print)
+    gwalk(q_grd, q_bit, 1, pps, vec, 0.0f,
+          len * RT_SINA(ang) / RT_COSA(ang));
+
+    for (a = 0; clp && a < q_grd->clp_num; a++)
     {
-        RT_PRINT_STATE_DONE();
-        g_print = RT_FALSE;
+        e = q_grd->clp[a];
+        e = ((rt_BOUND *)q_grd->elm[e]->temp)->idx;
+        q_bit[e >> 5] |= (rt_ui32)1 << (e & 31);
     }
 
-    /* release memory for temporary per-frame allocs */
-    for (i = 0; i < thnum; i++)
+    q_box = box;
+}
+
+/*
+ * Return the element to visit after "elm" at hierarchy level "lvl"
+ * in "lsort", next candidate from the query for gridded runs.
+ */
+rt_ELEM* rt_SceneThread::gnext(rt_ELEM *elm, rt_si32 lvl)
+{
+    rt_GRID *grd = g_grd[lvl];
+
+    if (grd == RT_NULL)
     {
-        tharr[i]->release(tharr[i]->mpool);
+        return elm->next;
     }
 
-    release(mpool);
+    rt_ui32 *bit = g_bit + g_ofs[lvl];
+    rt_si32 k;
 
-#if RT_OPTS_UPDATE_EXT0 != 0
-    } /* --<----<-- skip update2 --<----<-- */
-    else
+    for (k = g_pos[lvl] + 1; k < grd->num; k++)
+    {
+        rt_ui32 w = bit[k >> 5] >> (k & 31);
+
+        if (w == 0)
+        {
+            k |= 31; /* skip the rest of empty word */
+            continue;
+        }
+
+        while ((w & 1) == 0)
+        {
+            w >>= 1;
+            k++;
+        }
+
+        g_pos[lvl] = k;
+
+        return grd->elm[k];
+    }
+
+    g_pos[lvl] = grd->num;
+
+    return RT_NULL;
+}
+
+/*
+ * Deinitialize scene thread.
+ */
+rt_SceneThread::~rt_SceneThread()
+{
+    ASM_DONE(s_inf)
+}
+
+/******************************************************************************/
+/**********************************   SCENE   *********************************/
+/******************************************************************************/
+
+/*
+ * Allocate scene in custom heap.
+ * Heap "hp" must be the same object as platform "pfm" in constructor.
+ */
+rt_pntr rt_Scene::operator new(size_t size, rt_Heap *hp)
+{
+    return hp->obj_alloc(size, RT_ALIGN);
+}
+
+/*
+ * Delete scene from custom heap.
+ */
+rt_void rt_Scene::operator delete(rt_pntr ptr)
+{
+    ((rt_Scene *)ptr)->pfm->obj_free(ptr);
+}
+
+/*
+ * Instantiate scene.
+ * Can only be called from single (main) thread.
+ * Platform "pfm" must be the same object as heap "hp" in custom "new".
+ */
+rt_Scene::rt_Scene(rt_SCENE *scn, /* "frame" must be SIMD-aligned or NULL */
+                   rt_si32 x_res, rt_si32 y_res, rt_si32 x_row, rt_ui32 *frame,
+                   rt_Platform *pfm) :
+
+    rt_Registry(pfm->f_alloc, pfm->f_free),
+    rt_List<rt_Scene>(RT_NULL)
+{
+    this->pfm = pfm;
+
+    /* init thread-group before joining the platform,
+     * scene starts on platform's pool until next render */
+    gbudget = 0;
+    gfirst = 0;
+    gnum = 1;
+    gcur = -1;
+    gpool = RT_NULL;
+
+    pfm->add_scene(this);
+
+    thnum = pfm->thnum;
+    thmax = pfm->thnum;
+    tdata = pfm->tdata;
+    tharr = RT_NULL;
+
+    /* group threads by NUMA node */
+    thgrp = (rt_si32 *)alloc(sizeof(rt_si32) * thmax, RT_ALIGN);
+    ndmap = (rt_si32 *)alloc(sizeof(rt_si32) * thmax, RT_ALIGN);
+    rband = (volatile rt_si32 *)
+            alloc(sizeof(rt_si32) * RT_BAND_PAD * thmax, RT_ALIGN);
+
+    group_nodes();
+
+    rt_si32 i;
+
+    pipe_on = 0;
+    pipe_set = 0;
+    pipe_time = 0;
+    pipe_upd = 0;
+    pipe_lnk = 0;
+    pipe_num = 1;
+    pipe_bar = RT_NULL;
+    pipe_cmd = 0;
+    pipe_err = RT_NULL;
+    ppool = RT_NULL;
+
+    async = RT_NULL;
+    async_time = 0;
+    fence_pend = 0;
+    fence_last = 0;
+
+    tlist = RT_NULL;
+    tnum = 0;
+    xlist = RT_NULL;
+    xnum = 0;
+    tnext = 0;
+    ttime = 0;
+
+    ccur = 0;
+    imbal[0] = 1.0f;
+    imbal[1] = 1.0f;
+
+    occ_on = 0;
+    memset(occup, 0, sizeof(occup));
+    memset(opack, 0, sizeof(opack));
+
+    f_update = pfm->f_update;
+    f_render = pfm->f_render;
+
+    this->scn = scn;
+
+    /* check for locked scene data, not thread safe! (it's ok, not a bug) */
+    if (scn->lock != RT_NULL)
+    {
+        throw rt_Exception("scene data is locked by another instance");
+    }
+
+    /* "x_row", frame's stride (in 32-bit pixels, not bytes!),
+     * can be greater than "x_res", in which case the frame
+     * occupies only a portion (rectangle) of the framebuffer,
+     * or negative, in which case frame starts at the last line
+     * and consecutive lines are located backwards in memory,
+     * "x_row" must contain the whole number of SIMD widths */
+    if (x_res == 0 || y_res == 0 || RT_ABS32(x_row) < x_res)
+    {
+        throw rt_Exception("frambuffer's dimensions are not valid");
+    }
+
+#if (RT_POINTER - RT_ADDRESS) != 0
+
+    /* always reallocate frame in custom heap for 64-bit
+     * if 32-bit address range is enabled in makefiles */
+    frame = RT_NULL;
+
+#endif /* (RT_POINTER - RT_ADDRESS) */
+
+    if (((rt_word)frame & (RT_SIMD_ALIGN - 1)) != 0 || frame == RT_NULL
+    || (RT_ABS32(x_row) & (RT_SIMD_WIDTH - 1)) != 0)
+    {
+        rt_si32 y_sgn = RT_SIGN(x_row);
+
+        x_row = RT_ABS32(x_row);
+        x_row = ((x_row + RT_SIMD_WIDTH - 1) / RT_SIMD_WIDTH) * RT_SIMD_WIDTH;
+
+        frame = (rt_ui32 *)
+                alloc(x_row * y_res * sizeof(rt_ui32), RT_SIMD_ALIGN);
+
+        x_row *= y_sgn;
+
+        if (x_row < 0)
+        {
+            frame += RT_ABS32(x_row) * (y_res - 1);
+        }
+    }
+
+    /* init framebuffer's dimensions and pointer */
+    this->x_res = x_res;
+    this->y_res = y_res;
+    this->x_row = x_row;
+    this->frame = frame;
+
+    /* init swap-chain with a single framebuffer */
+    memset(fbuf, 0, sizeof(fbuf));
+    fbuf[0] = frame;
+    fnum = 1;
+    fcur = 0;
+    fnext = 0;
+
+    /* init tile dimensions from platform, kept for scene's lifetime */
+    tile_w = pfm->tile_w;
+    tile_h = pfm->tile_h;
+
+    /* init tilebuffer's dimensions and pointer */
+    tiles_in_row = (x_res + tile_w - 1) / tile_w;
+    tiles_in_col = (y_res + tile_h - 1) / tile_h;
+
+    tiles = (rt_ELEM **)
+            alloc(tiles_in_row * tiles_in_col * sizeof(rt_ELEM *), RT_ALIGN);
+
+    memset(tiles, 0, tiles_in_row * tiles_in_col * sizeof(rt_ELEM *));
+
+    t_tiles = (rt_ELEM **)
+            alloc(tiles_in_row * tiles_in_col * sizeof(rt_ELEM *), RT_ALIGN);
+
+    memset(t_tiles, 0, tiles_in_row * tiles_in_col * sizeof(rt_ELEM *));
+
+    tcones = (rt_VCONE *)
+            alloc(tiles_in_row * tiles_in_col * sizeof(rt_VCONE), RT_ALIGN);
+
+    /* init dirty tiles, the first frame is rendered fully */
+    dsign = (rt_ui64 *)
+            alloc(tiles_in_row * tiles_in_col * sizeof(rt_ui64), RT_ALIGN);
+
+    memset(dsign, 0, tiles_in_row * tiles_in_col * sizeof(rt_ui64));
+
+    drows = (rt_si32 *)
+            alloc(tiles_in_col * sizeof(rt_si32), RT_ALIGN);
+
+    t_rows = (rt_si32 *)
+            alloc(tiles_in_col * sizeof(rt_si32), RT_ALIGN);
+
+    dfull = 1;
+    dall = 1;
+
+    for (i = 0; i < tiles_in_col; i++)
+    {
+        drows[i] = 1;
+        t_rows[i] = 1;
+    }
+
+    /* render reads the update's originals until handed over */
+    rclst = RT_NULL;
+    rtile = tiles;
+    rrows = drows;
+
+    memset(dcam, 0, sizeof(dcam));
+    memset(dmode, 0, sizeof(dmode));
+
+    /* place framebuffer's row-bands on the nodes
+     * of threads rendering them before first touch */
+    bind_rows(frame, x_row * sizeof(rt_ui32));
+
+    memset(frame, 0, x_row * y_res * sizeof(rt_ui32));
+
+    /* init pixel-width, aspect-ratio, ray-depth */
+    factor = 1.0f / (rt_real)x_res;
+    aspect = (rt_real)y_res * factor;
+    depth = RT_MAX(RT_STACK_DEPTH, 0);
+    opts &= ~scn->opts;
+
+    if ((opts & RT_OPTS_PT) == 0)
+    {
+        /* alloc framebuffer's seed-plane for path-tracer */
+        pseed = (rt_elem *)
+                alloc(4 * x_row * y_res * sizeof(rt_elem), RT_SIMD_ALIGN);
+
+                /* pseed is initialized in reset_pseed() */
+
+        /* alloc framebuffer's color-planes for path-tracer */
+        ptr_r = (rt_real *)
+                alloc(4 * x_row * y_res * sizeof(rt_real), RT_SIMD_ALIGN);
+        ptr_g = (rt_real *)
+                alloc(4 * x_row * y_res * sizeof(rt_real), RT_SIMD_ALIGN);
+        ptr_b = (rt_real *)
+                alloc(4 * x_row * y_res * sizeof(rt_real), RT_SIMD_ALIGN);
+
+        bind_rows(pseed, 4 * x_row * sizeof(rt_elem));
+        bind_rows(ptr_r, 4 * x_row * sizeof(rt_real));
+        bind_rows(ptr_g, 4 * x_row * sizeof(rt_real));
+        bind_rows(ptr_b, 4 * x_row * sizeof(rt_real));
+
+                /* ptr_* is initialized in reset_color() */
+    }
+    else
+    {
+        pseed = RT_NULL;
+        ptr_r = RT_NULL;
+        ptr_g = RT_NULL;
+        ptr_b = RT_NULL;
+    }
+
+    pt_on = RT_FALSE;
+
+    /* instantiate object hierarchy */
+    memset(&rootobj, 0, sizeof(rt_OBJECT));
+
+    rootobj.trm.scl[RT_I] = 1.0f;
+    rootobj.trm.scl[RT_J] = 1.0f;
+    rootobj.trm.scl[RT_K] = 1.0f;
+    rootobj.obj = scn->root;
+
+    if (!RT_IS_ARRAY(&scn->root))
+    {
+        throw rt_Exception("scene's root is not an array");
+    }
+
+    root = new(this) rt_Array(this, RT_NULL, &rootobj); /* also init "*_num" */
+
+    if (cam_head == RT_NULL)
+    {
+        throw rt_Exception("scene doesn't contain camera");
+    }
+
+    cam = cam_head;
+    cam_idx = 0;
+
+    /* lock scene data, when scene's constructor can no longer fail */
+    scn->lock = this;
+
+    /* create scene threads array */
+    tharr = (rt_SceneThread **)
+            alloc(sizeof(rt_SceneThread *) * thnum, RT_ALIGN);
+
+    /* all surfaces' costs are zero (plus one) at first */
+    csum[0][0] = csum[0][1] = srf_num;
+    csum[1][0] = csum[1][1] = srf_num;
+
+    /* create subtree tasks lists */
+    tlist = (rt_Object **)alloc(sizeof(rt_Object *) *
+            (cam_num + lgt_num + arr_num + srf_num), RT_ALIGN);
+    xlist = (rt_Array **)alloc(sizeof(rt_Array *) * arr_num, RT_ALIGN);
+
+    /* create changed surfaces list */
+    ulist = (rt_Surface **)alloc(sizeof(rt_Surface *) * srf_num, RT_ALIGN);
+    unum = 0;
+
+    for (i = 0; i < thnum; i++)
+    {
+        tharr[i] = new(this) rt_SceneThread(this, i);
+
+        /* estimate per-frame allocs to reduce system calls per thread */
+        tharr[i]->msize =  /* upper bound per surface for tiling */
+            (tiles_in_row * tiles_in_col + /* plus array nodes list */
+             (arr_num + 2) +     /* plus reflections/refractions */
+             (srf_num + arr_num * 2 + /* plus lights and shadows */
+             (srf_num + arr_num * 2 + 1) * lgt_num) * 2) * /* for both sides */
+            sizeof(rt_ELEM) * (srf_num + thnum - 1) / thnum; /* per thread */
+    }
+
+    pending = 0;
+
+    /* first frame builds all cross-frame lists */
+    lfull = 1;
+    lmode = 0;
+    lage = 0;
+    lkeep = 1;
+    t_update = 0;
+    bvauto = 0;
+
+    /* mip chains are built on first filtered frame */
+    mips = -1;
+
+    /* grids are built with "hlist" */
+    hgrid = RT_NULL;
+
+    /* global lists are relinked only in pipelined mode */
+    s_lnk = RT_NULL;
+    l_lnk = RT_NULL;
+
+    /* init memory pool in the heap for temporary per-frame allocs */
+    mpool = RT_NULL; /* rough estimate for surface relations/templates */
+    msize = ((srf_num + 1) * (srf_num + 1) * 2 + /* plus two surface lists */
+             (srf_num + arr_num * 1) * 2 + /* plus lights and shadows list */
+             (srf_num + arr_num * 2 + 1) * lgt_num + /* plus array nodes */
+             tiles_in_row * tiles_in_col * arr_num) *  /* for tiling */
+            sizeof(rt_ELEM);                        /* for main thread */
+
+    /* in the estimates above ("arr_num" * x) depends on whether both
+     * trnode/bvnode are allowed in the list or just one of them,
+     * if the estimates are not accurate the engine should still work,
+     * though not as efficient due to unnecessary allocations per frame
+     * or unused extra memory reservation resulting in larger footprint */
+}
+
+/*
+ * Update current camera with given "action" for a given "time".
+ */
+rt_void rt_Scene::update(rt_time time, rt_si32 action)
+{
+    cam->update_action(time, action);
+}
+
+/*
+ * Update backend data structures and render frame for a given "time",
+ * block until finished.
+ */
+rt_void rt_Scene::render(rt_time time)
+{
+    /* finish asynchronous render in flight */
+    wait_fence(fence_last);
+
+    update_group();
+
+    render_frame(time);
+    swap_frame();
+}
+
+/*
+ * Start rendering frame for a given "time" in the background,
+ * return fence to be polled or waited on for its completion.
+ * Only one frame is in flight, previous one is waited on first.
+ * Until the fence is passed get_frame returns the previous frame,
+ * scene must not be updated or changed in any other way.
+ */
+rt_si32 rt_Scene::render_async(rt_time time)
+{
+    wait_fence(fence_last);
+
+    update_group();
+
+    if (async == RT_NULL)
+    {
+        /* single driver thread runs render, it waits
+         * on scene's threads most of the time, thus
+         * never spins and isn't pinned to a CPU */
+        async = new rt_ThreadPool(-1, async_task, this, RT_FALSE, 0);
+    }
+
+    async_time = time;
+    fence_pend = ++fence_last;
+
+    async->start(0);
+
+    return fence_pend;
+}
+
+/*
+ * Task of the asynchronous render's driver thread.
+ */
+rt_void rt_Scene::async_task(rt_pntr arg, rt_si32 /* index */,
+                                          rt_si32 /* cmd */)
+{
+    rt_Scene *scn = (rt_Scene *)arg;
+
+    scn->render_frame(scn->async_time);
+}
+
+/*
+ * Check whether scene's phases can run on threads: on its own
+ * thread-group in platform's split mode, otherwise on platform's pool
+ * if the scene is current.
+ */
+rt_bool rt_Scene::is_threaded()
+{
+    /* update ahead of the next frame runs on the last render threads */
+    if (pipe_upd)
+    {
+        return pipe_num > 1;
+    }
+
+    return gcur >= 0 ? gpool != RT_NULL : this == pfm->get_cur_scene();
+}
+
+/*
+ * Follow platform's split mode between frames: move scene onto its own
+ * thread-group pinned to CPUs assigned by the platform, or back onto
+ * platform's pool, re-create group's pool when assignment changes.
+ * Can only be called from main thread with no frame in flight.
+ */
+rt_void rt_Scene::update_group()
+{
+    rt_si32 i, first, num;
+
+    first = pfm->split ? gfirst : -1;
+    num = pfm->split ? RT_MIN(gnum, thmax) : thmax;
+
+    if (first == gcur && num == thnum)
+    {
+        return;
+    }
+
+    if (pending)
+    {
+        pending = 0;
+
+        /* release memory reserved with previous thread-group */
+        release_pool();
+    }
+
+    /* drop pipelined update done with previous thread-group,
+     * rebuild cross-frame lists in the heaps of new thread-group */
+    drop_pipe();
+    lfull = 1;
+
+    delete gpool;
+    gpool = RT_NULL;
+
+    if (first >= 0 && num > 1)
+    {
+        gpool = new rt_ThreadPool(-num, group_task, this,
+                                  RT_SETAFFINITY, RT_SPIN_COUNT, first);
+    }
+
+    gcur = first;
+    thnum = num;
+
+    /* own thread-group is driven the same way as platform's default pool,
+     * platform's custom threading callbacks are used outside split mode */
+    f_update = first >= 0 ? update_threads : pfm->f_update;
+    f_render = first >= 0 ? render_threads : pfm->f_render;
+    tdata = first >= 0 ? (rt_pntr)gpool : pfm->tdata;
+
+    group_nodes();
+
+    /* move row-bands to the nodes of new thread-group */
+    for (i = 0; i < RT_FRAMES_MAX; i++)
+    {
+        if (fbuf[i] != RT_NULL)
+        {
+            bind_rows(fbuf[i], x_row * sizeof(rt_ui32));
+        }
+    }
+
+    if (pseed != RT_NULL)
+    {
+        bind_rows(pseed, 4 * x_row * sizeof(rt_elem));
+        bind_rows(ptr_r, 4 * x_row * sizeof(rt_real));
+        bind_rows(ptr_g, 4 * x_row * sizeof(rt_real));
+        bind_rows(ptr_b, 4 * x_row * sizeof(rt_real));
+    }
+}
+
+/*
+ * Group scene's active threads by NUMA node of the pool they run on,
+ * reset row-band counters of dynamic render scheduler.
+ */
+rt_void rt_Scene::group_nodes()
+{
+    rt_si32 i, j, node;
+
+    ndnum = 0;
+
+    for (i = 0; i < thnum; i++)
+    {
+        node = gpool != RT_NULL ? gpool->get_node(i) :
+               gcur >= 0 ? -1 : pfm->get_node(i);
+
+        for (j = 0; j < ndnum && ndmap[j] != node; j++);
+
+        if (j == ndnum)
+        {
+            ndmap[ndnum++] = node;
+        }
+
+        thgrp[i] = j;
+
+        if (tharr != RT_NULL)
+        {
+            tharr[i]->set_node(node);
+        }
+    }
+
+    for (j = 0; j < ndnum; j++)
+    {
+        rband[j * RT_BAND_PAD] = 0;
+    }
+}
+
+/*
+ * Set number of threads scene renders with in platform's split mode,
+ * 0 - share of threads not budgeted by other scenes.
+ * Takes effect on next render.
+ */
+rt_si32 rt_Scene::set_threads(rt_si32 num)
+{
+    gbudget = RT_MAX(num, 0);
+
+    pfm->split_threads();
+
+    return gbudget;
+}
+
+/*
+ * Get number of threads scene renders with.
+ */
+rt_si32 rt_Scene::get_threads()
+{
+    return thnum;
+}
+
+/*
+ * Check whether frame with given "fence" is completed (don't block),
+ * completed frame becomes current in get_frame.
+ */
+rt_bool rt_Scene::poll_fence(rt_si32 fence)
+{
+    if (fence_pend == 0 || fence < fence_pend)
+    {
+        return RT_TRUE;
+    }
+
+    if (!async->done())
+    {
+        return RT_FALSE;
+    }
+
+    wait_fence(fence);
+
+    return RT_TRUE;
+}
+
+/*
+ * Block until frame with given "fence" is completed,
+ * completed frame becomes current in get_frame.
+ * Exception thrown while rendering is passed on from here.
+ */
+rt_void rt_Scene::wait_fence(rt_si32 fence)
+{
+    if (fence_pend == 0 || fence < fence_pend)
+    {
+        return;
+    }
+
+    fence_pend = 0;
+
+    async->wait();
+
+    swap_frame();
+}
+
+/*
+ * Make the frame rendered last current in get_frame,
+ * advance to the next framebuffer in swap-chain.
+ */
+rt_void rt_Scene::swap_frame()
+{
+    fcur = fnext;
+    fnext = (fcur + 1) % fnum;
+    frame = fbuf[fcur];
+}
+
+/*
+ * Set number of framebuffers in swap-chain (1 to RT_FRAMES_MAX),
+ * so that completed frames can be read while next ones render.
+ * Framebuffers beyond the first one are allocated in scene's heap.
+ */
+rt_si32 rt_Scene::set_frames(rt_si32 num)
+{
+    rt_si32 i, n = RT_ABS32(x_row) * y_res;
+
+    wait_fence(fence_last);
+
+    /* framebuffers can't be allocated above per-frame allocs
+     * of the frame updated ahead, as those are released later */
+    drop_pipe();
+
+    num = RT_MIN(RT_MAX(num, 1), RT_FRAMES_MAX);
+
+    for (i = 0; i < num; i++)
+    {
+        if (fbuf[i] != RT_NULL)
+        {
+            continue;
+        }
+
+        rt_ui32 *fb = (rt_ui32 *)
+                alloc(n * sizeof(rt_ui32), RT_SIMD_ALIGN);
+
+        if (x_row < 0)
+        {
+            fb += RT_ABS32(x_row) * (y_res - 1);
+        }
+
+        bind_rows(fb, x_row * sizeof(rt_ui32));
+
+        memset(x_row < 0 ? fb - n + RT_ABS32(x_row) : fb, 0,
+                                                n * sizeof(rt_ui32));
+        fbuf[i] = fb;
+    }
+
+    /* keep current frame within the chain */
+    if (fcur >= num)
+    {
+        fbuf[fcur] = fbuf[0];
+        fbuf[0] = frame;
+        fcur = 0;
+    }
+
+    fnum = num;
+    fnext = (fcur + 1) % fnum;
+
+    /* new framebuffers hold no frame to keep */
+    dfull = 1;
+
+    return fnum;
+}
+
+/*
+ * Update backend data structures (unless done ahead in pipelined mode)
+ * and render frame for a given "time" into the next framebuffer
+ * in swap-chain.
+ */
+rt_void rt_Scene::render_frame(rt_time time)
+{
+    rt_si32 i, j, k;
+
+    /* pipelined mode is not compatible with
+     * state-logging and partial updates */
+    rt_si32 pipe = pipe_on && !g_print
+#if RT_OPTS_UPDATE_EXT0 != 0
+                && (opts & RT_OPTS_UPDATE_EXT0) == 0
+#endif /* RT_OPTS_UPDATE_EXT0 */
+                ;
+
+    /* mip chains are built in the update below once filtering is
+     * first enabled, drop the frame updated ahead without them */
+    if (!pipe || (pfm->filt && mips < 0))
+    {
+        drop_pipe();
+    }
+
+#if RT_OPTS_UPDATE_EXT0 != 0
+    if ((opts & RT_OPTS_UPDATE_EXT0) == 0 || rootobj.time == -1)
+    { /* -->---->-- skip update1 -->---->-- */
+#endif /* RT_OPTS_UPDATE_EXT0 */
+
+    /* in pipelined mode the frame was updated
+     * while rendering the previous one */
+    if (pipe_set == 0)
+    {
+        update_frame(time);
+    }
+
+#if RT_OPTS_UPDATE_EXT0 != 0
+    } /* --<----<-- skip update1 --<----<-- */
+    else
+    {
+        /* nothing updated in this frame */
+        t_update = 0;
+    }
+#endif /* RT_OPTS_UPDATE_EXT0 */
+
+    /* hand ray setup, camera's list, tilebuffer and tile rows
+     * over to the render, in pipelined mode the next frame's
+     * update swaps in their twins while the frame renders */
+    RT_VEC3_SET(rpos, pos);
+    RT_VEC3_SET(rdir, dir);
+    RT_VEC3_SET(rhor, hor);
+    RT_VEC3_SET(rver, ver);
+    RT_VEC3_SET(ramb, amb);
+    ramb[RT_A] = amb[RT_A];
+    rpov = cam->pov;
+
+    rclst = clist;
+    rtile = tiles;
+    rrows = drows;
+
+#if RT_OPTS_RENDER_EXT0 != 0
+    if ((opts & RT_OPTS_RENDER_EXT0) == 0)
+    { /* -->---->-- skip render0 -->---->-- */
+#endif /* RT_OPTS_RENDER_EXT0 */
+
+    /* reset dynamic render scheduler */
+    for (i = 0; i < ndnum; i++)
+    {
+        rband[i * RT_BAND_PAD] = 0;
+    }
+
+    /* time of the next frame updated while rendering in pipelined mode */
+    pipe_time = time;
+
+    rt_time t_frame = get_usec();
+
+    /* multi-threaded render */
+#if RT_OPTS_THREAD != 0
+    if ((opts & RT_OPTS_THREAD) != 0 && is_threaded()
+#if RT_OPTS_RENDER_EXT1 != 0
+    &&  (opts & RT_OPTS_RENDER_EXT1) == 0
+#endif /* RT_OPTS_RENDER_EXT1 */
+       )
+    {
+        /* pipelined update runs on 1/RT_PIPE_PART of render threads
+         * meeting at their own barrier, only engine's pools are known
+         * to run all render slices at once */
+        i = pipe && f_render == render_threads ?
+            RT_MAX(thnum / RT_PIPE_PART, 1) : 1;
+
+        if (i != pipe_num)
+        {
+            delete pipe_bar;
+            pipe_bar = i > 1 ? new rt_Barrier(i) : RT_NULL;
+            pipe_num = i;
+        }
+
+        this->f_render(tdata, thnum, pipe ? 2 : 1);
+    }
+    else
+#endif /* RT_OPTS_THREAD */
+    {
+        pipe_num = 1;
+
+        render_scene(this, -thnum, pipe ? 2 : 1);
+    }
+
+    pipe_set = pipe;
+
+    /* account for threads' idle time at the render barrier */
+    t_frame = get_usec() - t_frame;
+
+    for (i = 0; i < thnum; i++)
+    {
+        tharr[i]->t_busy += tharr[i]->t_last;
+        tharr[i]->t_idle += RT_MAX(t_frame - tharr[i]->t_last, 0);
+        tharr[i]->t_last = 0;
+    }
+
+    /* collect lane occupancy of secondary rays per bounce level,
+     * backend counts packets entering it by remaining depth */
+    for (k = 1; k <= (rt_si32)depth && occ_on; k++)
+    {
+        rt_si64 lanes = 0, packs = 0;
+
+        for (i = 0; i < thnum; i++)
+        {
+            rt_elem *occ = tharr[i]->s_occ
+                         + (depth - k + 1) * 2 * pfm->simd_width;
+
+            for (j = 0; j < pfm->simd_width; j++)
+            {
+                lanes += occ[j];
+            }
+
+            packs += occ[pfm->simd_width];
+        }
+
+        occup[k] = packs > 0 ?
+                   (rt_real)lanes / (rt_real)(packs * pfm->simd_width) : 0.0f;
+        opack[k] = (rt_si32)packs;
+    }
+
+    for (i = 0; i < thnum && occ_on; i++)
+    {
+        memset(tharr[i]->s_occ, 0,
+               2 * RT_SIMD_WIDTH * sizeof(rt_elem) * (1 + depth));
+    }
+
+#if RT_OPTS_RENDER_EXT0 != 0
+    } /* --<----<-- skip render0 --<----<-- */
+    else
+    {
+        /* framebuffer is left behind,
+         * the next frame is rendered fully */
+        dfull = 1;
+
+        /* no update ahead without render */
+        pipe_set = 0;
+    }
+#endif /* RT_OPTS_RENDER_EXT0 */
+
+
+#if RT_OPTS_UPDATE_EXT0 != 0
+    if ((opts & RT_OPTS_UPDATE_EXT0) == 0)
+    { /* -->---->-- skip update2 -->---->-- */
+#endif /* RT_OPTS_UPDATE_EXT0 */
+
+    /* print state done */
+    if (g_print)
+    {
+        RT_PRINT_STATE_DONE();
+        g_print = RT_FALSE;
+    }
+
+    /* release memory for temporary per-frame allocs, in pipelined mode
+     * the rendered frame's allocs were moved to twin chains by the update
+     * of the next frame, which keeps its own until the frame is rendered */
+    if (pipe_set)
+    {
+        release_twin();
+    }
+    else
+    {
+        release_pool();
+    }
+
+#if RT_OPTS_UPDATE_EXT0 != 0
+    } /* --<----<-- skip update2 --<----<-- */
+    else
+    {
+        pending = 1;
+    }
+#endif /* RT_OPTS_UPDATE_EXT0 */
+}
+
+/*
+ * Update backend data structures for a given "time", in pipelined mode
+ * runs on the last render thread into twins of the structs the render
+ * reads, with all phases sequential on that thread.
+ */
+rt_void rt_Scene::update_frame(rt_time time)
+{
+    rt_si32 i, j;
+
+    rt_time t_start = get_usec();
+
+    /* in pipelined mode the frame being rendered keeps backend structs,
+     * tilebuffer and per-frame allocs, the update swaps in their twins,
+     * lists kept across frames are relinked to them below unless
+     * the last update wasn't pipelined, then all are rebuilt */
+    if (pipe_upd)
+    {
+        swap_pool();
+        swap_simd();
+
+        if (pipe_lnk == 0)
+        {
+            lfull = 1;
+        }
+    }
+
+    pipe_lnk = pipe_upd;
+
+    if (pending)
+    {
+        pending = 0;
+
+        /* release memory for temporary per-frame allocs */
+        release_pool();
+    }
+
+    /* build textures' mip chains once filtering is first enabled,
+     * done here as they must outlive the per-frame memory pool */
+    if (pfm->filt && mips < 0)
+    {
+        rt_Material *mtl;
+
+        for (mips = 0, mtl = get_mat(); mtl != RT_NULL; mtl = mtl->next)
+        {
+            mips += mtl->build_mips(this) > 0;
+        }
+    }
+
+    /* reserve memory for temporary per-frame allocs,
+     * threads reserve theirs after phase 1 below */
+    mpool = reserve(msize, RT_QUAD_ALIGN);
+
+    /* print state init */
+    if (g_print)
+    {
+        RT_PRINT_STATE_INIT();
+        RT_PRINT_TIME(time);
+    }
+
+    /* phase 0.5, hierarchical update of arrays' transform matrices */
+#if RT_OPTS_SUBTREE != 0
+    if ((opts & RT_OPTS_SUBTREE) != 0)
+    {
+        update_tree(time);
+    }
+    else
+#endif /* RT_OPTS_SUBTREE */
+    {
+        root->update_object(time, 0, RT_NULL, iden4);
+    }
+
+    /* 1st phase of multi-threaded update */
+#if RT_OPTS_THREAD != 0
+    if ((opts & RT_OPTS_THREAD) != 0 && is_threaded() && !g_print
+#if RT_OPTS_UPDATE_EXT1 != 0
+    &&  (opts & RT_OPTS_UPDATE_EXT1) == 0
+#endif /* RT_OPTS_UPDATE_EXT1 */
+       )
+    {
+        this->f_update(tdata, thnum, 1);
+    }
+    else
+#endif /* RT_OPTS_THREAD */
+    {
+        update_scene(this, -thnum, 1);
+    }
+
+    /* select cross-frame lists to rebuild from changes seen in phase 1,
+     * surface changes add new lists on top of kept ones only for surfaces
+     * whose relations involve changed ones (selected in phase 3),
+     * light-only changes add new light/shadow lists for all surfaces,
+     * once RT_LISTS_AGE frames added lists or too many surfaces changed
+     * all lists are rebuilt (releasing the old ones), camera-only changes
+     * rebuild only camera's list and tiles, which are temporary per-frame */
+    rt_si32 full = lfull || !lkeep || g_print;
+
+    for (lmode = 0, unum = 0, i = 0; i < thnum; i++)
+    {
+        lmode |= tharr[i]->l_chg;
+        unum += tharr[i]->l_num;
+    }
+
+    if (full || unum * RT_LISTS_PART > srf_num
+    || (lmode != 0 && lage >= RT_LISTS_AGE))
+    {
+        full = 1;
+        lfull = 0;
+        lmode = RT_LISTS_ALL | RT_LISTS_NEW;
+        lage = 0;
+
+        for (i = 0; i < thmax; i++)
+        {
+            if (tharr[i]->lpool != RT_NULL)
+            {
+                tharr[i]->release(tharr[i]->lpool);
+                tharr[i]->lpool = RT_NULL;
+            }
+        }
+    }
+    else
+    if (lmode != 0)
+    {
+        lage++;
+    }
+
+    /* reserve memory for threads' per-frame allocs,
+     * frames rebuilding cross-frame lists keep theirs,
+     * in pipelined mode all kept lists are relinked */
+    for (i = 0; i < thnum; i++)
+    {
+        tharr[i]->mpool = tharr[i]->reserve(tharr[i]->msize, RT_QUAD_ALIGN);
+
+        if (full || pipe_upd)
+        {
+            tharr[i]->lpool = tharr[i]->mpool;
+        }
+    }
+
+    if (pipe_upd && !full)
+    {
+        relink_pool();
+    }
+    else
+    {
+        s_lnk = RT_NULL;
+        l_lnk = RT_NULL;
+    }
+
+    /* update ray positioning and steppers */
+    rt_real h, v;
+
+    RT_VEC3_SET(pos, cam->pos);
+    RT_VEC3_SET(hor, cam->hor);
+    RT_VEC3_SET(ver, cam->ver);
+    RT_VEC3_SET(nrm, cam->nrm);
+
+    h = -0.5f * 1.0f;
+    v = -0.5f * aspect;
+
+    /* aim rays at camera's top-left corner */
+    RT_VEC3_MUL_VAL1(dir, nrm, cam->pov);
+    RT_VEC3_MAD_VAL1(dir, hor, h);
+    RT_VEC3_MAD_VAL1(dir, ver, v);
+
+    /* update tile positioning and steppers */
+    RT_VEC3_ADD(org, pos, dir);
+
+    h = 1.0f / (factor * tile_w); /* x_res / tile_w */
+    v = 1.0f / (factor * tile_h); /* x_res / tile_h */
+
+    RT_VEC3_MUL_VAL1(htl, hor, h);
+    RT_VEC3_MUL_VAL1(vtl, ver, v);
+
+    /* 2nd phase of multi-threaded update */
+#if RT_OPTS_THREAD != 0
+    if ((opts & RT_OPTS_THREAD) != 0 && is_threaded() && !g_print
+#if RT_OPTS_UPDATE_EXT2 != 0
+    &&  (opts & RT_OPTS_UPDATE_EXT2) == 0
+#endif /* RT_OPTS_UPDATE_EXT2 */
+       )
+    {
+        this->f_update(tdata, thnum, 2);
+    }
+    else
+#endif /* RT_OPTS_THREAD */
+    {
+        update_scene(this, -thnum, 2);
+    }
+
+    cost_done(0);
+
+    /* collect surfaces changed in this frame (bounds updated above),
+     * extend their bounding spheres of the last frame to the current ones
+     * for selecting lists to rebuild in phase 3 and dirty tiles */
+    rt_Surface *srf;
+
+    for (unum = 0, srf = srf_head; srf != RT_NULL; srf = srf->next)
+    {
+        if (srf->srf_changed == 0)
+        {
+            continue;
+        }
+
+        ulist[unum++] = srf;
+
+        rt_BOUND *box = srf->bvbox;
+
+        if (box->verts_num == 0)
+        {
+            continue;
+        }
+
+        rt_vec4 dff_vec;
+        RT_VEC3_SUB(dff_vec, srf->dmid, box->mid);
+
+        srf->drad = RT_MAX(RT_VEC3_LEN(dff_vec) + srf->drad, box->rad);
+        RT_VEC3_SET(srf->dmid, box->mid);
+    }
+
+    /* select bounding volumes for arrays not bounded in scene data
+     * once surfaces' bounds are available, before arrays' bounds
+     * and node lists are built from them, revisit the selection
+     * with every full rebuild of the lists as objects move */
+#if RT_OPTS_VARRAY != 0
+    if (full && ((opts & RT_OPTS_VARRAY) != 0 || bvauto != 0))
+    {
+        rt_vec4 mid;
+        rt_si32 num = 0;
+
+        /* changed bvnodes redistribute bounds within the hierarchy,
+         * recompute all arrays' bounds */
+        if (bound_auto(root, bound_size(root, mid, &num)) != 0)
+        {
+            rt_Array *arr;
+
+            for (arr = arr_head; arr != RT_NULL; arr = arr->next)
+            {
+                arr->arr_changed = 1;
+            }
+        }
+    }
+#endif /* RT_OPTS_VARRAY */
+
+    /* phase 2.5, hierarchical update of arrays' bounds from surfaces */
+#if RT_OPTS_SUBTREE != 0
+    if ((opts & RT_OPTS_SUBTREE) != 0)
+    {
+        update_bbox();
+    }
+    else
+#endif /* RT_OPTS_SUBTREE */
+    {
+        root->update_bounds();
+    }
+
+    if ((lmode & RT_LISTS_SRF) != 0)
+    {
+        rt_Array *arr;
+
+        /* arrays' boxes in node lists depend on their radii being zero,
+         * which changes the hierarchy (and all lists built from it) */
+        for (arr = arr_head; arr != RT_NULL; arr = arr->next)
+        {
+            if (arr->arr_changed == 0)
+            {
+                continue;
+            }
+
+            i = (arr->trbox->rad != 0.0f ? 1 : 0) |
+                (arr->bvbox->rad != 0.0f ? 2 : 0);
+
+            if (arr->bnd_node != i)
+            {
+                arr->bnd_node = i;
+                lmode |= RT_LISTS_NEW;
+            }
+        }
+
+        /* update surfaces' node lists in parallel */
+#if RT_OPTS_THREAD != 0
+        if ((opts & RT_OPTS_THREAD) != 0 && is_threaded() && !g_print)
+        {
+            this->f_update(tdata, thnum, 6);
+        }
+        else
+#endif /* RT_OPTS_THREAD */
+        {
+            update_scene(this, -thnum, 6);
+        }
+
+        /* changed surfaces' node lists may change the hierarchy too */
+        for (i = 0; i < thnum; i++)
+        {
+            lmode |= tharr[i]->l_chg & RT_LISTS_NEW;
+        }
+
+        /* lists rebuilt on top of kept ones are released
+         * with the next change unless nothing was kept */
+        if ((lmode & RT_LISTS_NEW) != 0 && !full)
+        {
+            lage = RT_LISTS_AGE;
+        }
+
+        /* rebuild global hierarchical list */
+        hlist = tharr[0]->ssort(RT_NULL);
+
+        /* rebuild grids over its long runs for shadow lists */
+        rt_GRID *grd = RT_NULL;
+        rt_si32 n = tharr[0]->sgrid(hlist, &grd);
+
+        /* threads' candidate bitmaps are sized for at most
+         * all surfaces and arrays' nodes (3 per array), grids
+         * over more elements can't be queried, their allocs
+         * are left to the per-frame pool */
+        hgrid = n <= srf_num + arr_num * 3 ? grd : RT_NULL;
+
+        /* rebuild global surface/node list */
+        slist = tharr[0]->ssort(RT_NULL);
+        tharr[0]->filter(RT_NULL, &slist);
+    }
+
+    if (lmode != 0)
+    {
+        /* rebuild global light/shadow list,
+         * "slist" is needed inside */
+        llist = tharr[0]->lsort(RT_NULL);
+    }
+
+    /* rebuild camera's surface/node list,
+     * "slist" is needed inside */
+    clist = tharr[0]->ssort(cam);
+
+    if (g_print)
+    {
+        RT_PRINT_GLB();
+        RT_PRINT_SRF_LST(slist);
+        RT_PRINT_LGT_LST(llist);
+        RT_PRINT_CAM(cam);
+        RT_PRINT_SRF_LST(clist);
+    }
+
+    /* 3rd phase of multi-threaded update */
+#if RT_OPTS_THREAD != 0
+    if ((opts & RT_OPTS_THREAD) != 0 && is_threaded() && !g_print
+#if RT_OPTS_UPDATE_EXT3 != 0
+    &&  (opts & RT_OPTS_UPDATE_EXT3) == 0
+#endif /* RT_OPTS_UPDATE_EXT3 */
+       )
+    {
+        this->f_update(tdata, thnum, 3);
+    }
+    else
+#endif /* RT_OPTS_THREAD */
+    {
+        update_scene(this, -thnum, 3);
+    }
+
+    cost_done(1);
+
+    /* costs measured in this frame are used in the next one */
+    ccur ^= 1;
+
+    /* select dirty surfaces before tiling */
+#if RT_OPTS_RENDER_EXT2 != 0
+    if ((opts & RT_OPTS_RENDER_EXT2) != 0)
+    {
+        update_dirty();
+    }
+#endif /* RT_OPTS_RENDER_EXT2 */
+
+    /* keep changed surfaces' bounds for the next frame */
+    for (i = 0; i < unum; i++)
+    {
+        RT_VEC3_SET(ulist[i]->dmid, ulist[i]->bvbox->mid);
+        ulist[i]->drad = ulist[i]->bvbox->rad;
+    }
+
+    /* screen tiling */
+    rt_si32 tline;
+
+#if RT_OPTS_TILING != 0
+    if ((opts & RT_OPTS_TILING) != 0)
+    {
+        rt_ELEM *elm, *nxt = clist, *ctail = RT_NULL, **ptr = &ctail;
+
+        /* tile lists in runs are appended in "clist's" own order */
+#if RT_OPTS_TILING_RUNS != 0
+        if ((opts & RT_OPTS_TILING_RUNS) != 0)
+        {
+            ctail = clist;
+            nxt = RT_NULL;
+        }
+#endif /* RT_OPTS_TILING_RUNS */
+
+        /* build exact copy of reversed "clist" (should be cheap),
+         * trnode elements become tailing rather than heading,
+         * elements grouping for cached transform is retained */
+        for (; nxt != RT_NULL; nxt = nxt->next)
+        {
+            /* alloc new element as "nxt's" copy */
+            elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+            elm->data = nxt->data;
+            elm->simd = nxt->simd;
+            elm->temp = nxt->temp;
+            /* insert element as list's head */
+            elm->next = *ptr;
+           *ptr = elm;
+        }
+
+        rlist = ctail;
+
+        /* bin surfaces' tiles in parallel, each thread fills its own
+         * row-band while traversing reversed "clist" to keep original
+         * "clist's" order and optimize trnode handling for each tile */
+#if RT_OPTS_THREAD != 0
+        if ((opts & RT_OPTS_THREAD) != 0 && is_threaded()
+        &&  !g_print)
+        {
+            this->f_update(tdata, thnum, 7);
+        }
+        else
+#endif /* RT_OPTS_THREAD */
+        {
+            update_scene(this, -thnum, 7);
+        }
+
+        if (g_print)
+        {
+            rt_si32 i = 0, j = 0;
+
+            tline = i * tiles_in_row;
+
+            RT_PRINT_TLS_LST(tiles[tline + j], i, j);
+        }
+    }
+    else
+#endif /* RT_OPTS_TILING */
+    {
+        for (i = 0; i < tiles_in_col; i++)
+        {
+            tline = i * tiles_in_row;
+
+            for (j = 0; j < tiles_in_row; j++)
+            {
+                tiles[tline + j] = clist;
+            }
+        }
+    }
+
+    /* aim rays at pixel centers */
+    RT_VEC3_MUL_VAL1(hor, hor, factor);
+    RT_VEC3_MUL_VAL1(ver, ver, factor);
+
+    RT_VEC3_MAD_VAL1(dir, hor, 0.5f);
+    RT_VEC3_MAD_VAL1(dir, ver, 0.5f);
+
+    /* accumulate ambient from camera and all light sources */
+    RT_VEC3_MUL_VAL1(amb, cam->cam->col.hdr, cam->cam->lum[0]);
+    amb[RT_A] = cam->cam->lum[0];
+
+    rt_Light *lgt = RT_NULL;
+
+    for (lgt = lgt_head; lgt != RT_NULL; lgt = lgt->next)
+    {
+        RT_VEC3_MAD_VAL1(amb, lgt->lgt->col.hdr, lgt->lgt->lum[0]);
+        amb[RT_A] += lgt->lgt->lum[0];
+    }
+
+    t_update = get_usec() - t_start;
+}
+
+/*
+ * Update object hierarchy (phase 0.5) with given "time"
+ * as a set of subtree tasks for the multi-threaded update,
+ * top-level arrays are expanded sequentially (breadth-first)
+ * until there are enough tasks to keep all threads busy.
+ */
+rt_void rt_Scene::update_tree(rt_time time)
+{
+    rt_si32 i, j, k;
+
+    rt_Object  *obj;
+    rt_Array   *arr;
+    rt_Camera  *cam;
+    rt_Light   *lgt;
+    rt_Surface *srf;
+
+    /* call animators ahead of the tasks as they are not thread-safe
+     * for object instances sharing the same scene data */
+    for (cam = cam_head; cam != RT_NULL; cam = cam->next)
+    {
+        cam->update_anim(time);
+    }
+
+    for (lgt = lgt_head; lgt != RT_NULL; lgt = lgt->next)
+    {
+        lgt->update_anim(time);
+    }
+
+    for (arr = arr_head; arr != RT_NULL; arr = arr->next)
+    {
+        arr->update_anim(time);
+    }
+
+    for (srf = srf_head; srf != RT_NULL; srf = srf->next)
+    {
+        srf->update_anim(time);
+    }
+
+    /* update root array itself, its sub-objects become tasks */
+    root->update_array(time, 0, RT_NULL, iden4);
+
+    xnum = 0;
+    xlist[xnum++] = root;
+
+    for (i = 0, tnum = 0; i < root->obj_num; i++)
+    {
+        tlist[tnum++] = root->obj_arr[i];
+    }
+
+    /* expand sub-arrays until there are enough tasks,
+     * tasks to keep are compacted at the front of the list */
+    for (j = 0, k = 0; j < tnum; j++)
+    {
+        obj = tlist[j];
+
+        if (k + tnum - j >= thnum * RT_TASK_NUM
+        ||  !RT_IS_ARRAY(obj) || ((rt_Array *)obj)->obj_num == 0)
+        {
+            tlist[k++] = obj;
+            continue;
+        }
+
+        arr = (rt_Array *)obj;
+
+        /* update array itself, its sub-objects become tasks */
+        ((rt_Array *)arr->parent)->update_subobj(time, arr, RT_FALSE);
+
+        xlist[xnum++] = arr;
+
+        for (i = 0; i < arr->obj_num; i++)
+        {
+            tlist[tnum++] = arr->obj_arr[i];
+        }
+    }
+
+    tnum = k;
+    tnext = 0;
+    ttime = time;
+
+    /* run subtree tasks in parallel (phase 0.5) */
+#if RT_OPTS_THREAD != 0
+    if ((opts & RT_OPTS_THREAD) != 0 && is_threaded() && !g_print)
+    {
+        this->f_update(tdata, thnum, 4);
+    }
+    else
+#endif /* RT_OPTS_THREAD */
+    {
+        update_scene(this, -thnum, 4);
+    }
+
+    /* finish expanded arrays bottom-up */
+    for (i = xnum - 1; i >= 0; i--)
+    {
+        xlist[i]->update_depth();
+    }
+}
+
+/*
+ * Release memory for temporary per-frame allocs, threads keep theirs
+ * if the frame rebuilt (or relinked) cross-frame lists, until next
+ * full rebuild.
+ */
+rt_void rt_Scene::release_pool()
+{
+    rt_si32 i;
+
+    for (i = 0; i < thnum && lmode == 0; i++)
+    {
+        if (tharr[i]->mpool != tharr[i]->lpool)
+        {
+            tharr[i]->release(tharr[i]->mpool);
+        }
+    }
+
+    release(mpool);
+}
+
+/*
+ * Swap backend structs of all objects, tilebuffer and tile rows
+ * with their twins (allocated on first swap) for the update of the next
+ * frame in pipelined mode, copy the structs over and relink them.
+ * Twins hold the structs from the update before last, which is enough
+ * for objects not changed in the last update if it was also pipelined,
+ * materials are always copied as surfaces may write to them.
+ */
+rt_void rt_Scene::swap_simd()
+{
+    rt_Material *mtl;
+    rt_Light    *lgt;
+    rt_Array    *arr;
+    rt_Surface  *srf;
+
+    for (mtl = get_mat(); mtl != RT_NULL; mtl = mtl->next)
+    {
+        mtl->swap_simd(this);
+    }
+
+    /* flags still hold the last update's changes */
+    rt_bool full = pipe_lnk == 0;
+
+    for (lgt = lgt_head; lgt != RT_NULL; lgt = lgt->next)
+    {
+        lgt->swap_simd(full || lgt->obj_changed != 0);
+    }
+
+    for (arr = arr_head; arr != RT_NULL; arr = arr->next)
+    {
+        arr->swap_simd(full || arr->obj_changed != 0
+                            || arr->arr_changed != 0);
+    }
+
+    for (srf = srf_head; srf != RT_NULL; srf = srf->next)
+    {
+        srf->swap_simd(full || srf->obj_changed != 0
+                            || srf->srf_changed != 0);
+    }
+
+    /* links between the structs are set once all are swapped */
+    for (arr = arr_head; arr != RT_NULL; arr = arr->next)
+    {
+        arr->link_simd();
+    }
+
+    for (srf = srf_head; srf != RT_NULL; srf = srf->next)
+    {
+        srf->link_simd();
+    }
+
+    rt_ELEM **t_tmp = tiles;
+    tiles = t_tiles;
+    t_tiles = t_tmp;
+
+    rt_si32 *r_tmp = drows;
+    drows = t_rows;
+    t_rows = r_tmp;
+}
+
+/*
+ * Move per-frame allocs (and threads' cross-frame lists) of the frame
+ * being rendered to twin chains of the heaps in pipelined mode,
+ * so that the next frame's update allocates its own in the other ones.
+ */
+rt_void rt_Scene::swap_pool()
+{
+    rt_si32 i;
+
+    ppool = mpool;
+    swap();
+
+    for (i = 0; i < thnum; i++)
+    {
+        rt_SceneThread *th = tharr[i];
+
+        th->ppool = th->lpool != RT_NULL ? th->lpool : th->mpool;
+        th->lpool = RT_NULL;
+        th->swap();
+    }
+}
+
+/*
+ * Relink lists kept across frames to the structs swapped in by the update
+ * in pipelined mode, copying them to the current chains of the heaps
+ * as the old ones are released with the rendered frame's allocs.
+ */
+rt_void rt_Scene::relink_pool()
+{
+    s_old[0] = s_lnk;
+    s_old[1] = slist;
+    l_old[0] = l_lnk;
+    l_old[1] = llist;
+
+    /* relink global lists, "slist" is needed for "llist" */
+    slist = tharr[0]->flink(slist);
+    llist = tharr[0]->flink(llist);
+
+    s_lnk = slist;
+    l_lnk = llist;
+
+    /* global hierarchical list and its grids
+     * are rebuilt later if surfaces have changed */
+    if ((lmode & RT_LISTS_SRF) == 0)
+    {
+        hlist = tharr[0]->hlink(hlist, RT_NULL);
+
+        rt_GRID *grd = RT_NULL;
+        rt_si32 n = tharr[0]->sgrid(hlist, &grd);
+
+        hgrid = n <= srf_num + arr_num * 3 ? grd : RT_NULL;
+    }
+
+    /* relink surfaces' lists in parallel */
+#if RT_OPTS_THREAD != 0
+    if ((opts & RT_OPTS_THREAD) != 0 && is_threaded())
+    {
+        this->f_update(tdata, thnum, 8);
+    }
+    else
+#endif /* RT_OPTS_THREAD */
+    {
+        update_scene(this, -thnum, 8);
+    }
+}
+
+/*
+ * Release per-frame allocs of the rendered frame from twin chains
+ * of the heaps in pipelined mode, next frame's allocs are kept.
+ */
+rt_void rt_Scene::release_twin()
+{
+    rt_si32 i;
+
+    swap();
+    release(ppool);
+    swap();
+
+    for (i = 0; i < thnum; i++)
+    {
+        rt_SceneThread *th = tharr[i];
+
+        th->swap();
+        th->release(th->ppool);
+        th->swap();
+    }
+}
+
+/*
+ * Drop the frame updated ahead in pipelined mode, release its allocs,
+ * next frame is updated before rendering. Called from main thread
+ * with no frame in flight.
+ */
+rt_void rt_Scene::drop_pipe()
+{
+    if (pipe_set == 0)
+    {
+        return;
+    }
+
+    pipe_set = 0;
+
+    release_pool();
+}
+
+/*
+ * Update arrays' bounds (phase 2.5) as a set of subtree tasks
+ * for the multi-threaded update, only subtrees not contributing
+ * bounds to arrays outside of them are selected, which keeps
+ * the order of all contributions the same as in sequential update.
+ */
+rt_void rt_Scene::update_bbox()
+{
+    rt_si32 i, j, k;
+
+    rt_Object  *obj;
+    rt_Array   *arr;
+
+    tnum = 0;
+
+    /* unchanged arrays are skipped along with their sub-arrays */
+    if (root->arr_changed != 0)
+    {
+        for (i = 0; i < root->obj_num; i++)
+        {
+            obj = root->obj_arr[i];
+
+            if (RT_IS_ARRAY(obj) && ((rt_Array *)obj)->arr_changed != 0)
+            {
+                tlist[tnum++] = obj;
+            }
+        }
+    }
+
+    /* expand sub-arrays until there are enough tasks,
+     * tasks to keep are compacted at the front of the list,
+     * arrays not fitting into a subtree task are always expanded
+     * and then updated sequentially along with the root */
+    for (j = 0, k = 0; j < tnum; j++)
+    {
+        arr = (rt_Array *)tlist[j];
+
+        for (i = 0; i < arr->obj_num; i++)
+        {
+            if (RT_IS_ARRAY(arr->obj_arr[i]))
+            {
+                break;
+            }
+        }
+
+        if (arr->bnd_depth >= arr->arr_depth
+        && (k + tnum - j >= thnum * RT_TASK_NUM || i == arr->obj_num))
+        {
+            tlist[k++] = arr;
+            continue;
+        }
+
+        for (i = 0; i < arr->obj_num; i++)
+        {
+            obj = arr->obj_arr[i];
+
+            if (RT_IS_ARRAY(obj) && ((rt_Array *)obj)->arr_changed != 0)
+            {
+                tlist[tnum++] = obj;
+            }
+        }
+    }
+
+    tnum = k;
+    tnext = 0;
+
+    /* run subtree tasks in parallel (phase 2.5) */
+    if (tnum > 0)
+    {
+#if RT_OPTS_THREAD != 0
+        if ((opts & RT_OPTS_THREAD) != 0 && is_threaded()
+        &&  !g_print)
+        {
+            this->f_update(tdata, thnum, 5);
+        }
+        else
+#endif /* RT_OPTS_THREAD */
+        {
+            update_scene(this, -thnum, 5);
+        }
+    }
+
+    /* finish the rest sequentially,
+     * sub-arrays updated by the tasks are skipped,
+     * their marks are cleared there as they are consumed */
+    root->update_bounds();
+
+#if RT_DEBUG >= 1
+
+    /* tasks are picked only below changed arrays, so every task's mark
+     * is consumed by its parent in the sequential pass, check it here */
+    for (i = 0; i < tnum; i++)
+    {
+        if (((rt_Array *)tlist[i])->bnd_task != 0)
+        {
+            throw rt_Exception("subtree task's bounds skipped in phase 2.5");
+        }
+    }
+
+#endif /* RT_DEBUG */
+}
+
+/*
+ * Check if any of custom clippers of surface "srf"
+ * (or their trnodes) changed in this frame.
+ */
+static
+rt_bool clip_changed(rt_Surface *srf)
+{
+    rt_ELEM *elm;
+
+    for (elm = (rt_ELEM *)srf->s_srf->msc_p[2];
+         elm != RT_NULL; elm = elm->next)
+    {
+        rt_Object *obj = elm->temp == RT_NULL ? RT_NULL :
+                         (rt_Object *)((rt_BOUND *)elm->temp)->obj;
+
+        if (obj != RT_NULL && obj->obj_changed != 0)
+        {
+            return RT_TRUE;
+        }
+    }
+
+    return RT_FALSE;
+}
+
+/*
+ * Check if changed surface "chg" may shadow node's bounding sphere "box"
+ * from any light in the list "lgt", changed surface's bounding sphere
+ * of the last frame is extended to the current one in "render_frame".
+ */
+static
+rt_bool shad_cone(rt_Surface *chg, rt_BOUND *box, rt_Light *lgt)
+{
+    for (; lgt != RT_NULL; lgt = lgt->next)
+    {
+        rt_vec4 vec, dff_vec;
+        rt_real len, dst, dot, sin, cos;
+
+        /* shadow cone from light's "pos"
+         * around changed surface's sphere */
+        RT_VEC3_SUB(vec, chg->dmid, lgt->bvbox->mid);
+        len = RT_VEC3_LEN(vec);
+
+        if (len <= chg->drad)
+        {
+            return RT_TRUE;
+        }
+
+        RT_VEC3_SUB(dff_vec, box->mid, lgt->bvbox->mid);
+        dst = RT_VEC3_LEN(dff_vec);
+
+        /* receiver is closer to the light than caster */
+        if (dst + box->rad < len - chg->drad)
+        {
+            continue;
+        }
+
+        sin = chg->drad / len;
+        cos = RT_SQRT(1.0f - sin * sin);
+        dot = RT_VEC3_DOT(dff_vec, vec) / len;
+
+        /* distance to cone's side is never overestimated */
+        if (RT_SQRT(RT_MAX(dst * dst - dot * dot, 0.0f)) * cos
+                                           - dot * sin <= box->rad)
+        {
+            return RT_TRUE;
+        }
+    }
+
+    return RT_FALSE;
+}
+
+/*
+ * Select cross-frame lists of surface "srf" to rebuild in phase 3.
+ * Unless all lists are rebuilt, changed surfaces rebuild their own lists,
+ * reflective/transparent surfaces rebuild rfl/rfr lists if any surface
+ * changed, others rebuild light/shadow lists only if some changed surface
+ * may shadow them in this or the last frame, like in "update_dirty".
+ */
+rt_si32 rt_Scene::update_lists(rt_Surface *srf)
+{
+    rt_si32 i, lsel = lmode & RT_LISTS_LGT;
+
+    if ((lmode & RT_LISTS_NEW) != 0 || srf->srf_changed != 0)
+    {
+        return RT_LISTS_ALL;
+    }
+
+    if (unum == 0)
+    {
+        return lsel;
+    }
+
+    rt_BOUND *box = srf->bvbox;
+
+    /* reflections and refractions may show changed surfaces */
+    if (((rt_word)srf->s_srf->mat_p[1] & RT_PROP_REFLECT) != 0
+    ||  ((rt_word)srf->s_srf->mat_p[3] & RT_PROP_REFLECT) != 0
+    ||  ((rt_word)srf->s_srf->mat_p[1] & RT_PROP_OPAQUE) == 0
+    ||  ((rt_word)srf->s_srf->mat_p[3] & RT_PROP_OPAQUE) == 0)
+    {
+        lsel |= RT_LISTS_SRF;
+    }
+
+    /* unbounded surfaces may receive shadows anywhere,
+     * unbounded changed surfaces may cast them anywhere */
+    for (i = 0; i < unum && (lsel & RT_LISTS_LGT) == 0; i++)
+    {
+        if (box->verts_num == 0 || ulist[i]->bvbox->verts_num == 0
+        ||  shad_cone(ulist[i], box, lgt_head))
+        {
+            lsel |= RT_LISTS_LGT;
+        }
+    }
+
+    return lsel;
+}
+
+/*
+ * Select surfaces whose pixels may differ from the last rendered frame
+ * for dirty tiles' render (RT_OPTS_RENDER_EXT2), their tile rows are then
+ * marked in phase 7. Changed surfaces (or their clippers) dirty all
+ * reflective/transparent surfaces as well as surfaces they may shadow
+ * from any light in this or the last frame, which is checked with
+ * bounding spheres. Camera, light or backend changes dirty all rows.
+ */
+rt_void rt_Scene::update_dirty()
+{
+    rt_si32 i, any = 0;
+
+    rt_Surface *srf, *chg;
+
+    rt_si32 full = dfull || pt_on || g_print;
+
+    /* tile rows can only be skipped when rendered from tiles' lists */
+#if RT_OPTS_TILING != 0 && RT_OPTS_BALANCE != 0
+    full |= (opts & RT_OPTS_TILING) == 0 || (opts & RT_OPTS_BALANCE) == 0;
+#else /* RT_OPTS_TILING, RT_OPTS_BALANCE */
+    full = 1;
+#endif /* RT_OPTS_TILING, RT_OPTS_BALANCE */
+
+    for (i = 0; i < thnum; i++)
+    {
+        full |= (tharr[i]->l_chg & RT_LISTS_LGT) != 0;
+    }
+
+    full |= dmode[0] != pfm->fsaa || dmode[1] != pfm->s_mode;
+
+    dmode[0] = pfm->fsaa;
+    dmode[1] = pfm->s_mode;
+
+    rt_real *vec[4] = {pos, dir, htl, vtl};
+
+    for (i = 0; i < 4; i++)
+    {
+        full |= dcam[i][RT_X] != vec[i][RT_X]
+             || dcam[i][RT_Y] != vec[i][RT_Y]
+             || dcam[i][RT_Z] != vec[i][RT_Z];
+
+        RT_VEC3_SET(dcam[i], vec[i]);
+    }
+
+    /* mark changed surfaces, custom clippers change their look too,
+     * bounding spheres of the last frame were extended in "render_frame" */
+    for (srf = srf_head; srf != RT_NULL; srf = srf->next)
+    {
+        srf->srf_dirty = srf->obj_changed != 0 || clip_changed(srf);
+
+        if (srf->srf_dirty == 0)
+        {
+            continue;
+        }
+
+        /* unbounded surfaces may be seen anywhere */
+        if (srf->bvbox->verts_num == 0)
+        {
+            full = 1;
+            continue;
+        }
+
+        any = 1;
+    }
+
+    /* mark surfaces affected by changed ones */
+    for (srf = srf_head; srf != RT_NULL && any && !full; srf = srf->next)
+    {
+        if (srf->srf_dirty != 0)
+        {
+            continue;
+        }
+
+        rt_BOUND *box = srf->bvbox;
+
+        /* reflections and refractions may show changed surfaces,
+         * unbounded surfaces may receive their shadows anywhere */
+        if (((rt_word)srf->s_srf->mat_p[1] & RT_PROP_REFLECT) != 0
+        ||  ((rt_word)srf->s_srf->mat_p[3] & RT_PROP_REFLECT) != 0
+        ||  ((rt_word)srf->s_srf->mat_p[1] & RT_PROP_OPAQUE) == 0
+        ||  ((rt_word)srf->s_srf->mat_p[3] & RT_PROP_OPAQUE) == 0
+        ||  box->verts_num == 0)
+        {
+            srf->srf_dirty = 2;
+            continue;
+        }
+
+        for (chg = srf_head; chg != RT_NULL; chg = chg->next)
+        {
+            if (chg->srf_dirty == 1 && shad_cone(chg, box, lgt_head))
+            {
+                srf->srf_dirty = 2;
+                break;
+            }
+        }
+    }
+
+    dfull = 0;
+    dall = full;
+
+    /* rows are marked in phase 7 unless all are re-rendered,
+     * which also applies when there is no tiling */
+    for (i = 0; dall && i < tiles_in_col; i++)
+    {
+        drows[i] = 1;
+    }
+}
+
+/*
+ * Compute bounding sphere ("mid" and returned radius) of array's
+ * bounded contents (recursive), count its bounded surfaces in "num",
+ * return 0.0f if array has no bounded contents.
+ */
+rt_real rt_Scene::bound_size(rt_Array *arr, rt_vec4 mid, rt_si32 *num)
+{
+    rt_si32 i, n;
+    rt_real rad = 0.0f, r, d;
+    rt_vec4 m, dff_vec;
+
+    for (i = 0; i < arr->obj_num; i++)
+    {
+        rt_Object *obj = arr->obj_arr[i];
+
+        if (RT_IS_ARRAY(obj))
+        {
+            n = 0;
+            r = bound_size((rt_Array *)obj, m, &n);
+
+            if (n == 0)
+            {
+                continue;
+            }
+
+           *num += n;
+        }
+        else
+        if (RT_IS_SURFACE(obj))
+        {
+            rt_BOUND *box = obj->bvbox;
+
+            /* boundless surfaces are never bounded by arrays */
+            if (box->verts_num == 0 || box->rad == 0.0f
+            ||  box->rad == RT_INF)
+            {
+                continue;
+            }
+
+            RT_VEC3_SET(m, box->mid);
+            r = box->rad;
+
+           *num += 1;
+        }
+        else
+        {
+            continue;
+        }
+
+        /* merge sub-object's sphere into array's sphere */
+        if (rad == 0.0f)
+        {
+            RT_VEC3_SET(mid, m);
+            rad = r;
+            continue;
+        }
+
+        RT_VEC3_SUB(dff_vec, m, mid);
+        d = RT_VEC3_LEN(dff_vec);
+
+        if (d + r <= rad)
+        {
+            continue;
+        }
+        if (d + rad <= r)
+        {
+            RT_VEC3_SET(mid, m);
+            rad = r;
+            continue;
+        }
+
+        r = (d + rad + r) * 0.5f;
+        RT_VEC3_MAD_VAL1(mid, dff_vec, (r - rad) / d);
+        rad = r;
+    }
+
+    return rad;
+}
+
+/*
+ * Select bounding volumes for sub-arrays of "arr" (recursive) not bounded
+ * in scene data using surface area heuristic: array is bounded if the cost
+ * of its sphere test plus the cost of its surfaces, scaled by probability
+ * of a ray hitting the array's sphere when it hits sphere of radius "prd"
+ * of the nearest bounded parent, is less than the cost of its surfaces,
+ * previous selection is revisited with current bounds (and dropped
+ * if RT_OPTS_VARRAY is off), return number of arrays changing selection.
+ */
+rt_si32 rt_Scene::bound_auto(rt_Array *arr, rt_real prd)
+{
+    rt_si32 i, j, n, sel, chg = 0;
+    rt_real rad, prb;
+    rt_vec4 mid;
+
+    for (i = 0; i < arr->obj_num; i++)
+    {
+        if (!RT_IS_ARRAY(arr->obj_arr[i]))
+        {
+            continue;
+        }
+
+        rt_Array *sub = (rt_Array *)arr->obj_arr[i];
+
+        n = 0;
+        rad = bound_size(sub, mid, &n);
+
+        /* check if array is bounded in scene data */
+        for (j = 0; j < sub->obj_num; j++)
+        {
+            if (sub->obj_arr[j]->bvnode == sub && sub->bnd_auto == 0)
+            {
+                break;
+            }
+        }
+
+        if (j < sub->obj_num)
+        {
+            chg += bound_auto(sub, rad);
+            continue;
+        }
+
+        prb = prd > 0.0f ? (rad * rad) / (prd * prd) : 1.0f;
+        sel = n >= 2 && RT_BOUND_COST + prb * n < n;
+
+#if RT_OPTS_VARRAY != 0
+        sel = sel && (opts & RT_OPTS_VARRAY) != 0;
+#else  /* RT_OPTS_VARRAY */
+        sel = 0;
+#endif /* RT_OPTS_VARRAY */
+
+        if (sel != 0 && sub->bnd_auto == 0)
+        {
+            sub->update_bvnode(sub, RT_TRUE);
+            sub->bnd_auto = 1;
+            bvauto++;
+            chg++;
+        }
+        else
+        if (sel == 0 && sub->bnd_auto != 0)
+        {
+            /* return sub-objects to the nearest bounded parent */
+            sub->update_bvnode(sub, RT_FALSE);
+            if (sub->bvnode != RT_NULL)
+            {
+                sub->update_bvnode(sub->bvnode, RT_TRUE);
+            }
+            sub->bnd_auto = 0;
+            bvauto--;
+            chg++;
+        }
+
+        chg += bound_auto(sub, sel != 0 ? rad : prd);
+    }
+
+    /* new bvnodes change arrays receiving bounds
+     * from sub-objects, update depths for subtree tasks */
+    arr->update_depth();
+
+    return chg;
+}
+
+/*
+ * Check if surface "srf" at position "i" in the list is to be skipped
+ * by thread with given "index" in update phase 2 or 3 ("p" is 0 or 1),
+ * surfaces are split into contiguous ranges of roughly equal cost
+ * measured in the previous frame, "c" accumulates preceding costs.
+ */
+rt_bool rt_Scene::cost_skip(rt_Surface *srf, rt_si32 i, rt_si32 index,
+                            rt_si32 p, rt_time *c)
+{
+#if RT_OPTS_BALANCE != 0
+    if ((opts & RT_OPTS_BALANCE) != 0)
+    {
+        /* zero-cost surfaces still count as one */
+        rt_time w = srf->srf_cost[ccur][p] + 1;
+        rt_time m = (2 * *c + w) * thnum / (2 * csum[ccur][p]);
+
+       *c += w;
+
+        return RT_MIN(m, thnum - 1) != index;
+    }
+#endif /* RT_OPTS_BALANCE */
+
+    return (i % thnum) != index;
+}
+
+/*
+ * Collect threads' costs and time for update phase 2 or 3 ("p" is 0 or 1)
+ * after the phase is finished, compute phase's imbalance.
+ */
+rt_void rt_Scene::cost_done(rt_si32 p)
+{
+    rt_si32 i;
+    rt_time t_max = 0, t_sum = 0, c_sum = 0;
+
+    for (i = 0; i < thnum; i++)
     {
-        pending = 1;
+        t_max = RT_MAX(t_max, tharr[i]->t_phase[p]);
+        t_sum += tharr[i]->t_phase[p];
+        c_sum += tharr[i]->c_phase[p];
     }
-#endif /* RT_OPTS_UPDATE_EXT0 */
+
+    csum[ccur ^ 1][p] = c_sum;
+    imbal[p] = t_sum > 0 ? (rt_real)(t_max * thnum) / t_sum : 1.0f;
 }
 
 /*
@@ -3344,8 +6501,14 @@ rt_void rt_Scene::update_slice(rt_si32 index, rt_si32 phase)
     rt_Light   *lgt;
     rt_Surface *srf;
 
+    /* phase's and surface's time, preceding costs */
+    rt_time t_phase, t_srf, c = 0;
+
     if (phase == 1)
     {
+        tharr[index]->l_chg = 0;
+        tharr[index]->l_num = 0;
+
         for (arr = arr_head, i = 0; arr != RT_NULL; arr = arr->next, i++)
         {
             if ((i % thnum) != index)
@@ -3382,6 +6545,11 @@ rt_void rt_Scene::update_slice(rt_si32 index, rt_si32 phase)
              * from parent array's transform matrix
              * updated in sequential phase 0.5 */
             lgt->update_fields();
+
+            if (lgt->obj_changed != 0)
+            {
+                tharr[index]->l_chg |= RT_LISTS_LGT;
+            }
         }
 
         for (srf = srf_head, i = 0; srf != RT_NULL; srf = srf->next, i++)
@@ -3395,21 +6563,37 @@ rt_void rt_Scene::update_slice(rt_si32 index, rt_si32 phase)
              * from parent array's transform matrix
              * updated in sequential phase 0.5 */
             srf->update_fields();
+
+            if (srf->obj_changed != 0)
+            {
+                tharr[index]->l_chg |= RT_LISTS_SRF;
+                tharr[index]->l_num++;
+            }
         }
     }
     else
     if (phase == 2)
     {
+        t_phase = get_usec();
+        tharr[index]->c_phase[0] = 0;
+
         for (srf = srf_head, i = 0; srf != RT_NULL; srf = srf->next, i++)
         {
-            if ((i % thnum) != index)
+            if (cost_skip(srf, i, index, 0, &c))
             {
                 continue;
             }
 
+            t_srf = get_usec();
+
             /* rebuild surface's clip list (cross-surface)
-             * based on transform flags updated in 1st phase above */
-            tharr[index]->sclip(srf);
+             * based on transform flags updated in 1st phase above,
+             * only if its clippers changed unless all lists are rebuilt */
+            if ((lmode & RT_LISTS_NEW) != 0
+            || ((lmode & RT_LISTS_SRF) != 0 && clip_changed(srf)))
+            {
+                tharr[index]->sclip(srf);
+            }
 
             /* update surface's bounds taking into account surfaces
              * from custom clippers list updated above */
@@ -3418,37 +6602,192 @@ rt_void rt_Scene::update_slice(rt_si32 index, rt_si32 phase)
             /* rebuild surface's tile list (per-surface)
              * based on surface bounds updated above */
             tharr[index]->stile(srf);
+
+            /* measure surface's cost for the next frame */
+            t_srf = get_usec() - t_srf;
+            srf->srf_cost[ccur ^ 1][0] = t_srf;
+            tharr[index]->c_phase[0] += t_srf + 1;
         }
+
+        tharr[index]->t_phase[0] = get_usec() - t_phase;
     }
     else
     if (phase == 3)
     {
+        t_phase = get_usec();
+        tharr[index]->c_phase[1] = 0;
+
         for (srf = srf_head, i = 0; srf != RT_NULL; srf = srf->next, i++)
         {
-            if ((i % thnum) != index)
+            if (cost_skip(srf, i, index, 1, &c))
             {
                 continue;
             }
 
+            t_srf = get_usec();
+
             if (g_print)
             {
                 RT_PRINT_SRF(srf);
             }
 
+            /* select surface's lists to rebuild from surfaces
+             * changed in this frame unless all lists are rebuilt */
+            rt_si32 lsel = lmode != 0 ? update_lists(srf) : 0;
+
             /* rebuild surface's rfl/rfr surface lists (cross-surface)
              * based on surface bounds updated in 2nd phase above
              * and array bounds updated in sequential phase 2.5 */
-            tharr[index]->ssort(srf);
+            if ((lsel & RT_LISTS_SRF) != 0)
+            {
+                tharr[index]->ssort(srf);
+            }
 
             /* rebuild surface's light/shadow lists (cross-surface)
              * based on surface bounds updated in 2nd phase above
              * and array bounds updated in sequential phase 2.5 */
-            tharr[index]->lsort(srf);
+            if ((lsel & RT_LISTS_LGT) != 0)
+            {
+                tharr[index]->lsort(srf);
+            }
 
             /* update surface's backend-related parts */
             pfm->update0(srf->s_srf);
+
+            /* measure surface's cost for the next frame */
+            t_srf = get_usec() - t_srf;
+            srf->srf_cost[ccur ^ 1][1] = t_srf;
+            tharr[index]->c_phase[1] += t_srf + 1;
+        }
+
+        tharr[index]->t_phase[1] = get_usec() - t_phase;
+    }
+    else
+    if (phase == 4)
+    {
+        /* subtree tasks of phase 0.5 picked dynamically,
+         * sub-objects of arrays expanded in update_tree */
+        while ((i = atomic_add(&tnext, 1)) < tnum)
+        {
+            rt_Object *obj = tlist[i];
+
+            ((rt_Array *)obj->parent)->update_subobj(ttime, obj, RT_TRUE);
+        }
+    }
+    else
+    if (phase == 5)
+    {
+        /* subtree tasks of phase 2.5 picked dynamically,
+         * self-contained sub-arrays selected in update_bbox */
+        while ((i = atomic_add(&tnext, 1)) < tnum)
+        {
+            ((rt_Array *)tlist[i])->update_bounds();
+
+            /* mark subtree as done for the sequential pass */
+            ((rt_Array *)tlist[i])->bnd_task = 1;
+        }
+    }
+    else
+    if (phase == 6)
+    {
+        for (srf = srf_head, i = 0; srf != RT_NULL; srf = srf->next, i++)
+        {
+            if ((i % thnum) != index)
+            {
+                continue;
+            }
+
+            /* rebuild surface's node list (per-surface)
+             * based on transform flags and arrays' bounds
+             * updated in phase 2.5, only if surface changed
+             * unless all lists are rebuilt */
+            if ((lmode & RT_LISTS_NEW) != 0 || srf->obj_changed != 0)
+            {
+                tharr[index]->snode(srf);
+            }
+        }
+    }
+    else
+    if (phase == 7)
+    {
+        /* bin surfaces' tile lists (per-surface)
+         * into thread's own row-band of the tilebuffer */
+        tharr[index]->sbins(rlist);
+
+#if RT_OPTS_RENDER_EXT2 != 0
+        if ((opts & RT_OPTS_RENDER_EXT2) != 0)
+        {
+            /* mark thread's own row-band
+             * of tile rows to re-render */
+            tharr[index]->sdirt();
+        }
+#endif /* RT_OPTS_RENDER_EXT2 */
+    }
+    else
+    if (phase == 8)
+    {
+        for (srf = srf_head, i = 0; srf != RT_NULL; srf = srf->next, i++)
+        {
+            if ((i % thnum) != index)
+            {
+                continue;
+            }
+
+            /* relink surface's kept lists (per-surface)
+             * to the structs swapped in pipelined mode */
+            tharr[index]->slink(srf);
+        }
+    }
+}
+
+/*
+ * Update portions of the scene with render thread's "index" modulo
+ * the number of threads running the pipelined update, the leading thread
+ * posts each "phase" to others at the barrier and returns once it's done,
+ * others (0) run the posted phases until the update is done.
+ */
+rt_void rt_Scene::update_pipe(rt_si32 index, rt_si32 phase)
+{
+    rt_si32 i;
+
+    do
+    {
+        if (phase != 0)
+        {
+            pipe_cmd = phase;
+        }
+
+        pipe_bar->wait();
+
+        if (pipe_cmd == 0)
+        {
+            break;
+        }
+
+        /* error is passed on once all threads finish the phase */
+        try
+        {
+            for (i = index % pipe_num; i < thnum; i += pipe_num)
+            {
+                update_slice(i, pipe_cmd);
+            }
+        }
+        catch (rt_Exception &e)
+        {
+            pipe_err = e.err;
+        }
+
+        pipe_bar->wait();
+
+        if (phase != 0 && pipe_err != RT_NULL)
+        {
+            rt_pstr err = pipe_err;
+            pipe_err = RT_NULL;
+
+            throw rt_Exception(err);
         }
     }
+    while (phase == 0);
 }
 
 /*
@@ -3460,7 +6799,56 @@ rt_void rt_Scene::render_slice(rt_si32 index, rt_si32 phase)
     /* adjust ray steppers according to antialiasing mode */
     rt_real fha[RT_SIMD_WIDTH], fhi[RT_SIMD_WIDTH], fhu; /* h - hor */
     rt_real fva[RT_SIMD_WIDTH], fvi[RT_SIMD_WIDTH], fvu; /* v - ver */
-    rt_si32 i;
+    rt_real fvb[RT_SIMD_WIDTH]; /* lane's row within packed block */
+    rt_si32 i, bw, bh;
+
+    /* in pipelined mode (phase 2) the last threads run the update
+     * of the next frame before joining the render, it swaps in twins
+     * of the structs, tilebuffer and pools the render reads from,
+     * the last thread leads and posts the phases to others */
+    if (phase == 2 && index == thnum - 1)
+    {
+        rt_FUNC_UPDATE f_upd = f_update;
+        rt_pntr t_upd = tdata;
+
+        f_update = update_pipes;
+        tdata = this;
+
+        rt_pstr err = RT_NULL;
+
+        pipe_upd = 1;
+
+        try
+        {
+            update_frame(pipe_time);
+        }
+        catch (rt_Exception &e)
+        {
+            err = e.err;
+        }
+
+        pipe_upd = 0;
+
+        f_update = f_upd;
+        tdata = t_upd;
+
+        /* release other threads before passing the error on */
+        if (pipe_num > 1)
+        {
+            pipe_cmd = 0;
+            pipe_bar->wait();
+        }
+
+        if (err != RT_NULL)
+        {
+            throw rt_Exception(err);
+        }
+    }
+    else
+    if (phase == 2 && index >= thnum - pipe_num)
+    {
+        update_pipe(index, 0);
+    }
 
     if (pfm->fsaa == RT_FSAA_NO)
     {
@@ -3554,23 +6942,53 @@ rt_void rt_Scene::render_slice(rt_si32 index, rt_si32 phase)
         ;
     }
 
+    /* pixels per SIMD vector are packed into a block of bw x bh
+     * (4x4 for 16 pixels), its rows can't cross tile rows, as
+     * tile list is picked by block's top row, path-tracer keeps
+     * scanline layout of its accumulation buffers and seeds */
+    bw = pfm->simd_width >> pfm->fsaa;
+    bh = 1;
+
+    if (pfm->pack != 0 && pt_on == RT_FALSE)
+    {
+        while (bh * bh * 4 <= bw && tile_h % (bh * 2) == 0)
+        {
+            bh *= 2;
+        }
+
+        bw /= bh;
+    }
+
+    for (i = 0; i < pfm->simd_width; i++)
+    {
+        fvb[i] = (rt_real)((rt_si32)fhi[i] / bw);
+        fhi[i] = (rt_real)((rt_si32)fhi[i] % bw);
+        fvi[i] = fvi[i] * (rt_real)bh + fvb[i];
+    }
+
+    if (bh > 1)
+    {
+        fhu = (rt_real)bw;
+        fvu = fvu * (rt_real)bh;
+    }
+
 /*  rt_SIMD_CAMERA */
 
     rt_SIMD_CAMERA *s_cam = tharr[index]->s_cam;
 
     RT_SIMD_SET(s_cam->t_max, RT_INF);
 
-    RT_SIMD_SET(s_cam->dir_x, dir[RT_X]);
-    RT_SIMD_SET(s_cam->dir_y, dir[RT_Y]);
-    RT_SIMD_SET(s_cam->dir_z, dir[RT_Z]);
+    RT_SIMD_SET(s_cam->dir_x, rdir[RT_X]);
+    RT_SIMD_SET(s_cam->dir_y, rdir[RT_Y]);
+    RT_SIMD_SET(s_cam->dir_z, rdir[RT_Z]);
 
-    RT_SIMD_SET(s_cam->hor_x, hor[RT_X]);
-    RT_SIMD_SET(s_cam->hor_y, hor[RT_Y]);
-    RT_SIMD_SET(s_cam->hor_z, hor[RT_Z]);
+    RT_SIMD_SET(s_cam->hor_x, rhor[RT_X]);
+    RT_SIMD_SET(s_cam->hor_y, rhor[RT_Y]);
+    RT_SIMD_SET(s_cam->hor_z, rhor[RT_Z]);
 
-    RT_SIMD_SET(s_cam->ver_x, ver[RT_X]);
-    RT_SIMD_SET(s_cam->ver_y, ver[RT_Y]);
-    RT_SIMD_SET(s_cam->ver_z, ver[RT_Z]);
+    RT_SIMD_SET(s_cam->ver_x, rver[RT_X]);
+    RT_SIMD_SET(s_cam->ver_y, rver[RT_Y]);
+    RT_SIMD_SET(s_cam->ver_z, rver[RT_Z]);
 
     RT_SIMD_SET(s_cam->hor_u, fhu);
     RT_SIMD_SET(s_cam->ver_u, fvu);
@@ -3578,35 +6996,52 @@ rt_void rt_Scene::render_slice(rt_si32 index, rt_si32 phase)
     RT_SIMD_SET(s_cam->clamp, (rt_real)255);
     RT_SIMD_SET(s_cam->cmask, (rt_elem)255);
 
-    RT_SIMD_SET(s_cam->col_r, amb[RT_R]);
-    RT_SIMD_SET(s_cam->col_g, amb[RT_G]);
-    RT_SIMD_SET(s_cam->col_b, amb[RT_B]);
-    RT_SIMD_SET(s_cam->l_amb, amb[RT_A]);
+    RT_SIMD_SET(s_cam->col_r, ramb[RT_R]);
+    RT_SIMD_SET(s_cam->col_g, ramb[RT_G]);
+    RT_SIMD_SET(s_cam->col_b, ramb[RT_B]);
+    RT_SIMD_SET(s_cam->l_amb, ramb[RT_A]);
+
+    /* pixel's spread angle (squared), doubled for
+     * backend to round to the nearest mip-level */
+    RT_SIMD_SET(s_cam->pix_a, 2.0f * RT_VEC3_DOT(rhor, rhor)
+                                   / (rpov * rpov));
 
 /*  rt_SIMD_CONTEXT */
 
     rt_SIMD_CONTEXT *s_ctx = tharr[index]->s_ctx;
 
     s_ctx->param[1] = -((opts & RT_OPTS_GAMMA) == 0) & RT_PROP_GAMMA;
-    RT_SIMD_SET(s_ctx->t_min, cam->pov);
+    RT_SIMD_SET(s_ctx->t_min, rpov);
     RT_SIMD_SET(s_ctx->wmask, -1);
 
-    RT_SIMD_SET(s_ctx->org_x, pos[RT_X]);
-    RT_SIMD_SET(s_ctx->org_y, pos[RT_Y]);
-    RT_SIMD_SET(s_ctx->org_z, pos[RT_Z]);
+    RT_SIMD_SET(s_ctx->org_x, rpos[RT_X]);
+    RT_SIMD_SET(s_ctx->org_y, rpos[RT_Y]);
+    RT_SIMD_SET(s_ctx->org_z, rpos[RT_Z]);
 
 /*  rt_SIMD_INFOX */
 
     rt_SIMD_INFOX *s_inf = tharr[index]->s_inf;
 
+    rt_time t_start = get_usec();
+
     s_inf->ctx = s_ctx;
     s_inf->cam = s_cam;
-    s_inf->lst = clist;
+    s_inf->lst = rclst;
+    s_inf->tiles = rtile;
+
+    s_inf->frame = fbuf[fnext];
 
-    s_inf->index = index;
-    s_inf->thnum = thnum;
+    s_inf->index = index * bh;
+    s_inf->thnum = thnum * bh;
     s_inf->depth = depth;
     s_inf->fsaa  = pfm->fsaa;
+    s_inf->filt  = pfm->filt;
+    s_inf->occ   = occ_on ? tharr[index]->s_occ : RT_NULL;
+
+    s_inf->blk_w = bw;
+    s_inf->blk_h = bh;
+    s_inf->blk_m = bw * 4 - 1;
+    s_inf->blk_r = (x_row - bw) * 4;
 
     s_inf->pt_on = pt_on;
 
@@ -3623,8 +7058,71 @@ rt_void rt_Scene::render_slice(rt_si32 index, rt_si32 phase)
         s_cam->ver_a[i] = fva[i];
     }
 
-    /* render frame based on tilebuffer */
-    pfm->render0(s_inf);
+#if RT_OPTS_BALANCE != 0
+    if ((opts & RT_OPTS_BALANCE) != 0)
+    {
+        rt_si32 g, n, k, k1, y;
+
+        /* step single rows (blocks) within a band */
+        RT_SIMD_SET(s_cam->ver_u, (rt_real)bh);
+        s_inf->thnum = bh;
+
+        /* pull row-bands (tile rows) from the shared counters until the
+         * frame is exhausted, so that threads with cheaper rows take on
+         * more bands instead of waiting for others at the render barrier,
+         * bands of thread's own node group are taken first (their pages
+         * are placed on the node), then the remaining groups are helped */
+        for (n = 0; n < ndnum; n++)
+        {
+            g  = (thgrp[index] + n) % ndnum;
+            k1 = (g + 1) * tiles_in_col / ndnum;
+
+            while ((k = g * tiles_in_col / ndnum
+                      + atomic_add(&rband[g * RT_BAND_PAD], 1)) < k1)
+            {
+                y = k * tile_h;
+
+#if RT_OPTS_RENDER_EXT2 != 0
+                /* clean row-band is kept from the last frame,
+                 * copied if it was rendered to another buffer */
+                if ((opts & RT_OPTS_RENDER_EXT2) != 0 && rrows[k] == 0)
+                {
+                    for (i = y; fnext != fcur
+                             && i < RT_MIN(y + tile_h, y_res); i++)
+                    {
+                        memcpy(fbuf[fnext] + i * x_row,
+                               fbuf[fcur] + i * x_row,
+                               x_res * sizeof(rt_ui32));
+                    }
+
+                    continue;
+                }
+#endif /* RT_OPTS_RENDER_EXT2 */
+
+                s_inf->index = y;
+                s_inf->frm_h = RT_MIN(y + tile_h, y_res);
+
+                for (i = 0; i < pfm->simd_width; i++)
+                {
+                    s_inf->hor_i[i] = fhi[i];
+                    s_inf->ver_i[i] = (rt_real)y + fvb[i];
+                }
+
+                /* render row-band based on tilebuffer */
+                pfm->render0(s_inf);
+            }
+        }
+    }
+    else
+#endif /* RT_OPTS_BALANCE */
+    {
+        s_inf->frm_h = y_res;
+
+        /* render frame based on tilebuffer */
+        pfm->render0(s_inf);
+    }
+
+    tharr[index]->t_last += get_usec() - t_start;
 }
 
 /*
@@ -3684,6 +7182,36 @@ rt_void rt_Scene::reset_pseed()
     }
 }
 
+/*
+ * Place row-bands of a framebuffer's plane with "row" bytes per line
+ * (< 0 - lines backwards in memory) on NUMA nodes of thread groups
+ * rendering them with dynamic render scheduler, pages touched afterwards
+ * by any thread are allocated on the preferred node.
+ */
+rt_void rt_Scene::bind_rows(rt_pntr ptr, rt_si32 row)
+{
+    rt_si32 g, y0, y1;
+
+    for (g = 0; g < ndnum; g++)
+    {
+        if (ndmap[g] < 0)
+        {
+            continue;
+        }
+
+        y0 = RT_MIN((g + 0) * tiles_in_col / ndnum * tile_h, y_res);
+        y1 = RT_MIN((g + 1) * tiles_in_col / ndnum * tile_h, y_res);
+
+        if (y1 <= y0)
+        {
+            continue;
+        }
+
+        numa_bind((rt_byte *)ptr + (rt_si64)(row < 0 ? y1 - 1 : y0) * row,
+                  (rt_size)(y1 - y0) * RT_ABS32(row), ndmap[g]);
+    }
+}
+
 /*
  * Reset current state of framebuffer's color-planes for path-tracer.
  */
@@ -3720,6 +7248,12 @@ rt_si32 rt_Scene::set_opts(rt_si32 opts)
      * "rootobj's" time is restored within the update */
     rootobj.time = -1;
 
+    /* drop pipelined update and cross-frame lists
+     * built with old flags, render the next frame fully */
+    drop_pipe();
+    lfull = 1;
+    dfull = 1;
+
     return opts;
 }
 
@@ -3738,9 +7272,127 @@ rt_si32 rt_Scene::set_pton(rt_si32 pton)
         reset_color();
     }
 
+    /* path-traced frame isn't kept,
+     * drop the frame updated ahead in old mode */
+    drop_pipe();
+    dfull = 1;
+
     return this->pt_on;
 }
 
+/*
+ * Set pipelined mode to: 0 - off, 1 - on.
+ * When on, the whole update (phases 0.5 to 3 and tiling) for the frame
+ * given to render() is run on the last render thread in parallel with
+ * rendering the previous one into twins of backend structs, tilebuffer
+ * and per-frame pools, thus the frame is only displayed by the next
+ * call to render() (one frame of latency).
+ */
+rt_si32 rt_Scene::set_pipe(rt_si32 pipe)
+{
+    pipe_on = pipe != 0;
+
+    if (!pipe_on)
+    {
+        drop_pipe();
+    }
+
+    return pipe_on;
+}
+
+/*
+ * Set lane occupancy counting of secondary rays to: 0 - off, 1 - on.
+ * When off (default), backend skips the counters' updates per packet
+ * and "get_occupancy/get_packets" report zeros.
+ */
+rt_si32 rt_Scene::set_occ(rt_si32 occ)
+{
+    occ_on = occ != 0;
+
+    if (!occ_on)
+    {
+        memset(occup, 0, sizeof(occup));
+        memset(opack, 0, sizeof(opack));
+    }
+
+    return occ_on;
+}
+
+/*
+ * Set keeping of cross-frame lists for unchanged objects
+ * to: 0 - off, 1 - on (default).
+ * When off, all lists are rebuilt every frame,
+ * which is used to measure the gain of keeping them.
+ */
+rt_si32 rt_Scene::set_keep(rt_si32 keep)
+{
+    lkeep = keep != 0;
+
+    return lkeep;
+}
+
+/*
+ * Return accumulated time (in us) the thread with given "index"
+ * has spent rendering its portion of the frame.
+ */
+rt_time rt_Scene::get_t_busy(rt_si32 index)
+{
+    return index >= 0 && index < thnum ? tharr[index]->t_busy : 0;
+}
+
+/*
+ * Return accumulated time (in us) the thread with given "index"
+ * has spent waiting for other threads to finish rendering.
+ */
+rt_time rt_Scene::get_t_idle(rt_si32 index)
+{
+    return index >= 0 && index < thnum ? tharr[index]->t_idle : 0;
+}
+
+/*
+ * Return imbalance of the given update "phase" (2 or 3) in the last frame
+ * as the ratio of max to average threads' time, 1.0 is perfect balance.
+ */
+rt_real rt_Scene::get_imbalance(rt_si32 phase)
+{
+    return phase >= 2 && phase <= 3 ? imbal[phase - 2] : 1.0f;
+}
+
+/*
+ * Return average share of active SIMD lanes in packets of secondary rays
+ * at the given bounce "level" (1 - first bounce) in the last frame.
+ */
+rt_real rt_Scene::get_occupancy(rt_si32 level)
+{
+    return level >= 1 && level <= (rt_si32)depth ? occup[level] : 0.0f;
+}
+
+/*
+ * Return number of packets of secondary rays
+ * at the given bounce "level" in the last frame.
+ */
+rt_si32 rt_Scene::get_packets(rt_si32 level)
+{
+    return level >= 1 && level <= (rt_si32)depth ? opack[level] : 0;
+}
+
+/*
+ * Return number of materials with mip chains for filtered textures,
+ * 0 if no filtered frame was rendered or scene has no such textures.
+ */
+rt_si32 rt_Scene::get_mips()
+{
+    return RT_MAX(mips, 0);
+}
+
+/*
+ * Return update time (in us) of the last frame.
+ */
+rt_time rt_Scene::get_t_update()
+{
+    return t_update;
+}
+
 /*
  * Return current camera index.
  */
@@ -3816,10 +7468,29 @@ rt_Scene::~rt_Scene()
 {
     rt_si32 i;
 
+    /* finish asynchronous render in flight */
+    if (async != RT_NULL)
+    {
+        try
+        {
+            wait_fence(fence_last);
+        }
+        catch (const rt_Exception &e)
+        {
+            /* destructor must not throw, report and proceed */
+            RT_LOGE("Exception in scene's destructor: %s\n", e.err);
+        }
+
+        delete async;
+    }
+
+    delete gpool;
+    delete pipe_bar;
+
     pfm->del_scene(this);
 
     /* destroy scene threads array */
-    for (i = 0; i < thnum; i++)
+    for (i = 0; i < thmax; i++)
     {
         delete tharr[i];
     }
@@ -3827,6 +7498,14 @@ rt_Scene::~rt_Scene()
     /* destroy object hierarchy */
     delete root;
 
+    /* destroy materials (shared by nodes) */
+    while (mat_head)
+    {
+        rt_Material *mat = mat_head->next;
+        delete mat_head;
+        mat_head = mat;
+    }
+
     /* destroy textures */
     while (tex_head)
     {
@@ -37,6 +37,28 @@
 
 #define RT_TILE_W               8  /* screen tile width  in pixels (%S == 0) */
 #define RT_TILE_H               8  /* screen tile height in pixels */
+#define RT_TILE_RUN             8  /* elements per contiguous run in tile list */
+
+#define RT_TASK_NUM             4  /* min number of subtree tasks per thread */
+#define RT_BAND_PAD             16 /* stride of per-node band counters (ints) */
+#define RT_FRAMES_MAX           4  /* max number of framebuffers in swap-chain */
+#define RT_LISTS_AGE            8  /* max frames adding lists before full rebuild */
+#define RT_LISTS_PART           4  /* 1/n of srf changed for full rebuild */
+#define RT_PIPE_PART            4  /* 1/n of threads for pipelined update */
+#define RT_BOUND_COST           1.0f /* bounding sphere test vs surface cost */
+#define RT_GRID_MIN             16 /* min run of sibling nodes to be gridded */
+#define RT_GRID_ANG             0.01f /* cone's widening in grid query (rad) */
+
+/*
+ * Cross-frame lists rebuilt in a frame,
+ * based on changes seen in update phase 1,
+ * only for surfaces involving changed ones
+ * unless all lists are rebuilt.
+ */
+#define RT_LISTS_LGT            1  /* light/shadow lists */
+#define RT_LISTS_SRF            2  /* surface/node, clipper and tile-node lists */
+#define RT_LISTS_ALL            3
+#define RT_LISTS_NEW            4  /* all lists of all surfaces */
 
 /*
  * Floating point thresholds,
@@ -64,6 +86,48 @@ class rt_Platform;
 class rt_SceneThread;
 class rt_Scene;
 
+/* Structures */
+
+struct rt_GRID;
+
+/*
+ * Grid structure indexes a run of sibling elements in "hlist"
+ * (top-level or array's contents) by uniform cells their bounding
+ * spheres overlap, used to find potential occluders between
+ * a surface and a light without walking the entire run.
+ */
+struct rt_GRID
+{
+    /* next grid in scene's list */
+    rt_GRID            *next;
+
+    /* run's elements in list order */
+    rt_ELEM           **elm;
+    rt_si32             num;
+
+    /* grid's origin, inverse cell size
+     * and number of cells per axis */
+    rt_vec4             org;
+    rt_vec4             scl;
+    rt_si32             dim[3];
+
+    /* cells' offsets into indices array,
+     * cell k holds idx[cel[k]] .. idx[cel[k+1]-1] */
+    rt_si32            *cel;
+    rt_si32            *idx;
+
+    /* indices of boundless (or too large) elements,
+     * which are potential occluders in every query */
+    rt_si32            *inf;
+    rt_si32             inf_num;
+
+    /* indices of surfaces with custom clippers,
+     * which clip relations may order regardless
+     * of the cones in sorting queries */
+    rt_si32            *clp;
+    rt_si32             clp_num;
+};
+
 /******************************************************************************/
 /*****************************   MULTI-THREADING   ****************************/
 /******************************************************************************/
@@ -96,6 +160,11 @@ class rt_Platform : private rt_LogRedirect, public rt_Heap
     rt_si32             thnum;
     rt_pntr             tdata;
 
+    /* NUMA node of each thread in the pool
+     * as reported by f_init (< 0 - unknown) */
+    rt_si32            *thnode;
+    rt_si32             thsize;
+
     /* backend specific structures */
     rt_SIMD_INFOX      *s_inf;
 
@@ -106,7 +175,14 @@ class rt_Platform : private rt_LogRedirect, public rt_Heap
 
     /* common antialiasing mode */
     rt_si32             fsaa;
-    /* single tile dimensions in pixels */
+    /* primary rays layout: SIMD lanes along
+     * scanline (0) or in square pixel blocks (1) */
+    rt_si32             pack;
+    /* texture filtering: nearest texel (0) or
+     * bilinear from mip-level by ray footprint (1) */
+    rt_si32             filt;
+    /* single tile dimensions in pixels,
+     * used by scenes constructed afterwards */
     rt_si32             tile_w;
     rt_si32             tile_h;
 
@@ -115,11 +191,17 @@ class rt_Platform : private rt_LogRedirect, public rt_Heap
     rt_Scene           *tail;
     rt_Scene           *cur;
 
+    /* split mode: threads are divided between scenes,
+     * each scene renders on its own thread-group */
+    rt_si32             split;
+
 /*  methods */
 
     rt_void     add_scene(rt_Scene *scn);
     rt_void     del_scene(rt_Scene *scn);
 
+    rt_void     split_threads();
+
     /* methods below are implemented in tracer.cpp */
     rt_void     update_mat(rt_SIMD_MATERIAL *s_mat);
     rt_si32     switch0(rt_SIMD_INFOX *s_inf, rt_si32 simd);
@@ -141,16 +223,28 @@ class rt_Platform : private rt_LogRedirect, public rt_Heap
     rt_si32     get_thnum();
     rt_si32     set_thnum(rt_si32 thnum);
 
+    rt_si32     get_node(rt_si32 index);
+    rt_void     set_node(rt_si32 index, rt_si32 node);
+
     rt_si32     set_simd(rt_si32 simd);
     rt_si32     set_fsaa(rt_si32 fsaa);
     rt_si32     get_fsaa_max();
     rt_si32     get_fsaa();
+    rt_si32     set_pack(rt_si32 pack);
+    rt_si32     get_pack();
+    rt_si32     set_filt(rt_si32 filt);
+    rt_si32     get_filt();
     rt_si32     get_tile_w();
+    rt_si32     get_tile_h();
+    rt_si32     set_tile(rt_si32 tile_w, rt_si32 tile_h);
 
     rt_Scene*   get_cur_scene();
     rt_Scene*   set_cur_scene(rt_Scene *scn);
     rt_void     next_scene();
 
+    rt_si32     get_split();
+    rt_si32     set_split(rt_si32 split);
+
     friend      class rt_SceneThread;
     friend      class rt_Scene;
 };
@@ -179,6 +273,54 @@ class rt_SceneThread : public rt_Heap
     /* temporary bbox verts buffer */
     rt_VERT            *verts;
 
+    /* hash-table of nodes' cones as seen
+     * from the object being sorted for,
+     * reused across "insert" calls */
+    rt_VCONE           *cones;
+    rt_si32             c_bits;
+    rt_si32             c_num;
+    rt_si32             c_tag;
+    rt_BOUND           *c_obj;
+
+    /* hash-table of trnode/bvnode elements
+     * by their parent element and bounds,
+     * used when building "hlist/slist",
+     * same size as cones' hash-table */
+    rt_ELEM           **nodes;
+    rt_si32             n_num;
+
+    /* query capsule for occluders between
+     * a surface and a light (segment from
+     * light to surface's "mid" and radius),
+     * cursors of gridded runs per hierarchy
+     * level and their candidates' bitmaps,
+     * allocated for the deepest hierarchy */
+    rt_si32             g_use;
+    rt_vec4             g_org;
+    rt_vec4             g_vec;
+    rt_real             g_rad;
+    rt_GRID           **g_grd;
+    rt_si32            *g_pos;
+    rt_si32            *g_ofs;
+    rt_ui32            *g_bit;
+
+    /* node being inserted, whose cone
+     * was queried in its gridded run,
+     * the last queried run's grid and
+     * its candidates' bitmap, kept apart
+     * from the capsule's as "lsort"
+     * inserts during its traversal */
+    rt_BOUND           *q_box;
+    rt_GRID            *q_grd;
+    rt_ui32            *q_bit;
+
+    /* node elements of the list being
+     * relinked, whose last leaf element
+     * is yet to be copied (old leaf, new
+     * node), for the deepest hierarchy */
+    rt_ELEM           **l_end;
+    rt_ELEM           **l_elm;
+
     public:
 
     /* backend specific structures */
@@ -190,6 +332,33 @@ class rt_SceneThread : public rt_Heap
      * for temporary per-frame allocs */
     rt_pntr             mpool;
     rt_ui32             msize;
+    /* start of lists kept across frames,
+     * changes seen by thread in phase 1
+     * and number of changed surfaces */
+    rt_pntr             lpool;
+    rt_si32             l_chg;
+    rt_si32             l_num;
+    /* per-frame allocs of the frame being
+     * rendered in pipelined mode, moved
+     * to heap's twin chain of chunks */
+    rt_pntr             ppool;
+
+    /* thread's render time (in us) for
+     * the last frame and accumulated
+     * busy/idle time in render phase */
+    rt_time             t_last;
+    rt_time             t_busy;
+    rt_time             t_idle;
+
+    /* thread's time (in us) and sum of
+     * surfaces' costs in update phases 2, 3
+     * for the last frame */
+    rt_time             t_phase[2];
+    rt_time             c_phase[2];
+
+    /* lane occupancy counters filled by backend
+     * (active lanes, packets) per remaining depth */
+    rt_elem            *s_occ;
 
 /*  methods */
 
@@ -197,8 +366,20 @@ class rt_SceneThread : public rt_Heap
 
     rt_void     tiling(rt_vec2 p1, rt_vec2 p2);
 
+    rt_VCONE*   cone(rt_Object *obj, rt_BOUND *nd);
+    rt_si32     order(rt_Object *obj, rt_BOUND *nd1, rt_BOUND *nd2);
+
+    rt_ELEM**   search(rt_ELEM *prv, rt_pntr box);
+
     rt_ELEM*    insert(rt_Object *obj, rt_ELEM **ptr, rt_ELEM *tem);
 
+    rt_void     gwalk(rt_GRID *grd, rt_ui32 *bit, rt_si32 idx,
+                      rt_real *org, rt_real *vec, rt_real rad, rt_real tan);
+    rt_void     gcone(rt_Object *obj, rt_ELEM *tem);
+
+    rt_ELEM*    gfirst(rt_ELEM *lst, rt_si32 lvl);
+    rt_ELEM*    gnext(rt_ELEM *elm, rt_si32 lvl);
+
     public:
 
     rt_ELEM*    filter(rt_Object *obj, rt_ELEM **ptr);
@@ -214,9 +395,18 @@ class rt_SceneThread : public rt_Heap
     rt_void     snode(rt_Surface *srf);
     rt_void     sclip(rt_Surface *srf);
     rt_void     stile(rt_Surface *srf);
+    rt_void     sbins(rt_ELEM *lst);
+    rt_void     sdirt();
 
     rt_ELEM*    ssort(rt_Object *obj);
     rt_ELEM*    lsort(rt_Object *obj);
+
+    rt_si32     sgrid(rt_ELEM *lst, rt_GRID **top);
+
+    rt_ELEM*    flink(rt_ELEM *lst);
+    rt_ELEM*    llink(rt_ELEM *lst);
+    rt_ELEM*    hlink(rt_ELEM *lst, rt_ELEM *prv);
+    rt_void     slink(rt_Surface *srf);
 };
 
 /******************************************************************************/
@@ -246,10 +436,45 @@ class rt_Scene : private rt_Registry, public rt_List<rt_Scene>
     rt_si32             x_row;
     rt_ui32            *frame;
 
+    /* swap-chain of framebuffers, "frame" is
+     * the last completed one (at index "fcur"),
+     * the next frame is rendered at index "fnext" */
+    rt_ui32            *fbuf[RT_FRAMES_MAX];
+    rt_si32             fnum;
+    rt_si32             fcur;
+    rt_si32             fnext;
+
+    /* asynchronous render: driver thread, time of
+     * the frame in flight, its fence (0 - none)
+     * and the last fence issued */
+    rt_ThreadPool      *async;
+    rt_time             async_time;
+    rt_si32             fence_pend;
+    rt_si32             fence_last;
+
+    /* single tile dimensions in pixels */
+    rt_si32             tile_w;
+    rt_si32             tile_h;
+
     /* tilebuffer's dimensions and pointer */
     rt_si32             tiles_in_row;
     rt_si32             tiles_in_col;
     rt_ELEM           **tiles;
+    /* tiles' view-cones around their frustums
+     * for culling spheres, updated every frame */
+    rt_VCONE           *tcones;
+
+    /* dirty tiles (RT_OPTS_RENDER_EXT2): full render
+     * request for the next update, the same for all rows
+     * in the current one, tiles' list signatures and
+     * tile rows to re-render from the last update,
+     * camera and backend state it was done for */
+    rt_si32             dfull;
+    rt_si32             dall;
+    rt_ui64            *dsign;
+    rt_si32            *drows;
+    rt_vec4             dcam[4];
+    rt_si32             dmode[2];
 
     /* framebuffer's seed-plane for path-tracer */
     rt_elem            *pseed;
@@ -274,24 +499,152 @@ class rt_Scene : private rt_Registry, public rt_List<rt_Scene>
     /* pending release flag */
     rt_si32             pending;
 
+    /* cross-frame lists: full rebuild flag,
+     * lists rebuilt in the last frame,
+     * number of frames since full rebuild
+     * and keeping of lists across frames */
+    rt_si32             lfull;
+    rt_si32             lmode;
+    rt_si32             lage;
+    rt_si32             lkeep;
+    /* update time (in us) of the last frame */
+    rt_time             t_update;
+    /* number of arrays not bounded in scene data
+     * whose bounding volumes were selected by the engine */
+    rt_si32             bvauto;
+    /* number of materials with mip chains,
+     * -1 if not built (filtering never on) */
+    rt_si32             mips;
+
     /* thread management functions */
     rt_FUNC_UPDATE      f_update;
     rt_FUNC_RENDER      f_render;
 
     /* scene's thread-array and its
-     * platform-specific handle */
+     * platform-specific handle,
+     * "thnum" threads out of "thmax" are used */
     rt_si32             thnum;
+    rt_si32             thmax;
     rt_SceneThread    **tharr;
     rt_pntr             tdata;
 
+    /* thread-group in platform's split mode:
+     * requested budget (0 - fair share),
+     * assigned first thread and size,
+     * active first thread (< 0 - no group)
+     * and group's own thread-pool */
+    rt_si32             gbudget;
+    rt_si32             gfirst;
+    rt_si32             gnum;
+    rt_si32             gcur;
+    rt_ThreadPool      *gpool;
+
+    /* threads grouped by NUMA node, each group
+     * renders its own contiguous part of the frame
+     * placed on that node: group of each thread,
+     * node of each group and number of groups */
+    rt_si32            *thgrp;
+    rt_si32            *ndmap;
+    rt_si32             ndnum;
+
+    /* next row-band (tile row) within each group's part
+     * to be picked by dynamic render scheduler in threads,
+     * counters are RT_BAND_PAD apart to avoid false sharing */
+    volatile rt_si32   *rband;
+
+    /* pipelined mode: update of the next frame (all phases
+     * and tiling) runs on the last render threads while
+     * the frame renders: mode is on, next frame is updated,
+     * its time, update is running, kept lists can be relinked
+     * (the last update was pipelined too) */
+    rt_si32             pipe_on;
+    rt_si32             pipe_set;
+    rt_time             pipe_time;
+    rt_si32             pipe_upd;
+    rt_si32             pipe_lnk;
+
+    /* number of the last render threads running
+     * the update, the last one leads, others run
+     * slices of its phases: their barrier, the phase
+     * posted (0 - update done) and error in its slices */
+    rt_si32             pipe_num;
+    rt_Barrier         *pipe_bar;
+    volatile rt_si32    pipe_cmd;
+    rt_pstr volatile    pipe_err;
+
+    /* per-frame allocs of the frame being rendered,
+     * twins of tilebuffer and tile rows to re-render
+     * updated for the next frame in pipelined mode */
+    rt_pntr             ppool;
+    rt_ELEM           **t_tiles;
+    rt_si32            *t_rows;
+
+    /* ray setup, camera's list, tilebuffer and
+     * tile rows to re-render handed over to the render,
+     * so that the next frame's update can replace
+     * the originals while the frame renders */
+    rt_vec4             rpos;
+    rt_vec4             rdir;
+    rt_vec4             rhor;
+    rt_vec4             rver;
+    rt_vec4             ramb;
+    rt_real             rpov;
+    rt_ELEM            *rclst;
+    rt_ELEM           **rtile;
+    rt_si32            *rrows;
+
+    /* subtree tasks for hierarchical update
+     * (phases 0.5 and 2.5), arrays updated
+     * sequentially before/after the tasks,
+     * next task to be picked by threads */
+    rt_Object         **tlist;
+    rt_si32             tnum;
+    rt_Array          **xlist;
+    rt_si32             xnum;
+    volatile rt_si32    tnext;
+    rt_time             ttime;
+
+    /* surfaces changed in the current frame,
+     * whose relations select lists to rebuild */
+    rt_Surface        **ulist;
+    rt_si32             unum;
+
+    /* current buffer of surfaces' costs,
+     * sums of costs and imbalance (max/avg
+     * of threads' time) in update phases 2, 3 */
+    rt_si32             ccur;
+    rt_time             csum[2][2];
+    rt_real             imbal[2];
+
+    /* share of active SIMD lanes and number
+     * of packets of secondary rays per bounce
+     * level (1 - first bounce) in the last frame,
+     * only counted by backend if "occ_on" is set */
+    rt_si32             occ_on;
+    rt_real             occup[RT_STACK_DEPTH + 1];
+    rt_si32             opack[RT_STACK_DEPTH + 1];
+
     /* global hierarchical list */
     rt_ELEM            *hlist;
+    /* grids over long runs in "hlist" */
+    rt_GRID            *hgrid;
     /* global surface/node list */
     rt_ELEM            *slist;
     /* global light/shadow list */
     rt_ELEM            *llist;
+    /* global lists relinked in the current update
+     * in pipelined mode, the ones they were copied
+     * from and relinked in the last update, which
+     * kept lists may refer to */
+    rt_ELEM            *s_lnk;
+    rt_ELEM            *l_lnk;
+    rt_ELEM            *s_old[2];
+    rt_ELEM            *l_old[2];
     /* camera's surface/node list */
     rt_ELEM            *clist;
+    /* reversed copy of "clist"
+     * for screen tiles binning */
+    rt_ELEM            *rlist;
 
     /* ray-position variables */
     rt_vec4             pos;
@@ -320,6 +673,37 @@ class rt_Scene : private rt_Registry, public rt_List<rt_Scene>
     rt_void     reset_pseed();
     rt_void     reset_color();
 
+    rt_void     bind_rows(rt_pntr ptr, rt_si32 row);
+
+    rt_bool     is_threaded();
+    rt_void     update_group();
+    rt_void     group_nodes();
+
+    rt_void     render_frame(rt_time time);
+    rt_void     update_frame(rt_time time);
+    rt_void     swap_frame();
+
+    rt_void     swap_simd();
+    rt_void     swap_pool();
+    rt_void     release_twin();
+    rt_void     drop_pipe();
+    rt_void     relink_pool();
+
+    static
+    rt_void     async_task(rt_pntr arg, rt_si32 index, rt_si32 cmd);
+
+    rt_void     update_tree(rt_time time);
+    rt_void     update_bbox();
+    rt_void     update_dirty();
+    rt_si32     update_lists(rt_Surface *srf);
+    rt_real     bound_size(rt_Array *arr, rt_vec4 mid, rt_si32 *num);
+    rt_si32     bound_auto(rt_Array *arr, rt_real prd);
+    rt_void     release_pool();
+
+    rt_bool     cost_skip(rt_Surface *srf, rt_si32 i, rt_si32 index,
+                          rt_si32 p, rt_time *c);
+    rt_void     cost_done(rt_si32 p);
+
     public:
 
     rt_pntr operator new(size_t size, rt_Heap *hp);
@@ -335,8 +719,17 @@ class rt_Scene : private rt_Registry, public rt_List<rt_Scene>
     rt_void     update(rt_time time, rt_si32 action);
     rt_void     render(rt_time time);
 
+    rt_si32     set_threads(rt_si32 num);
+    rt_si32     get_threads();
+
+    rt_si32     render_async(rt_time time);
+    rt_bool     poll_fence(rt_si32 fence);
+    rt_void     wait_fence(rt_si32 fence);
+    rt_si32     set_frames(rt_si32 num);
+
     rt_void     update_slice(rt_si32 index, rt_si32 phase);
     rt_void     render_slice(rt_si32 index, rt_si32 phase);
+    rt_void     update_pipe(rt_si32 index, rt_si32 phase);
 
     rt_void     render_num(rt_si32 x, rt_si32 y,
                            rt_si32 d, rt_si32 z, rt_ui32 num);
@@ -350,6 +743,17 @@ class rt_Scene : private rt_Registry, public rt_List<rt_Scene>
     rt_si32     get_opts();
     rt_si32     set_opts(rt_si32 opts);
     rt_si32     set_pton(rt_si32 pton);
+    rt_si32     set_pipe(rt_si32 pipe);
+    rt_si32     set_occ(rt_si32 occ);
+    rt_si32     set_keep(rt_si32 keep);
+
+    rt_time     get_t_busy(rt_si32 index);
+    rt_time     get_t_idle(rt_si32 index);
+    rt_real     get_imbalance(rt_si32 phase);
+    rt_real     get_occupancy(rt_si32 level);
+    rt_si32     get_packets(rt_si32 level);
+    rt_si32     get_mips();
+    rt_time     get_t_update();
 
     rt_si32     get_cam_idx();
     rt_si32     next_cam();
@@ -359,6 +763,7 @@ class rt_Scene : private rt_Registry, public rt_List<rt_Scene>
     rt_Platform*get_platform();
 
     friend      class rt_SceneThread;
+    friend      class rt_Platform;
 };
 
 /* internal SIMD format converter */
@@ -42,7 +42,7 @@
 #define RT_OPTS_TILING_EXT1     (1 << 2)
 #define RT_OPTS_FSCALE          (1 << 3)
 #define RT_OPTS_TARRAY          (1 << 4)
-#define RT_OPTS_VARRAY          (1 << 5) /* 6 is reserved for future exts */
+#define RT_OPTS_VARRAY          (1 << 5) /* 6 is taken by RENDER_EXT2 */
 #define RT_OPTS_ADJUST          (1 << 7)
 #define RT_OPTS_UPDATE          (1 << 8)
 #define RT_OPTS_RENDER          (1 << 9)
@@ -58,6 +58,9 @@
 #define RT_OPTS_REMOVE          (0 << 19)
 #define RT_OPTS_GAMMA           (1 << 20) /* turns off Gamma when set to 1 */
 #define RT_OPTS_FRESNEL         (1 << 21) /* turns off Fresnel when set to 1 */
+#define RT_OPTS_BALANCE         (1 << 22) /* update/render load balancing */
+#define RT_OPTS_SUBTREE         (1 << 23) /* parallel subtree tasks, phase .5 */
+#define RT_OPTS_TILING_RUNS     (1 << 24) /* tile lists in contiguous runs */
 
 #define RT_OPTS_PT              (1 << 25) /* prohibits path-tracer if 1 */
 
@@ -69,6 +72,7 @@
 /* extra options (render) */
 #define RT_OPTS_RENDER_EXT0     (1 << 30) /* render scene off */
 #define RT_OPTS_RENDER_EXT1     (1 << 31) /* render scene single-threadedly */
+#define RT_OPTS_RENDER_EXT2     (1 << 6)  /* render changed tile rows only */
 
 /* Gamma correction (RT_OPTS_GAMMA) and Fresnel reflectance (RT_OPTS_FRESNEL)
  * optimizations are on by default (which turns corresponding properties off)
@@ -85,6 +89,7 @@
         RT_OPTS_THREAD          |                                           \
         RT_OPTS_TILING          |                                           \
         RT_OPTS_TILING_EXT1     |                                           \
+        RT_OPTS_TILING_RUNS     |                                           \
         RT_OPTS_FSCALE          |                                           \
         RT_OPTS_TARRAY          |                                           \
         RT_OPTS_VARRAY          |                                           \
@@ -101,6 +106,8 @@
         RT_OPTS_INSERT_EXT1     |                                           \
         RT_OPTS_INSERT_EXT2     |                                           \
         RT_OPTS_REMOVE          |                                           \
+        RT_OPTS_BALANCE         |                                           \
+        RT_OPTS_SUBTREE         |                                           \
         RT_OPTS_GAMMA           |                                           \
         RT_OPTS_FRESNEL         |                                           \
         RT_OPTS_PT              )
@@ -178,11 +178,8 @@ rt_void rt_Object::update_status(rt_time time, rt_si32 flags,
     /* animator is called only once for object
      * instances sharing the same scene data,
      * part of sequential update (phase 0.5)
-     * as the code below is not thread-safe */
-    if (obj->f_anim != RT_NULL && obj->time != time)
-    {
-        obj->f_anim(time, obj->time < 0 ? 0 : obj->time, trm, RT_NULL);
-    }
+     * unless called ahead of it for subtree tasks */
+    update_anim(time);
 
     /* always update time in scene data to distinguish
      * between first update and all subsequent updates,
@@ -407,6 +404,21 @@ rt_void rt_Object::update_fields()
 
 }
 
+/*
+ * Call object's animator for given "time" if not yet called,
+ * not thread-safe for object instances sharing the same scene data,
+ * thus is called sequentially ahead of parallel subtree tasks (phase 0.5).
+ */
+rt_void rt_Object::update_anim(rt_time time)
+{
+    if (obj->f_anim != RT_NULL && obj->time != time)
+    {
+        obj->f_anim(time, obj->time < 0 ? 0 : obj->time, trm, RT_NULL);
+
+        obj->time = time;
+    }
+}
+
 /*
  * Deinitialize object.
  */
@@ -606,6 +618,7 @@ rt_Light::rt_Light(rt_Registry *rg, rt_Object *parent, rt_OBJECT *obj) :
 /*  rt_SIMD_LIGHT */
 
     s_lgt = (rt_SIMD_LIGHT *)rg->alloc(sizeof(rt_SIMD_LIGHT), RT_SIMD_ALIGN);
+    t_lgt = RT_NULL;
 
     RT_SIMD_SET(s_lgt->t_max, 1.0f);
 
@@ -617,7 +630,9 @@ rt_Light::rt_Light(rt_Registry *rg, rt_Object *parent, rt_OBJECT *obj) :
     RT_SIMD_SET(s_lgt->a_qdr, lgt->atn[3]);
     RT_SIMD_SET(s_lgt->a_lnr, lgt->atn[2]);
     RT_SIMD_SET(s_lgt->a_cnt, lgt->atn[1] + 1.0f);
-    RT_SIMD_SET(s_lgt->a_rng, lgt->atn[0]);
+    /* range is stored squared for the tracer, zero range is unlimited */
+    RT_SIMD_SET(s_lgt->a_rng, lgt->atn[0] > 0.0f ?
+                              lgt->atn[0] * lgt->atn[0] : RT_INF);
 
     ((rt_Array *)parent)->col.hdr[RT_R] += s_lgt->col_r[0];
     ((rt_Array *)parent)->col.hdr[RT_G] += s_lgt->col_g[0];
@@ -666,6 +681,32 @@ rt_void rt_Light::update_fields()
     RT_SIMD_SET(s_lgt->pos_z, pos[RT_Z]);
 }
 
+/*
+ * Swap SIMD struct with its twin (pipelined mode), the one swapped out
+ * is still being rendered, the other one takes over its contents
+ * to be updated for the next frame, unless "copy" is not set
+ * (the twin already holds them as the light hasn't changed since).
+ */
+rt_void rt_Light::swap_simd(rt_bool copy)
+{
+    rt_SIMD_LIGHT *s_tmp = s_lgt;
+
+    if (t_lgt == RT_NULL)
+    {
+        t_lgt = (rt_SIMD_LIGHT *)
+                rg->alloc(sizeof(rt_SIMD_LIGHT), RT_SIMD_ALIGN);
+        copy = RT_TRUE;
+    }
+
+    s_lgt = t_lgt;
+    t_lgt = s_tmp;
+
+    if (copy)
+    {
+        memcpy(s_lgt, t_lgt, sizeof(rt_SIMD_LIGHT));
+    }
+}
+
 /*
  * Deinitialize light object.
  */
@@ -726,6 +767,9 @@ rt_Node::rt_Node(rt_Registry *rg, rt_Object *parent,
     memset(s_srf, 0, ssize);
     s_srf->srf_t[3] = tag;
 
+    s_size = ssize;
+    t_srf = RT_NULL;
+
 #if 0 /* surface's misc pointers description */
 
     s_srf->srf_t[0];    /* surf ptr, filled in update0 */
@@ -733,7 +777,7 @@ rt_Node::rt_Node(rt_Registry *rg, rt_Object *parent,
     s_srf->srf_t[2];    /* clip ptr, filled in update0 */
     s_srf->srf_t[3];    /* surf tag */
 
-    s_srf->msc_p[0];    /* screen tiles */
+    s_srf->msc_p[0];    /* screen tiles, per row-band */
     s_srf->msc_p[1];    /* surf flg, filled in update0 */
     s_srf->msc_p[2];    /* custom clippers */
     s_srf->msc_p[3];    /* trnode's simd ptr */
@@ -843,6 +887,43 @@ rt_void rt_Node::update_fields()
     RT_SIMD_SET(s_srf->pos_z, pos[RT_Z]);
 }
 
+/*
+ * Swap SIMD structs with their twins (pipelined mode), the ones swapped out
+ * are still being rendered, the others take over their contents
+ * to be updated for the next frame, unless "copy" is not set
+ * (the twins already hold them as the node hasn't changed since).
+ */
+rt_void rt_Node::swap_simd(rt_bool copy)
+{
+    rt_SIMD_SURFACE *s_tmp = s_srf;
+
+    if (t_srf == RT_NULL)
+    {
+        t_srf = (rt_SIMD_SURFACE *)rg->alloc(s_size, RT_SIMD_ALIGN);
+        copy = RT_TRUE;
+    }
+
+    s_srf = t_srf;
+    t_srf = s_tmp;
+
+    if (copy)
+    {
+        memcpy(s_srf, t_srf, s_size);
+    }
+}
+
+/*
+ * Relink SIMD structs to those swapped in by other objects,
+ * must be called once all objects are swapped.
+ */
+rt_void rt_Node::link_simd()
+{
+    /* trnode's simd ptr is needed in rendering backend
+     * to check if surface and its clippers belong to the same trnode */
+    s_srf->msc_p[3] = trnode == RT_NULL ?
+                                RT_NULL : ((rt_Node *)trnode)->s_srf;
+}
+
 /*
  * Update bounding box and volume geometry.
  */
@@ -1126,6 +1207,54 @@ rt_void rt_Node::update_bbgeom(rt_BOUND *box)
 #endif /* RT_OPTS_REMOVE */
 }
 
+/*
+ * Get material for given side "sd" and material data "mat",
+ * reusing the one made for another node with the same data,
+ * so that instances of a subtree share their materials.
+ * Emitting surfaces take parent array's light into material
+ * and planes scale their texture mapping within material,
+ * such materials are kept per node.
+ */
+rt_Material* rt_Node::get_material(rt_SIDE *sd, rt_MATERIAL *mat)
+{
+    rt_Material *mtl = RT_NULL;
+
+    rt_ui32 i = ((rt_ui32)((rt_word)sd  >> 4) * 2654435761U
+              ^  (rt_ui32)((rt_word)mat >> 4) * 2246822519U)
+                                              >> (32 - RT_MAT_BITS);
+
+    if (rg->mht == RT_NULL)
+    {
+        rg->mht = (rt_Material **)rg->alloc(sizeof(rt_Material *) <<
+                                            RT_MAT_BITS, RT_ALIGN);
+        memset(rg->mht, 0, sizeof(rt_Material *) << RT_MAT_BITS);
+    }
+
+    /* check if requested material already exists
+     * among shared ones in hash-table's slot */
+    for (mtl = rg->mht[i]; mtl != RT_NULL; mtl = mtl->hnext)
+    {
+        if (mtl->sd == sd && mtl->mat == mat)
+        {
+            return mtl;
+        }
+    }
+
+    mtl = new(rg) rt_Material(rg, sd, mat);
+
+    mtl->share = tag == RT_TAG_ARRAY
+             || ((mtl->props & RT_PROP_LIGHT) == 0
+             && ((mtl->props & RT_PROP_TEXTURE) == 0 || tag != RT_TAG_PLANE));
+
+    if (mtl->share != 0)
+    {
+        mtl->hnext = rg->mht[i];
+        rg->mht[i] = mtl;
+    }
+
+    return mtl;
+}
+
 /*
  * Deinitialize node object.
  */
@@ -1178,6 +1307,14 @@ rt_Array::rt_Array(rt_Registry *rg, rt_Object *parent,
     /* reset array's changed status */
     arr_changed = 0;
 
+    /* init array's depth for subtree tasks */
+    sub_flags = 0;
+    arr_depth = parent != RT_NULL ? ((rt_Array *)parent)->arr_depth + 1 : 0;
+    bnd_depth = arr_depth;
+    bnd_task = 0;
+    bnd_node = 0;
+    bnd_auto = 0;
+
     /* reset array's accumulated light */
     memset(&col, 0, sizeof(rt_COL));
 
@@ -1587,10 +1724,10 @@ rt_Array::rt_Array(rt_Registry *rg, rt_Object *parent,
     }
 
     /* init outer side material */
-    outer = new(rg) rt_Material(rg, &sd_array01, &mt_glass01_array01);
+    outer = get_material(&sd_array01, &mt_glass01_array01);
 
     /* init inner side material */
-    inner = new(rg) rt_Material(rg, &sd_array01, &mt_glass01_array01);
+    inner = get_material(&sd_array01, &mt_glass01_array01);
 
     /* validate surface size */
     ssize = RT_MAX(ssize, sizeof(rt_SIMD_SURFACE));
@@ -1619,6 +1756,9 @@ rt_Array::rt_Array(rt_Registry *rg, rt_Object *parent,
     memset(s_bvb, 0, ssize);
     s_bvb->srf_t[3] = RT_TAG_SURFACE_MAX;
 
+    t_inb = RT_NULL;
+    t_bvb = RT_NULL;
+
     s_bvb->mat_p[0] = outer->s_mat;
     s_bvb->mat_p[1] = (rt_pntr)(rt_word)outer->props;
     s_bvb->mat_p[2] = inner->s_mat;
@@ -1738,20 +1878,90 @@ rt_void rt_Array::update_matrix(rt_mat4 mtx)
  */
 rt_void rt_Array::update_object(rt_time time, rt_si32 flags,
                                 rt_Object *trnode, rt_mat4 mtx)
+{
+    update_array(time, flags, trnode, mtx);
+
+    rt_si32 i;
+
+    /* update every object in array including sub-arrays (recursive) */
+    for (i = 0; i < obj_num; i++)
+    {
+        update_subobj(time, obj_arr[i], RT_TRUE);
+    }
+
+    update_depth();
+}
+
+/*
+ * Update array's own status and matrix with given "time", "flags",
+ * "trnode" and matrix "mtx" without updating its sub-objects.
+ */
+rt_void rt_Array::update_array(rt_time time, rt_si32 flags,
+                               rt_Object *trnode, rt_mat4 mtx)
 {
     update_status(time, flags, trnode);
 
     update_matrix(mtx);
 
+    /* save array's own transform flags
+     * and changed status for sub-objects */
+    sub_flags = flags | mtx_has_trm | obj_changed;
+}
+
+/*
+ * Update array's sub-object "sub" with given "time",
+ * pass array's own transform flags, changed status,
+ * updated trnode and matrix pointer for sub-object,
+ * sub-array's sub-objects are updated only if "deep" is true.
+ */
+rt_void rt_Array::update_subobj(rt_time time, rt_Object *sub, rt_bool deep)
+{
+    if (!deep && RT_IS_ARRAY(sub))
+    {
+        ((rt_Array *)sub)->update_array(time, sub_flags, this->trnode, *pmtx);
+    }
+    else
+    {
+        sub->update_object(time, sub_flags, this->trnode, *pmtx);
+    }
+}
+
+/*
+ * Update minimum depth of arrays receiving bounds
+ * from array's sub-objects (recursive) in phase 2.5,
+ * surfaces' trnodes are not final until phase 1,
+ * but they can only change to surfaces themselves,
+ * thus the estimate is conservative.
+ */
+rt_void rt_Array::update_depth()
+{
     rt_si32 i;
 
-    /* update every object in array including sub-arrays (recursive),
-     * pass array's own transform flags, changed status,
-     * updated trnode and matrix pointer for sub-objects */
+    bnd_depth = arr_depth;
+
     for (i = 0; i < obj_num; i++)
     {
-        obj_arr[i]->update_object(time, flags | mtx_has_trm | obj_changed,
-                                  this->trnode, *pmtx);
+        rt_Object *nd = obj_arr[i];
+
+        if (!RT_IS_ARRAY(nd) && !RT_IS_SURFACE(nd))
+        {
+            continue;
+        }
+
+        if (nd->trnode != RT_NULL && nd->trnode != nd)
+        {
+            bnd_depth = RT_MIN(bnd_depth, ((rt_Array *)nd->trnode)->arr_depth);
+        }
+
+        if (nd->bvnode != RT_NULL)
+        {
+            bnd_depth = RT_MIN(bnd_depth, ((rt_Array *)nd->bvnode)->arr_depth);
+        }
+
+        if (RT_IS_ARRAY(nd))
+        {
+            bnd_depth = RT_MIN(bnd_depth, ((rt_Array *)nd)->bnd_depth);
+        }
     }
 }
 
@@ -1824,6 +2034,56 @@ rt_void rt_Array::update_fields()
     RT_SIMD_SET(s_bvb->scj_z, 0.0f);
 }
 
+/*
+ * Swap SIMD structs with their twins (pipelined mode), the ones swapped out
+ * are still being rendered, the others take over their contents
+ * to be updated for the next frame, unless "copy" is not set.
+ */
+rt_void rt_Array::swap_simd(rt_bool copy)
+{
+    rt_SIMD_SURFACE *s_tmp;
+
+    rt_Node::swap_simd(copy);
+
+    if (t_inb == RT_NULL)
+    {
+        t_inb = (rt_SIMD_SURFACE *)rg->alloc(s_size, RT_SIMD_ALIGN);
+        t_bvb = (rt_SIMD_SURFACE *)rg->alloc(s_size, RT_SIMD_ALIGN);
+        copy = RT_TRUE;
+    }
+
+    s_tmp = s_inb;
+    s_inb = t_inb;
+    t_inb = s_tmp;
+
+    s_tmp = s_bvb;
+    s_bvb = t_bvb;
+    t_bvb = s_tmp;
+
+    if (copy)
+    {
+        memcpy(s_inb, t_inb, s_size);
+        memcpy(s_bvb, t_bvb, s_size);
+    }
+}
+
+/*
+ * Relink SIMD structs to those swapped in by other objects,
+ * must be called once all objects are swapped.
+ */
+rt_void rt_Array::link_simd()
+{
+    rt_Node::link_simd();
+
+    s_inb->msc_p[3] = s_srf->msc_p[3];
+
+    s_inb->mat_p[0] = outer->s_mat;
+    s_inb->mat_p[2] = inner->s_mat;
+
+    s_bvb->mat_p[0] = outer->s_mat;
+    s_bvb->mat_p[2] = inner->s_mat;
+}
+
 /*
  * Update bounding box and volume along with related SIMD fields.
  */
@@ -1834,6 +2094,16 @@ rt_void rt_Array::update_bounds()
         return;
     }
 
+#if RT_DEBUG >= 1
+
+    /* subtree task's bounds must not be recomputed sequentially */
+    if (bnd_task != 0)
+    {
+        throw rt_Exception("subtree task's bounds recomputed in phase 2.5");
+    }
+
+#endif /* RT_DEBUG */
+
     /* reset all boxes for array */
     RT_VEC3_SET_VAL1(bvbox->bmin, +RT_INF);
     RT_VEC3_SET_VAL1(bvbox->bmax, -RT_INF);
@@ -1870,7 +2140,17 @@ rt_void rt_Array::update_bounds()
         {
             nd = (rt_Node *)obj_arr[i];
             arr = (rt_Array *)nd;
-            arr->update_bounds();
+
+            /* skip sub-arrays updated by subtree tasks,
+             * their contribution below is still sequential */
+            if (arr->bnd_task != 0)
+            {
+                arr->bnd_task = 0;
+            }
+            else
+            {
+                arr->update_bounds();
+            }
         }
         else
         if (RT_IS_SURFACE(obj_arr[i]))
@@ -2327,8 +2607,8 @@ rt_Array::~rt_Array()
         delete obj_arr[i];
     }
 
-    delete outer;
-    delete inner;
+    /* materials may be shared,
+     * destroyed by the scene */
 }
 
 /******************************************************************************/
@@ -2351,13 +2631,22 @@ rt_Surface::rt_Surface(rt_Registry *rg, rt_Object *parent,
     /* reset surface's changed status */
     srf_changed = 0;
 
+    /* reset surface's update costs */
+    memset(srf_cost, 0, sizeof(srf_cost));
+
+    /* reset surface's dirty status,
+     * the first frame is rendered fully */
+    srf_dirty = 1;
+    memset(dmid, 0, sizeof(dmid));
+    drad = RT_INF;
+
     /* init outer side material */
-    outer = new(rg) rt_Material(rg, &srf->side_outer,
+    outer = get_material(&srf->side_outer,
                     obj->obj.pmat_outer ? obj->obj.pmat_outer :
                                           srf->side_outer.pmat);
 
     /* init inner side material */
-    inner = new(rg) rt_Material(rg, &srf->side_inner,
+    inner = get_material(&srf->side_inner,
                     obj->obj.pmat_inner ? obj->obj.pmat_inner :
                                           srf->side_inner.pmat);
 
@@ -2502,6 +2791,31 @@ rt_void rt_Surface::update_fields()
                                 RT_NULL : ((rt_Node *)trnode)->s_srf;
 }
 
+/*
+ * Swap SIMD structs with their twins (pipelined mode), the ones swapped out
+ * are still being rendered, the others take over their contents
+ * to be updated for the next frame, unless "copy" is not set.
+ */
+rt_void rt_Surface::swap_simd(rt_bool copy)
+{
+    rt_Node::swap_simd(copy);
+
+    /* custom clippers list is rebuilt in the new struct */
+    shape->ptr = (rt_pntr*)&s_srf->msc_p[2];
+}
+
+/*
+ * Relink SIMD structs to those swapped in by other objects,
+ * must be called once all objects are swapped.
+ */
+rt_void rt_Surface::link_simd()
+{
+    rt_Node::link_simd();
+
+    s_srf->mat_p[0] = outer->s_mat;
+    s_srf->mat_p[2] = inner->s_mat;
+}
+
 /*
  * Adjust local space bounding and clipping boxes according to surface shape.
  */
@@ -2849,8 +3163,8 @@ rt_void rt_Surface::update_bounds()
  */
 rt_Surface::~rt_Surface()
 {
-    delete outer;
-    delete inner;
+    /* materials may be shared,
+     * destroyed by the scene */
 }
 
 /******************************************************************************/
@@ -2915,27 +3229,34 @@ rt_void rt_Plane::update_fields()
     rt_real *scl, *pos;
     rt_SIMD_MATERIAL *s_mat;
 
-    map = outer->map;
-    scl = outer->scl;
-    pos = outer->sd->pos;
-    s_mat = outer->s_mat;
+    /* shared materials have no texture to scale */
+    if (outer->share == 0)
+    {
+        map = outer->map;
+        scl = outer->scl;
+        pos = outer->sd->pos;
+        s_mat = outer->s_mat;
 
-    RT_SIMD_SET(s_mat->xscal, scl[RT_X] * isc[map[RT_X]]);
-    RT_SIMD_SET(s_mat->yscal, scl[RT_Y] * isc[map[RT_Y]]);
+        RT_SIMD_SET(s_mat->xscal, scl[RT_X] * isc[map[RT_X]]);
+        RT_SIMD_SET(s_mat->yscal, scl[RT_Y] * isc[map[RT_Y]]);
 
-    RT_SIMD_SET(s_mat->xoffs, pos[map[RT_X]] * asc[map[RT_X]]);
-    RT_SIMD_SET(s_mat->yoffs, pos[map[RT_Y]] * asc[map[RT_Y]]);
+        RT_SIMD_SET(s_mat->xoffs, pos[map[RT_X]] * asc[map[RT_X]]);
+        RT_SIMD_SET(s_mat->yoffs, pos[map[RT_Y]] * asc[map[RT_Y]]);
+    }
 
-    map = inner->map;
-    scl = inner->scl;
-    pos = inner->sd->pos;
-    s_mat = inner->s_mat;
+    if (inner->share == 0)
+    {
+        map = inner->map;
+        scl = inner->scl;
+        pos = inner->sd->pos;
+        s_mat = inner->s_mat;
 
-    RT_SIMD_SET(s_mat->xscal, scl[RT_X] * isc[map[RT_X]]);
-    RT_SIMD_SET(s_mat->yscal, scl[RT_Y] * isc[map[RT_Y]]);
+        RT_SIMD_SET(s_mat->xscal, scl[RT_X] * isc[map[RT_X]]);
+        RT_SIMD_SET(s_mat->yscal, scl[RT_Y] * isc[map[RT_Y]]);
 
-    RT_SIMD_SET(s_mat->xoffs, pos[map[RT_X]] * asc[map[RT_X]]);
-    RT_SIMD_SET(s_mat->yoffs, pos[map[RT_Y]] * asc[map[RT_Y]]);
+        RT_SIMD_SET(s_mat->xoffs, pos[map[RT_X]] * asc[map[RT_X]]);
+        RT_SIMD_SET(s_mat->yoffs, pos[map[RT_Y]] * asc[map[RT_Y]]);
+    }
 
     /* set surface shape */
 
@@ -4024,6 +4345,13 @@ rt_Material::rt_Material(rt_Registry *rg, rt_SIDE *sd, rt_MATERIAL *mat) :
     this->sd  = sd;
     this->mat = mat;
 
+    /* set by node if shared */
+    share = 0;
+    hnext = RT_NULL;
+
+    /* set on first swap */
+    t_mat = RT_NULL;
+
     rt_TEX *tx = &mat->tex;
     otx.x_dim = otx.y_dim = -1;
 
@@ -4126,7 +4454,13 @@ rt_Material::rt_Material(rt_Registry *rg, rt_SIDE *sd, rt_MATERIAL *mat) :
     RT_SIMD_SET(s_mat->yshft, 0);
     s_mat->yshft[0] = x_lg2;
 
+    /* mip chain (if any) is attached later in build_mips */
     s_mat->tex_p[0] = tx->ptex;
+
+    RT_SIMD_SET(s_mat->m_max, (rt_real)1);
+    RT_SIMD_SET(s_mat->m_shf, x_lg2);
+    RT_SIMD_SET(s_mat->m_ofs, tx->x_dim * tx->y_dim * 4);
+    RT_SIMD_SET(s_mat->m_inv, (rt_elem)(~(rt_uelm)0 / 3 * 2 + 1));
     RT_SIMD_SET(s_mat->gpc10, (rt_real)RT_PI);
     RT_SIMD_SET(s_mat->clamp, (rt_real)255);
     RT_SIMD_SET(s_mat->cmask, (rt_elem)255);
@@ -4216,6 +4550,168 @@ rt_void rt_Material::resolve_texture(rt_Registry *rg)
     }
 
 #endif /* (RT_POINTER - RT_ADDRESS) */
+
+    mip = RT_NULL;
+    mip_num = 0;
+}
+
+/*
+ * Build texture's mip chain for filtered fetch (if not yet built)
+ * and attach it to material's SIMD fields, must be called outside
+ * of per-frame memory pool as the chain persists across frames.
+ * Return number of halved levels in the chain (0 if none).
+ */
+rt_si32 rt_Material::build_mips(rt_Registry *rg)
+{
+    rt_TEX *tx = &mat->tex;
+
+    if (mip != RT_NULL)
+    {
+        return mip_num;
+    }
+
+    rt_si32 x_dim = tx->x_dim;
+    rt_si32 y_dim = tx->y_dim;
+
+    /* number of levels while both dimensions can be halved,
+     * as backend's per-level wrapping relies on that */
+    while (x_dim > 1 && y_dim > 1)
+    {
+        x_dim >>= 1;
+        y_dim >>= 1;
+        mip_num++;
+    }
+
+    if (mip_num == 0)
+    {
+        return 0;
+    }
+
+    /* traverse list of materials (slow, implement hashmap later)
+     * and check if mip chain already exists for the same texture */
+    rt_Material *mtl;
+
+    for (mtl = rg->get_mat(); mtl != RT_NULL; mtl = mtl->next)
+    {
+        rt_TEX *tm = &mtl->mat->tex;
+
+        if (mtl != this && mtl->mip != RT_NULL && tm->ptex == tx->ptex
+        &&  tm->x_dim == tx->x_dim && tm->y_dim == tx->y_dim)
+        {
+            mip = mtl->mip;
+            mip_num = mtl->mip_num;
+            break;
+        }
+    }
+
+    if (mip == RT_NULL)
+    {
+        mip = make_mips(rg);
+    }
+
+    /* level 0 of the mip chain replaces
+     * original texture, other levels follow it */
+    s_mat->tex_p[0] = mip;
+
+    RT_SIMD_SET(s_mat->m_max, (rt_real)(1 << (mip_num * 2)));
+
+    return mip_num;
+}
+
+/*
+ * Swap SIMD struct with its twin (pipelined mode), the one swapped out
+ * is still being rendered, the other one takes over its contents
+ * to be updated for the next frame.
+ */
+rt_void rt_Material::swap_simd(rt_Registry *rg)
+{
+    rt_SIMD_MATERIAL *s_tmp = s_mat;
+
+    if (t_mat == RT_NULL)
+    {
+        t_mat = (rt_SIMD_MATERIAL *)
+                rg->alloc(sizeof(rt_SIMD_MATERIAL), RT_SIMD_ALIGN);
+    }
+
+    s_mat = t_mat;
+    t_mat = s_tmp;
+
+    memcpy(s_mat, t_mat, sizeof(rt_SIMD_MATERIAL));
+}
+
+/*
+ * Allocate and fill texture's mip chain of "mip_num" halved levels.
+ */
+rt_ui32* rt_Material::make_mips(rt_Registry *rg)
+{
+    rt_TEX *tx = &mat->tex;
+    rt_si32 x_dim, y_dim;
+
+    /* build mip chain in a single block, level k starts
+     * at (4 * n - (4 * n >> 2 * k)) / 3 texels */
+    rt_si32 n = tx->x_dim * tx->y_dim;
+    rt_si32 size = (4 * n - (n >> (2 * mip_num))) / 3 * 4;
+
+    rt_ui32 *chn = (rt_ui32 *)rg->alloc(size, RT_ALIGN);
+
+#if (RT_POINTER - RT_ADDRESS) != 0
+
+    if ((rt_full)chn >= (rt_full)(0x80000000 - size))
+    {
+        throw rt_Exception("address exceeded allowed range in material");
+    }
+
+#endif /* (RT_POINTER - RT_ADDRESS) */
+
+    memcpy(chn, tx->ptex, n * 4);
+
+    /* average 2x2 texels per channel, color channels
+     * in linear colorspace if gamma conversion is on */
+    rt_bool lin = (rg->opts & RT_OPTS_GAMMA) == 0;
+
+    rt_ui32 *src = chn, *dst = chn + n;
+    rt_si32 i, j, k, c;
+
+    x_dim = tx->x_dim;
+    y_dim = tx->y_dim;
+
+    for (k = 0; k < mip_num; k++)
+    {
+        x_dim >>= 1;
+        y_dim >>= 1;
+
+        for (i = 0; i < y_dim; i++)
+        {
+            rt_ui32 *row0 = src + (i * 2 + 0) * x_dim * 2;
+            rt_ui32 *row1 = src + (i * 2 + 1) * x_dim * 2;
+
+            for (j = 0; j < x_dim; j++)
+            {
+                rt_ui32 texel = 0;
+
+                for (c = 0; c < 32; c += 8)
+                {
+                    rt_real v0 = (rt_real)((row0[j * 2 + 0] >> c) & 0xFF);
+                    rt_real v1 = (rt_real)((row0[j * 2 + 1] >> c) & 0xFF);
+                    rt_real v2 = (rt_real)((row1[j * 2 + 0] >> c) & 0xFF);
+                    rt_real v3 = (rt_real)((row1[j * 2 + 1] >> c) & 0xFF);
+
+                    rt_real v = lin && c < 24 ?
+                        RT_SQRT((v0 * v0 + v1 * v1 + v2 * v2 + v3 * v3) / 4) :
+                                (v0 + v1 + v2 + v3) / 4;
+
+                    texel |= ((rt_ui32)(v + 0.5f) & 0xFF) << c;
+                }
+
+                dst[i * x_dim + j] = texel;
+            }
+        }
+
+        src = dst;
+        dst += x_dim * y_dim;
+    }
+
+    return chn;
 }
 
 /*
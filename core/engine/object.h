@@ -31,6 +31,8 @@
 #define RT_EDGES_LIMIT          12 /* maximum number of edges for bbox */
 #define RT_FACES_LIMIT          6  /* maximum number of faces for bbox */
 
+#define RT_MAT_BITS             8  /* log2 of shared materials' hash-table */
+
 /*
  * Floating point thresholds,
  * values have been roughly selected for single-precision,
@@ -146,6 +148,11 @@ class rt_Registry : public rt_Heap
      * for clippers accum segments */
     rt_ELEM            *rel;
 
+    /* hash-table of materials shared by nodes
+     * with the same side and material data,
+     * allocated with the first node's material */
+    rt_Material       **mht;
+
 /*  methods */
 
     public:
@@ -158,7 +165,7 @@ class rt_Registry : public rt_Heap
                     srf_head(RT_NULL), srf_num(0),
                     tex_head(RT_NULL), tex_num(0),
                     mat_head(RT_NULL), mat_num(0),
-                    opts(RT_OPTS_FULL), rel(RT_NULL) { }
+                    opts(RT_OPTS_FULL), rel(RT_NULL), mht(RT_NULL) { }
 
     virtual
    ~rt_Registry() { }
@@ -295,6 +302,8 @@ class rt_Object
                           rt_Object *trnode, rt_mat4 mtx);
     virtual
     rt_void update_fields();
+
+    rt_void update_anim(rt_time time);
 };
 
 /******************************************************************************/
@@ -364,6 +373,11 @@ class rt_Light : public rt_Object, public rt_List<rt_Light>
 
     rt_SIMD_LIGHT      *s_lgt;
 
+    /* light SIMD struct's twin,
+     * updated while the other renders
+     * (pipelined mode), allocated on first swap */
+    rt_SIMD_LIGHT      *t_lgt;
+
 /*  methods */
 
     public:
@@ -378,6 +392,8 @@ class rt_Light : public rt_Object, public rt_List<rt_Light>
                           rt_Object *trnode, rt_mat4 mtx);
     virtual
     rt_void update_fields();
+
+    rt_void swap_simd(rt_bool copy);
 };
 
 /******************************************************************************/
@@ -405,6 +421,12 @@ class rt_Node : public rt_Object
     /* surface SIMD struct,
      * used for trnode if present */
     rt_SIMD_SURFACE    *s_srf;
+    rt_si32             s_size;
+
+    /* surface SIMD struct's twin,
+     * updated while the other renders
+     * (pipelined mode), allocated on first swap */
+    rt_SIMD_SURFACE    *t_srf;
 
 /*  methods */
 
@@ -416,6 +438,8 @@ class rt_Node : public rt_Object
 
     rt_void update_bbgeom(rt_BOUND *box);
 
+    rt_Material *get_material(rt_SIDE *sd, rt_MATERIAL *mat);
+
     rt_Node(rt_Registry *rg, rt_Object *parent, rt_OBJECT *obj,
             rt_si32 ssize);
 
@@ -434,6 +458,11 @@ class rt_Node : public rt_Object
                           rt_Object *trnode, rt_mat4 mtx);
     virtual
     rt_void update_fields();
+
+    virtual
+    rt_void swap_simd(rt_bool copy);
+    virtual
+    rt_void link_simd();
 };
 
 /******************************************************************************/
@@ -465,6 +494,31 @@ class rt_Array : public rt_Node, public rt_List<rt_Array>
      * some of its sub-objects changed */
     rt_si32             arr_changed;
 
+    /* transform flags and changed status
+     * passed from array to its sub-objects */
+    rt_si32             sub_flags;
+
+    /* array's depth in the hierarchy and
+     * minimum depth of arrays receiving bounds
+     * from array's sub-objects (recursive),
+     * if not less than array's own depth
+     * array's bounds can be updated as
+     * a separate subtree task in parallel */
+    rt_si32             arr_depth;
+    rt_si32             bnd_depth;
+
+    /* non-zero if array's bounds were
+     * updated by a subtree task already */
+    rt_si32             bnd_task;
+
+    /* boxes with non-zero radius (trbox - 1,
+     * bvbox - 2) in surfaces' node lists */
+    rt_si32             bnd_node;
+
+    /* non-zero if array's bvnode was
+     * selected by the engine (not in scene data) */
+    rt_si32             bnd_auto;
+
     /* cumulative luminosity
      * of all lights in array */
     rt_COL              col;
@@ -489,6 +543,11 @@ class rt_Array : public rt_Node, public rt_List<rt_Array>
      * used for bvbox part of bvnode */
     rt_SIMD_SURFACE    *s_bvb;
 
+    /* twins of SIMD structs for
+     * inbox and bvbox parts of bvnode */
+    rt_SIMD_SURFACE    *t_inb;
+    rt_SIMD_SURFACE    *t_bvb;
+
 /*  methods */
 
     protected:
@@ -516,7 +575,17 @@ class rt_Array : public rt_Node, public rt_List<rt_Array>
     virtual
     rt_void update_fields();
 
+    virtual
+    rt_void swap_simd(rt_bool copy);
+    virtual
+    rt_void link_simd();
+
     rt_void update_bounds();
+
+    rt_void update_array(rt_time time, rt_si32 flags,
+                         rt_Object *trnode, rt_mat4 mtx);
+    rt_void update_subobj(rt_time time, rt_Object *sub, rt_bool deep);
+    rt_void update_depth();
 };
 
 /******************************************************************************/
@@ -534,12 +603,12 @@ class rt_Surface : public rt_Node, public rt_List<rt_Surface>
 
     rt_SURFACE         *srf;
 
+    public:
+
     /* non-zero if surface itself or
      * some of its clippers changed */
     rt_si32             srf_changed;
 
-    public:
-
     /* top of the trnode/bvnode
      * sequence on the branch */
     rt_ELEM            *top;
@@ -552,6 +621,19 @@ class rt_Surface : public rt_Node, public rt_List<rt_Surface>
      * bounding box and volume */
     rt_SHAPE           *shape;
 
+    /* time (in us) spent on surface in
+     * update phases 2 and 3, measured in
+     * one frame (double-buffered) and used
+     * for work partition in the next one */
+    rt_time             srf_cost[2][2];
+
+    /* non-zero if surface's pixels may differ
+     * from the last rendered frame (dirty tiles),
+     * its bounding sphere in the last update */
+    rt_si32             srf_dirty;
+    rt_vec4             dmid;
+    rt_real             drad;
+
 /*  methods */
 
     protected:
@@ -590,6 +672,11 @@ class rt_Surface : public rt_Node, public rt_List<rt_Surface>
     virtual
     rt_void update_fields();
 
+    virtual
+    rt_void swap_simd(rt_bool copy);
+    virtual
+    rt_void link_simd();
+
     rt_void update_bounds();
 };
 
@@ -992,7 +1079,6 @@ class rt_Material : public rt_List<rt_Material>
 
     private:
 
-    rt_MATERIAL        *mat;
     /* original texture data */
     rt_TEX              otx;
 
@@ -1000,6 +1086,7 @@ class rt_Material : public rt_List<rt_Material>
 
     public:
 
+    rt_MATERIAL        *mat;
     rt_SIDE            *sd;
 
     rt_si32             map[2];
@@ -1008,6 +1095,25 @@ class rt_Material : public rt_List<rt_Material>
     rt_SIMD_MATERIAL   *s_mat;
     rt_si32             props;
 
+    /* material SIMD struct's twin,
+     * updated while the other renders
+     * (pipelined mode), allocated on first swap */
+    rt_SIMD_MATERIAL   *t_mat;
+
+    /* texture's mip chain, level 0 copy followed
+     * by levels of halved dimensions (if any),
+     * only built once texture filtering is on */
+    rt_ui32            *mip;
+    rt_si32             mip_num;
+
+    /* non-zero if material can be shared
+     * by all nodes with the same side and
+     * material data (instances of a subtree) */
+    rt_si32             share;
+    /* next shared material in the same
+     * slot of registry's hash-table */
+    rt_Material        *hnext;
+
 /*  methods */
 
     public:
@@ -1021,6 +1127,13 @@ class rt_Material : public rt_List<rt_Material>
    ~rt_Material();
 
     rt_void resolve_texture(rt_Registry *rg);
+    rt_si32 build_mips(rt_Registry *rg);
+
+    rt_void swap_simd(rt_Registry *rg);
+
+    private:
+
+    rt_ui32 *make_mips(rt_Registry *rg);
 };
 
 #endif /* RT_OBJECT_H */
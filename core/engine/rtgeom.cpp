@@ -1228,6 +1228,25 @@ rt_si32 bbox_conv(rt_BOUND *obj, rt_real *pos)
     return 0;
 }
 
+/*
+ * Compute the cone "cn" of "nd's" bounding sphere
+ * as seen from "obj's" bbox "mid".
+ */
+rt_void bbox_cone(rt_BOUND *obj, rt_BOUND *nd, rt_VCONE *cn)
+{
+    rt_real *pps = obj->mid;
+
+    RT_VEC3_SUB(cn->vec, nd->mid, pps);
+    cn->len = RT_VEC3_LEN(cn->vec);
+
+    cn->sin = cn->len >= nd->rad && cn->len > RT_CULL_THRESHOLD ?
+                        nd->rad / cn->len : 0.0f;
+    cn->cos = RT_SQRT(1.0f - cn->sin * cn->sin);
+
+    cn->ang = cn->len >= nd->rad && cn->len > RT_CULL_THRESHOLD ?
+                        RT_ASIN(cn->sin) : (rt_real)RT_2_PI;
+}
+
 /*
  * Determine the order of "nd1's" and "nd2's" bboxes
  * as seen from "obj's" bbox "mid".
@@ -1241,7 +1260,8 @@ rt_si32 bbox_conv(rt_BOUND *obj, rt_real *pos)
  * 8|1 - no swap, unsortable
  * 8|2 - do swap, unsortable
  */
-rt_si32 bbox_sort(rt_BOUND *obj, rt_BOUND *nd1, rt_BOUND *nd2)
+rt_si32 bbox_sort(rt_BOUND *obj, rt_BOUND *nd1, rt_BOUND *nd2,
+                  rt_VCONE *cn1, rt_VCONE *cn2)
 {
     /* check if nodes differ and have bounds */
     if (nd1->rad == RT_INF || nd2->rad == RT_INF || nd1 == nd2)
@@ -1489,28 +1509,43 @@ rt_si32 bbox_sort(rt_BOUND *obj, rt_BOUND *nd1, rt_BOUND *nd2)
     while (0);
 #endif /* RT_OPTS_INSERT_EXT2 */
 
-    /* check if cones from bounding spheres don't intersect */
-    rt_vec4 nd1_vec;
-    RT_VEC3_SUB(nd1_vec, nd1->mid, pps);
-    rt_real nd1_len = RT_VEC3_LEN(nd1_vec);
+    /* check if cones from bounding spheres don't intersect,
+     * compute cones here if they were not cached by the caller */
+    rt_VCONE nd1_cone, nd2_cone;
 
-    rt_vec4 nd2_vec;
-    RT_VEC3_SUB(nd2_vec, nd2->mid, pps);
-    rt_real nd2_len = RT_VEC3_LEN(nd2_vec);
+    if (cn1 == RT_NULL)
+    {
+        cn1 = &nd1_cone;
+        bbox_cone(obj, nd1, cn1);
+    }
+    if (cn2 == RT_NULL)
+    {
+        cn2 = &nd2_cone;
+        bbox_cone(obj, nd2, cn2);
+    }
 
-    rt_real dff_ang = RT_VEC3_DOT(nd1_vec, nd2_vec);
+    rt_real nd1_len = cn1->len;
+    rt_real nd2_len = cn2->len;
 
-    dff_ang = nd1_len <= RT_CULL_THRESHOLD ? 0.0f : dff_ang / nd1_len;
-    rt_real nd1_ang = nd1_len >= nd1->rad && nd1_len > RT_CULL_THRESHOLD ?
-                        RT_ASIN(nd1->rad / nd1_len) : (rt_real)RT_2_PI;
+    rt_real dff_ang = RT_VEC3_DOT(cn1->vec, cn2->vec);
 
+    dff_ang = nd1_len <= RT_CULL_THRESHOLD ? 0.0f : dff_ang / nd1_len;
     dff_ang = nd2_len <= RT_CULL_THRESHOLD ? 0.0f : dff_ang / nd2_len;
-    rt_real nd2_ang = nd2_len >= nd2->rad && nd2_len > RT_CULL_THRESHOLD ?
-                        RT_ASIN(nd2->rad / nd2_len) : (rt_real)RT_2_PI;
 
-    dff_ang = RT_ACOS(dff_ang);
+    /* compare cosines first (no "acos" call), fall back to
+     * comparing angles only if cosines are within the threshold */
+    rt_real sum_ang = cn1->ang + cn2->ang;
+    rt_real sum_cos = cn1->cos * cn2->cos - cn1->sin * cn2->sin;
 
-    if (nd1_ang + nd2_ang < dff_ang)
+    if (sum_ang < (rt_real)RT_PI
+    &&  dff_ang < sum_cos - RT_CULL_THRESHOLD)
+    {
+        return 3;
+    }
+
+    if (sum_ang < (rt_real)RT_PI
+    &&  dff_ang <= sum_cos + RT_CULL_THRESHOLD
+    &&  sum_ang < RT_ACOS(dff_ang))
     {
         return 3;
     }
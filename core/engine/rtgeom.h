@@ -40,6 +40,7 @@ struct rt_FACE;
 
 struct rt_BOUND;
 struct rt_SHAPE;
+struct rt_VCONE;
 
 /******************************************************************************/
 /*********************************   VECTORS   ********************************/
@@ -296,6 +297,9 @@ struct rt_BOUND
     rt_si32             flm;
     /* in faces index format as defined in bx_faces: 1 << face_index */
     rt_si32             flf;
+
+    /* node's index in its gridded run of scene's hierarchical list */
+    rt_si32             idx;
 };
 
 /*
@@ -318,6 +322,29 @@ struct rt_SHAPE : public rt_BOUND
     rt_pntr            *ptr;
 };
 
+/*
+ * View-cone structure represents node's bounding sphere
+ * as seen from "obj's" bbox "mid", it is computed once per node
+ * and reused across "bbox_sort" calls for the same "obj".
+ */
+struct rt_VCONE
+{
+    /* node's and "obj's" bounds the cone is computed for */
+    rt_BOUND           *nd;
+    rt_BOUND           *ob;
+    /* sorting pass the cone belongs to */
+    rt_si32             tag;
+
+    /* vector from "obj's" "mid" to node's "mid" */
+    rt_vec4             vec;
+    /* vector's length */
+    rt_real             len;
+    /* cone's half-angle, its sine and cosine */
+    rt_real             ang;
+    rt_real             sin;
+    rt_real             cos;
+};
+
 /*
  * Determine if "nd1's" bbox casts shadow on "nd2's" bbox
  * as seen from "obj's" bbox "mid" (light's "pos").
@@ -336,6 +363,12 @@ rt_si32 bbox_shad(rt_BOUND *obj, rt_BOUND *nd1, rt_BOUND *nd2);
  */
 rt_si32 bbox_flag(rt_si32 *map, rt_si32 flm);
 
+/*
+ * Compute the cone "cn" of "nd's" bounding sphere
+ * as seen from "obj's" bbox "mid".
+ */
+rt_void bbox_cone(rt_BOUND *obj, rt_BOUND *nd, rt_VCONE *cn);
+
 /*
  * Determine the order of "nd1's" and "nd2's" bboxes
  * as seen from "obj's" bbox "mid".
@@ -348,8 +381,12 @@ rt_si32 bbox_flag(rt_si32 *map, rt_si32 flm);
  * 4|2 - do swap, remove (nd2 fully obscures nd1)
  * 8|1 - no swap, unsortable
  * 8|2 - do swap, unsortable
+ *
+ * Cones "cn1" and "cn2" (if not NULL) must be computed by "bbox_cone"
+ * for "nd1" and "nd2" respectively as seen from the same "obj".
  */
-rt_si32 bbox_sort(rt_BOUND *obj, rt_BOUND *nd1, rt_BOUND *nd2);
+rt_si32 bbox_sort(rt_BOUND *obj, rt_BOUND *nd1, rt_BOUND *nd2,
+                  rt_VCONE *cn1 = RT_NULL, rt_VCONE *cn2 = RT_NULL);
 
 /*
  * Determine which side of clipped "srf" is seen
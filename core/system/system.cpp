@@ -18,7 +18,8 @@
  * system.cpp: Implementation of the system layer.
  *
  * System layer of the engine responsible for file I/O operations,
- * fast linear memory heap allocations, error and info logging
+ * fast linear memory heap allocations, error and info logging,
+ * atomic counters and timing for threads
  * as well as definitions of List template and Exception classes.
  */
 
@@ -153,6 +154,8 @@ rt_Heap::rt_Heap(rt_FUNC_ALLOC f_alloc, rt_FUNC_FREE f_free)
     /* init heap */
     head = RT_NULL;
     obj_head = RT_NULL;
+    twin = RT_NULL;
+    node = -1;
     chunk_alloc(0, RT_ALIGN);
 }
 
@@ -174,6 +177,13 @@ rt_void rt_Heap::chunk_alloc(rt_size size, rt_ui32 align)
         throw rt_Exception("out of memory in heap's chunk_alloc");
     }
 
+    /* place chunk's pages on heap's node
+     * before they are touched for the first time */
+    if (node >= 0)
+    {
+        numa_bind(chunk, real_size, node);
+    }
+
     /* prepare new chunk */
     chunk->ptr = (rt_byte *)chunk + sizeof(rt_CHUNK);
     chunk->ptr = (rt_byte *)(((rt_size)chunk->ptr + mask) & ~mask);
@@ -284,6 +294,24 @@ rt_pntr rt_Heap::release(rt_pntr ptr)
     return RT_NULL;
 }
 
+/*
+ * Swap current chain of chunks with the twin one (allocated on first swap),
+ * so that allocs made in either chain can be released independently
+ * while the other chain's allocs are still in use.
+ */
+rt_void rt_Heap::swap()
+{
+    rt_CHUNK *chunk = head;
+
+    head = twin;
+    twin = chunk;
+
+    if (head == RT_NULL)
+    {
+        chunk_alloc(0, RT_ALIGN);
+    }
+}
+
 /*
  * Allocate given "size" bytes of memory with given "align",
  * search the list of free objects, move heap pointer otherwise.
@@ -353,6 +381,32 @@ rt_pntr rt_Heap::obj_free(rt_pntr ptr)
     return RT_NULL;
 }
 
+/*
+ * Set NUMA "node" for heap's pages (< 0 - first-touch placement),
+ * chunks allocated so far are migrated, new chunks are placed on the node.
+ */
+rt_void rt_Heap::set_node(rt_si32 node)
+{
+    rt_CHUNK *chunk;
+
+    this->node = node;
+
+    if (node < 0)
+    {
+        return;
+    }
+
+    for (chunk = head; chunk != RT_NULL; chunk = chunk->next)
+    {
+        numa_bind(chunk, chunk->size, node);
+    }
+
+    for (chunk = twin; chunk != RT_NULL; chunk = chunk->next)
+    {
+        numa_bind(chunk, chunk->size, node);
+    }
+}
+
 /*
  * Deinitialize heap.
  */
@@ -372,6 +426,955 @@ rt_Heap::~rt_Heap()
         f_free(head, head->size);
         head = chunk;
     }
+
+    /* free all chunks from the twin list */
+    while (twin != RT_NULL)
+    {
+        rt_CHUNK *chunk = twin->next;
+        f_free(twin, twin->size);
+        twin = chunk;
+    }
+}
+
+/******************************************************************************/
+/********************************   THREADING   *******************************/
+/******************************************************************************/
+
+#if (defined RT_WIN32) || (defined RT_WIN64) /* Win32, MSVC -- Win64, GCC --- */
+
+#include <windows.h>
+
+/* WaitOnAddress is only available since Windows 8,
+ * older targets and SDKs fall back to a yield loop */
+#if (defined _WIN32_WINNT) && (_WIN32_WINNT >= 0x0602)
+#define RT_WAIT_ON_ADDRESS  1
+#if (defined _MSC_VER)
+#pragma comment(lib, "synchronization.lib")
+#endif /* _MSC_VER */
+#else  /* _WIN32_WINNT < 0x0602 */
+#define RT_WAIT_ON_ADDRESS  0
+#endif /* _WIN32_WINNT < 0x0602 */
+
+/*
+ * Atomically add "val" to the integer at "ptr" and return its previous value.
+ */
+rt_si32 atomic_add(volatile rt_si32 *ptr, rt_si32 val)
+{
+    return (rt_si32)InterlockedExchangeAdd((volatile LONG *)ptr, (LONG)val);
+}
+
+/*
+ * Atomically add "val" to the 64-bit integer at "ptr"
+ * and return its previous value.
+ */
+rt_si64 atomic_add64(volatile rt_si64 *ptr, rt_si64 val)
+{
+    return (rt_si64)InterlockedExchangeAdd64((volatile LONGLONG *)ptr,
+                                             (LONGLONG)val);
+}
+
+/*
+ * Get system time in microseconds.
+ */
+rt_time get_usec()
+{
+    LARGE_INTEGER fr;
+    QueryPerformanceFrequency(&fr);
+    LARGE_INTEGER tm;
+    QueryPerformanceCounter(&tm);
+    return (rt_time)(tm.QuadPart * 1000000 / fr.QuadPart);
+}
+
+/*
+ * Hint the CPU inside of a spin-wait loop.
+ */
+static
+rt_void spin_pause()
+{
+    YieldProcessor();
+}
+
+/*
+ * Sleep while the value at "ptr" is equal to "val".
+ * Without WaitOnAddress the thread doesn't block,
+ * but gives up the rest of the time-slice instead,
+ * thus the sleep phase of the barrier is a yield loop.
+ */
+static
+rt_void sleep_wait(volatile rt_si32 *ptr, rt_si32 val)
+{
+#if RT_WAIT_ON_ADDRESS
+    WaitOnAddress(ptr, &val, sizeof(rt_si32), INFINITE);
+#else /* RT_WAIT_ON_ADDRESS */
+    if (*ptr == val)
+    {
+        SwitchToThread();
+    }
+#endif /* RT_WAIT_ON_ADDRESS */
+}
+
+/*
+ * Wake all threads sleeping at barrier.
+ */
+static
+rt_void sleep_wake(volatile rt_si32 *ptr)
+{
+#if RT_WAIT_ON_ADDRESS
+    WakeByAddressAll((rt_pntr)ptr);
+#endif /* RT_WAIT_ON_ADDRESS */
+}
+
+/*
+ * Get number of online CPUs.
+ */
+static
+rt_si32 cpu_count()
+{
+    SYSTEM_INFO sys;
+    GetSystemInfo(&sys);
+    return (rt_si32)sys.dwNumberOfProcessors;
+}
+
+/*
+ * Fill "cpu_node" with node index of each of the first "cpu_max" CPUs
+ * (within the current processor group), return max node index + 1
+ * or 0 if topology is not available.
+ */
+static
+rt_si32 node_scan(rt_si32 *cpu_node, rt_si32 cpu_max)
+{
+    ULONG n, nmax = 0;
+    ULONGLONG mask;
+    rt_si32 i, num = 0;
+
+    if (!GetNumaHighestNodeNumber(&nmax))
+    {
+        return 0;
+    }
+
+    for (n = 0; n <= nmax && n < RT_NUMA_MAX; n++)
+    {
+        if (!GetNumaNodeProcessorMask((UCHAR)n, &mask))
+        {
+            continue;
+        }
+
+        for (i = 0; i < cpu_max && i < 64; i++)
+        {
+            if ((mask >> i) & 1)
+            {
+                cpu_node[i] = (rt_si32)n;
+                num = RT_MAX(num, (rt_si32)n + 1);
+            }
+        }
+    }
+
+    return num;
+}
+
+/*
+ * Set preferred NUMA "node" for pages of given memory range.
+ * Placement is left to the OS's first-touch policy on Windows.
+ */
+rt_void numa_bind(rt_pntr ptr, rt_size size, rt_si32 node)
+{
+
+}
+
+/*
+ * Pin the calling thread to given "cpu".
+ */
+rt_void cpu_bind(rt_si32 cpu)
+{
+    if (cpu >= 0 && cpu < (rt_si32)(sizeof(DWORD_PTR) * 8))
+    {
+        SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu);
+    }
+}
+
+/*
+ * Mark CPUs not allowed for the process with -1 in "cpu_node".
+ */
+static
+rt_void cpu_allowed(rt_si32 *cpu_node, rt_si32 cpu_max)
+{
+    DWORD_PTR pam, sam;
+    rt_si32 i;
+
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &pam, &sam))
+    {
+        return;
+    }
+
+    for (i = 0; i < cpu_max; i++)
+    {
+        if (i >= (rt_si32)(sizeof(DWORD_PTR) * 8) || (pam >> i & 1) == 0)
+        {
+            cpu_node[i] = -1;
+        }
+    }
+}
+
+/*
+ * Thread's entry point and its argument.
+ */
+struct rt_THREAD_START
+{
+    rt_pntr           (*func)(rt_pntr);
+    rt_pntr             arg;
+};
+
+static
+DWORD WINAPI thread_entry(LPVOID p)
+{
+    rt_THREAD_START start = *(rt_THREAD_START *)p;
+    free(p);
+    start.func(start.arg);
+    return 0;
+}
+
+/*
+ * Start system thread running "func" with given "arg".
+ */
+static
+rt_pntr thread_start(rt_pntr (*func)(rt_pntr), rt_pntr arg)
+{
+    rt_THREAD_START *start = (rt_THREAD_START *)
+                                malloc(sizeof(rt_THREAD_START));
+    HANDLE thr = RT_NULL;
+
+    if (start != RT_NULL)
+    {
+        start->func = func;
+        start->arg = arg;
+        thr = CreateThread(NULL, 0, thread_entry, start, 0, NULL);
+    }
+
+    if (thr == RT_NULL)
+    {
+        free(start);
+        throw rt_Exception("failed to start thread in thread-pool");
+    }
+
+    return thr;
+}
+
+/*
+ * Wait for system thread to finish and release its handle.
+ */
+static
+rt_void thread_join(rt_pntr thr)
+{
+    WaitForSingleObject((HANDLE)thr, INFINITE);
+    CloseHandle((HANDLE)thr);
+}
+
+/*
+ * Pin system thread to given "cpu".
+ */
+static
+rt_void thread_pin(rt_pntr thr, rt_si32 cpu)
+{
+    if (cpu >= 0 && cpu < (rt_si32)(sizeof(DWORD_PTR) * 8))
+    {
+        SetThreadAffinityMask((HANDLE)thr, (DWORD_PTR)1 << cpu);
+    }
+}
+
+#else /* --- Linux, GCC ----------------------------------------------------- */
+
+#include <sys/time.h>
+#include <sched.h>
+
+#include <unistd.h>
+#include <string.h>
+#include <pthread.h>
+
+#if (defined __linux__)
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <dirent.h>
+#include <fcntl.h>
+#endif /* __linux__ */
+
+/*
+ * Atomically add "val" to the integer at "ptr" and return its previous value.
+ */
+rt_si32 atomic_add(volatile rt_si32 *ptr, rt_si32 val)
+{
+    return __sync_fetch_and_add(ptr, val);
+}
+
+/*
+ * Atomically add "val" to the 64-bit integer at "ptr"
+ * and return its previous value.
+ */
+rt_si64 atomic_add64(volatile rt_si64 *ptr, rt_si64 val)
+{
+    return __sync_fetch_and_add(ptr, val);
+}
+
+/*
+ * Get system time in microseconds.
+ */
+rt_time get_usec()
+{
+    timeval tm;
+    gettimeofday(&tm, NULL);
+    return (rt_time)tm.tv_sec * 1000000 + tm.tv_usec;
+}
+
+/*
+ * Hint the CPU inside of a spin-wait loop.
+ */
+static
+rt_void spin_pause()
+{
+#if (defined __i386__) || (defined __x86_64__)
+    __asm__ __volatile__ ("pause" ::: "memory");
+#else /* other targets */
+    __asm__ __volatile__ ("" ::: "memory");
+#endif /* other targets */
+}
+
+/*
+ * Sleep while the value at "ptr" is equal to "val".
+ */
+static
+rt_void sleep_wait(volatile rt_si32 *ptr, rt_si32 val)
+{
+#if (defined __linux__)
+    syscall(SYS_futex, (rt_si32 *)ptr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+#else /* no futex */
+    if (*ptr == val)
+    {
+        sched_yield();
+    }
+#endif /* no futex */
+}
+
+/*
+ * Wake all threads sleeping at barrier.
+ */
+static
+rt_void sleep_wake(volatile rt_si32 *ptr)
+{
+#if (defined __linux__)
+    syscall(SYS_futex, (rt_si32 *)ptr, FUTEX_WAKE_PRIVATE, 0x7FFFFFFF,
+                                                           NULL, NULL, 0);
+#endif /* __linux__ */
+}
+
+/*
+ * Get number of online CPUs.
+ */
+static
+rt_si32 cpu_count()
+{
+    return (rt_si32)sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+/*
+ * Fill "cpu_node" with node index of each of the first "cpu_max" CPUs
+ * from sysfs node directories, return max node index + 1
+ * or 0 if topology is not available.
+ */
+static
+rt_si32 node_scan(rt_si32 *cpu_node, rt_si32 cpu_max)
+{
+    rt_si32 num = 0;
+
+#if (defined __linux__)
+    DIR *dir = opendir("/sys/devices/system/node");
+    dirent *ent;
+
+    if (dir == NULL)
+    {
+        return 0;
+    }
+
+    while ((ent = readdir(dir)) != NULL)
+    {
+        rt_char path[128], buf[1024];
+        rt_si32 n, fd, len, i, a, b;
+
+        /* node directories are named "nodeN" */
+        if (strncmp(ent->d_name, "node", 4) != 0
+        ||  ent->d_name[4] < '0' || ent->d_name[4] > '9')
+        {
+            continue;
+        }
+
+        for (n = 0, i = 4; ent->d_name[i] >= '0' && ent->d_name[i] <= '9'; i++)
+        {
+            n = n * 10 + (ent->d_name[i] - '0');
+        }
+
+        if (n >= RT_NUMA_MAX || ent->d_name[i] != '\0')
+        {
+            continue;
+        }
+
+        strcpy(path, "/sys/devices/system/node/");
+        strcat(path, ent->d_name);
+        strcat(path, "/cpulist");
+
+        fd = open(path, O_RDONLY);
+
+        if (fd < 0)
+        {
+            continue;
+        }
+
+        len = (rt_si32)read(fd, buf, sizeof(buf) - 1);
+        close(fd);
+
+        if (len <= 0)
+        {
+            continue;
+        }
+
+        buf[len] = '\0';
+
+        /* parse cpulist in the form of "0-3,8,10-11" */
+        for (i = 0; buf[i] >= '0' && buf[i] <= '9'; )
+        {
+            for (a = 0; buf[i] >= '0' && buf[i] <= '9'; i++)
+            {
+                a = a * 10 + (buf[i] - '0');
+            }
+
+            b = a;
+
+            if (buf[i] == '-')
+            {
+                for (b = 0, i++; buf[i] >= '0' && buf[i] <= '9'; i++)
+                {
+                    b = b * 10 + (buf[i] - '0');
+                }
+            }
+
+            for (; a <= b && a < cpu_max; a++)
+            {
+                cpu_node[a] = n;
+            }
+
+            if (buf[i] == ',')
+            {
+                i++;
+            }
+        }
+
+        num = RT_MAX(num, n + 1);
+    }
+
+    closedir(dir);
+#endif /* __linux__ */
+
+    return num;
+}
+
+/*
+ * Set preferred NUMA "node" for pages of given memory range,
+ * pages already touched are migrated (mbind with MPOL_PREFERRED).
+ */
+rt_void numa_bind(rt_pntr ptr, rt_size size, rt_si32 node)
+{
+#if (defined __linux__)
+    const rt_si32 bits = 8 * sizeof(unsigned long);
+    unsigned long mask[RT_NUMA_MAX / bits + 1];
+    rt_size page = (rt_size)sysconf(_SC_PAGESIZE) - 1;
+    rt_size addr = (rt_size)ptr & ~page;
+    rt_size size_a = (((rt_size)ptr + size + page) & ~page) - addr;
+
+    if (node < 0 || node >= RT_NUMA_MAX || size == 0)
+    {
+        return;
+    }
+
+    memset(mask, 0, sizeof(mask));
+    mask[node / bits] = 1UL << (node % bits);
+
+    /* MPOL_PREFERRED = 1, MPOL_MF_MOVE = 2,
+     * constants are local to avoid dependency on libnuma headers */
+    syscall(SYS_mbind, addr, size_a, 1, mask, RT_NUMA_MAX + 1, 2);
+#endif /* __linux__ */
+}
+
+/*
+ * Pin the calling thread to given "cpu".
+ */
+rt_void cpu_bind(rt_si32 cpu)
+{
+#if (defined __linux__)
+    cpu_set_t cpuset;
+
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+    {
+        return;
+    }
+
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    sched_setaffinity(0, sizeof(cpu_set_t), &cpuset);
+#endif /* __linux__ */
+}
+
+/*
+ * Mark CPUs not allowed for the process with -1 in "cpu_node".
+ */
+static
+rt_void cpu_allowed(rt_si32 *cpu_node, rt_si32 cpu_max)
+{
+#if (defined __linux__)
+    cpu_set_t cpuset;
+    rt_si32 i;
+
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &cpuset) != 0)
+    {
+        return;
+    }
+
+    for (i = 0; i < cpu_max; i++)
+    {
+        if (i >= CPU_SETSIZE || !CPU_ISSET(i, &cpuset))
+        {
+            cpu_node[i] = -1;
+        }
+    }
+#endif /* __linux__ */
+}
+
+/*
+ * Start system thread running "func" with given "arg".
+ */
+static
+rt_pntr thread_start(rt_pntr (*func)(rt_pntr), rt_pntr arg)
+{
+    pthread_t *pthr = (pthread_t *)malloc(sizeof(pthread_t));
+
+    if (pthr == RT_NULL || pthread_create(pthr, NULL, func, arg) != 0)
+    {
+        free(pthr);
+        throw rt_Exception("failed to start thread in thread-pool");
+    }
+
+    return pthr;
+}
+
+/*
+ * Wait for system thread to finish and release its handle.
+ */
+static
+rt_void thread_join(rt_pntr thr)
+{
+    pthread_join(*(pthread_t *)thr, NULL);
+    free(thr);
+}
+
+/*
+ * Pin system thread to given "cpu".
+ */
+static
+rt_void thread_pin(rt_pntr thr, rt_si32 cpu)
+{
+#if (defined __linux__)
+    cpu_set_t cpuset;
+
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+    {
+        return;
+    }
+
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    pthread_setaffinity_np(*(pthread_t *)thr, sizeof(cpu_set_t), &cpuset);
+#endif /* __linux__ */
+}
+
+#endif /* ------------- OS specific ----------------------------------------- */
+
+/*
+ * Discover NUMA topology: fill "cpu_node" with node index of each of
+ * the first "cpu_max" CPUs (< 0 - not present), return number of nodes.
+ * If only one node exists and "sim" > 1, CPUs are split into "sim"
+ * contiguous simulated nodes.
+ */
+rt_si32 numa_nodes(rt_si32 *cpu_node, rt_si32 cpu_max, rt_si32 sim)
+{
+    rt_si32 i, j, num, cpus = 0;
+
+    for (i = 0; i < cpu_max; i++)
+    {
+        cpu_node[i] = -1;
+    }
+
+    num = node_scan(cpu_node, cpu_max);
+
+    /* no topology info, assume all online CPUs on node 0 */
+    if (num == 0)
+    {
+        for (i = 0; i < cpu_count() && i < cpu_max; i++)
+        {
+            cpu_node[i] = 0;
+        }
+
+        num = 1;
+    }
+
+    for (i = 0; i < cpu_max; i++)
+    {
+        cpus += cpu_node[i] >= 0 ? 1 : 0;
+    }
+
+    if (num == 1 && sim > 1 && cpus > 1)
+    {
+        num = RT_MIN(sim, cpus);
+
+        for (i = 0, j = 0; i < cpu_max; i++)
+        {
+            if (cpu_node[i] >= 0)
+            {
+                cpu_node[i] = (j++) * num / cpus;
+            }
+        }
+    }
+
+    return num;
+}
+
+/*
+ * Instantiate barrier for "thnum" threads.
+ */
+rt_Barrier::rt_Barrier(rt_si32 thnum, rt_si32 spins)
+{
+    this->thnum = thnum;
+    /* spinning only steals time-slices from
+     * the threads yet to arrive when CPUs are oversubscribed */
+    this->spins = thnum > cpu_count() ? 0 : spins;
+
+    count = thnum;
+    sense = 0;
+    asleep = 0;
+}
+
+/*
+ * Block until all "thnum" threads have arrived at the barrier.
+ */
+rt_void rt_Barrier::wait()
+{
+    rt_si32 s = sense, i;
+
+    /* last thread to arrive resets the counter and flips the sense */
+    if (atomic_add(&count, -1) == 1)
+    {
+        count = thnum;
+        atomic_add(&sense, 1);
+
+        if (asleep != 0)
+        {
+            sleep_wake(&sense);
+        }
+
+        return;
+    }
+
+    /* spin first, as most phases are short */
+    for (i = 0; i < spins && sense == s; i++)
+    {
+        spin_pause();
+    }
+
+    if (sense != s)
+    {
+        return;
+    }
+
+    /* go to sleep, counter is checked after the increment
+     * so that the last thread can't miss the sleeper */
+    atomic_add(&asleep, 1);
+
+    while (sense == s)
+    {
+        sleep_wait(&sense, s);
+    }
+
+    atomic_add(&asleep, -1);
+}
+
+/*
+ * Remove "num" threads that will never arrive from the barrier,
+ * complete current phase if all remaining threads have arrived.
+ */
+rt_void rt_Barrier::leave(rt_si32 num)
+{
+    thnum -= num;
+
+    if (atomic_add(&count, -num) == num)
+    {
+        count = thnum;
+        atomic_add(&sense, 1);
+
+        if (asleep != 0)
+        {
+            sleep_wake(&sense);
+        }
+    }
+}
+
+/*
+ * Deinitialize barrier.
+ */
+rt_Barrier::~rt_Barrier()
+{
+
+}
+
+/*
+ * Thread-pool's per-thread data.
+ */
+struct rt_WORKER
+{
+    rt_ThreadPool      *pool;
+    rt_si32             index;
+    rt_pntr             thr;
+};
+
+/*
+ * Instantiate thread-pool of "thnum" threads (> 0 - clamped to allowed CPUs,
+ * < 0 - exact count, 0 - all allowed CPUs) running "f_task" with "arg",
+ * pin threads to CPUs ordered node by node if "affinity" is set
+ * starting with allowed CPU "first",
+ * synchronize with barrier spinning for "spins" before sleeping.
+ */
+rt_ThreadPool::rt_ThreadPool(rt_si32 thnum, rt_FUNC_TASK f_task, rt_pntr arg,
+                             rt_bool affinity, rt_si32 spins, rt_si32 first)
+{
+    rt_si32 *cpu_node = (rt_si32 *)malloc(sizeof(rt_si32) * RT_CPU_MAX * 2);
+
+    if (cpu_node == RT_NULL)
+    {
+        throw rt_Exception("out of memory for cpu_node in thread-pool");
+    }
+
+    rt_si32 *cpu_list = cpu_node + RT_CPU_MAX;
+    rt_si32 ndnum = numa_nodes(cpu_node, RT_CPU_MAX);
+    rt_si32 i, n, c, cpus = 0;
+
+    /* order allowed CPUs node by node,
+     * so that consecutive threads are grouped on the same node */
+    cpu_allowed(cpu_node, RT_CPU_MAX);
+
+    for (n = 0; n < ndnum; n++)
+    {
+        for (c = 0; c < RT_CPU_MAX; c++)
+        {
+            if (cpu_node[c] == n)
+            {
+                cpu_list[cpus++] = c;
+            }
+        }
+    }
+
+    n = cpus > 0 ? cpus : RT_MAX(cpu_count(), 1);
+
+    thnum = thnum > 0 ? RT_MIN(thnum, n) : thnum < 0 ? -thnum : n;
+
+    this->thnum = thnum;
+    this->f_task = f_task;
+    this->arg = arg;
+
+    cmd = 0;
+    busy = 0;
+    err = RT_NULL;
+
+    worker = (rt_WORKER *)malloc(sizeof(rt_WORKER) * thnum);
+    thnode = (rt_si32 *)malloc(sizeof(rt_si32) * thnum);
+
+    if (worker == RT_NULL || thnode == RT_NULL)
+    {
+        free(cpu_node);
+        free(worker);
+        free(thnode);
+        throw rt_Exception("out of memory for workers in thread-pool");
+    }
+
+    /* single sense-reversing barrier serves
+     * both signal and completion crossings,
+     * created before workers start waiting on it */
+    barr = new rt_Barrier(thnum + 1, spins);
+
+    for (i = 0; i < thnum; i++)
+    {
+        worker[i].pool = this;
+        worker[i].index = i;
+
+        try
+        {
+            worker[i].thr = thread_start(worker_thread, &worker[i]);
+        }
+        catch (...)
+        {
+            /* release workers already waiting at the barrier,
+             * as destructor is not called for unfinished constructor */
+            cmd = -1;
+            barr->leave(thnum - i);
+            barr->wait();
+
+            for (n = 0; n < i; n++)
+            {
+                thread_join(worker[n].thr);
+            }
+
+            delete barr;
+
+            free(cpu_node);
+            free(worker);
+            free(thnode);
+            throw;
+        }
+
+        thnode[i] = -1;
+
+        if (affinity && cpus > 0)
+        {
+            /* wrap around allowed CPUs if oversubscribed */
+            c = cpu_list[(RT_MAX(first, 0) + i) % cpus];
+
+            thread_pin(worker[i].thr, c);
+            thnode[i] = cpu_node[c];
+        }
+    }
+
+    free(cpu_node);
+}
+
+/*
+ * Worker thread's entry point.
+ */
+rt_pntr rt_ThreadPool::worker_thread(rt_pntr p)
+{
+    rt_WORKER *worker = (rt_WORKER *)p;
+    rt_ThreadPool *pool = worker->pool;
+
+    while (1)
+    {
+        /* every worker-thread waits signal from main thread */
+        pool->barr->wait();
+
+        rt_si32 cmd = pool->cmd;
+
+        if (cmd < 0)
+        {
+            break;
+        }
+
+        /* if one thread throws an exception,
+         * other threads are still allowed to proceed
+         * in the same run, but not in the next one */
+        if (pool->err == RT_NULL)
+        try
+        {
+            pool->f_task(pool->arg, worker->index, cmd);
+        }
+        catch (rt_Exception &e)
+        {
+            pool->err = e.err;
+        }
+
+        atomic_add(&pool->busy, -1);
+
+        /* every worker-thread signals to main thread when done */
+        pool->barr->wait();
+    }
+
+    return RT_NULL;
+}
+
+/*
+ * Get thread-pool's size.
+ */
+rt_si32 rt_ThreadPool::get_thnum()
+{
+    return thnum;
+}
+
+/*
+ * Get NUMA node of thread with given "index" (< 0 - unknown or not pinned).
+ */
+rt_si32 rt_ThreadPool::get_node(rt_si32 index)
+{
+    return index >= 0 && index < thnum ? thnode[index] : -1;
+}
+
+/*
+ * Run task with given "cmd" (>= 0) on all threads, block until finished,
+ * pass on the exception thrown by the task in any thread.
+ */
+rt_void rt_ThreadPool::run(rt_si32 cmd)
+{
+    start(cmd);
+    wait();
+}
+
+/*
+ * Signal all threads to run task with given "cmd" (>= 0), don't block.
+ * Must be followed by wait before the next start/run.
+ */
+rt_void rt_ThreadPool::start(rt_si32 cmd)
+{
+    this->cmd = cmd;
+    busy = thnum;
+
+    /* signal all worker-threads to run */
+    barr->wait();
+}
+
+/*
+ * Check whether all threads have finished the task since the last start.
+ */
+rt_bool rt_ThreadPool::done()
+{
+    return busy == 0;
+}
+
+/*
+ * Block until all threads have finished the task since the last start,
+ * pass on the exception thrown by the task in any thread.
+ */
+rt_void rt_ThreadPool::wait()
+{
+    /* wait for all worker-threads to finish */
+    barr->wait();
+
+    if (err != RT_NULL)
+    {
+        rt_pstr e = err;
+        err = RT_NULL;
+        throw rt_Exception(e);
+    }
+}
+
+/*
+ * Deinitialize thread-pool, terminate and join worker threads.
+ */
+rt_ThreadPool::~rt_ThreadPool()
+{
+    rt_si32 i;
+
+    /* signal all worker-threads to terminate */
+    cmd = -1;
+    barr->wait();
+
+    for (i = 0; i < thnum; i++)
+    {
+        thread_join(worker[i].thr);
+    }
+
+    delete barr;
+
+    free(worker);
+    free(thnode);
 }
 
 /******************************************************************************/
@@ -30,6 +30,12 @@
 /******************************************************************************/
 
 #define RT_CHUNK_SIZE           65536 /* heap allocation granularity (16*4k) */
+#ifndef RT_SPIN_COUNT
+#define RT_SPIN_COUNT           1024  /* barrier spin-waits before sleeping */
+#endif /* RT_SPIN_COUNT */
+
+#define RT_NUMA_MAX             64    /* max NUMA node index + 1 supported */
+#define RT_CPU_MAX              1024  /* max CPU index + 1 supported by pool */
 
 #define RT_PATH_STRFY(p)        #p
 #define RT_PATH_TOSTR(p)        RT_PATH_STRFY(p)
@@ -49,6 +55,9 @@ class rt_List;
 class rt_Exception;
 class rt_LogRedirect;
 
+class rt_Barrier;
+class rt_ThreadPool;
+
 /******************************************************************************/
 /**********************************   FILE   **********************************/
 /******************************************************************************/
@@ -117,6 +126,15 @@ class rt_Heap
     rt_CHUNK           *head;
     rt_pntr             obj_head;
 
+    /* twin chain of chunks, swapped with the
+     * current one to keep two groups of allocs
+     * released independently (double-buffering) */
+    rt_CHUNK           *twin;
+
+    /* NUMA node for chunks' pages
+     * (< 0 - first-touch placement) */
+    rt_si32             node;
+
     rt_void chunk_alloc(rt_size size, rt_ui32 align);
 
     protected:
@@ -136,9 +154,12 @@ class rt_Heap
     rt_pntr alloc(rt_size size, rt_ui32 align);
     rt_pntr reserve(rt_size size, rt_ui32 align);
     rt_pntr release(rt_pntr ptr);
+    rt_void swap();
 
     rt_pntr obj_alloc(rt_size size, rt_ui32 align);
     rt_pntr obj_free(rt_pntr ptr);
+
+    rt_void set_node(rt_si32 node);
 };
 
 /******************************************************************************/
@@ -190,6 +211,162 @@ class rt_Exception
    ~rt_Exception() { }
 };
 
+/******************************************************************************/
+/********************************   THREADING   *******************************/
+/******************************************************************************/
+
+/*
+ * Atomically add "val" to the integer at "ptr" and return its previous value.
+ * Used by the engine for lock-free distribution of work between threads.
+ */
+rt_si32 atomic_add(volatile rt_si32 *ptr, rt_si32 val);
+
+/*
+ * Atomically add "val" to the 64-bit integer at "ptr"
+ * and return its previous value.
+ */
+rt_si64 atomic_add64(volatile rt_si64 *ptr, rt_si64 val);
+
+/*
+ * Get system time in microseconds.
+ * Used by the engine for profiling of per-thread workloads.
+ */
+rt_time get_usec();
+
+/*
+ * Discover NUMA topology from the OS (sysfs on Linux): fill "cpu_node" with
+ * node index of each of the first "cpu_max" CPUs (< 0 - not present),
+ * return number of nodes. If only one node exists and "sim" > 1, CPUs are
+ * split into "sim" contiguous groups simulating separate nodes (used for
+ * testing of node-aware paths).
+ */
+rt_si32 numa_nodes(rt_si32 *cpu_node, rt_si32 cpu_max, rt_si32 sim = 0);
+
+/*
+ * Set preferred NUMA "node" for pages of given memory range,
+ * pages already touched are migrated. Failures are ignored (no-op
+ * on single-node systems, for simulated nodes and on other OSes).
+ */
+rt_void numa_bind(rt_pntr ptr, rt_size size, rt_si32 node);
+
+/*
+ * Pin the calling thread to given "cpu".
+ */
+rt_void cpu_bind(rt_si32 cpu);
+
+/*
+ * Barrier synchronizes fixed number of threads in consecutive phases.
+ * Sense-reversing: phase counter is advanced by the last thread to arrive,
+ * waiting threads spin on it for a while before going to sleep in the kernel
+ * (futex on Linux, yield elsewhere), which keeps short phases cheap.
+ */
+class rt_Barrier
+{
+/*  fields */
+
+    private:
+
+    /* number of threads to synchronize
+     * and number of spins before sleep */
+    rt_si32             thnum;
+    rt_si32             spins;
+
+    /* number of threads yet to arrive */
+    volatile rt_si32    count;
+    /* phase counter (sense) */
+    volatile rt_si32    sense;
+    /* number of sleeping threads */
+    volatile rt_si32    asleep;
+
+/*  methods */
+
+    public:
+
+    rt_Barrier(rt_si32 thnum, rt_si32 spins = RT_SPIN_COUNT);
+
+    virtual
+   ~rt_Barrier();
+
+    /* block until all "thnum" threads have arrived */
+    rt_void     wait();
+
+    /* remove "num" threads that will never arrive */
+    rt_void     leave(rt_si32 num);
+};
+
+/*
+ * Task run by each thread of the pool with thread's "index"
+ * and command "cmd" given to the pool's run.
+ */
+typedef rt_void (*rt_FUNC_TASK)(rt_pntr arg, rt_si32 index, rt_si32 cmd);
+
+struct rt_WORKER;
+
+/*
+ * ThreadPool is a portable pool of worker threads, optionally pinned to
+ * allowed CPUs ordered node by node, which run the same task in each phase.
+ * The main thread signals and waits for workers with a single barrier
+ * (spin-then-sleep with given number of "spins", sleep-only if 0).
+ * Number of threads "thnum" > 0 is clamped to the number of allowed CPUs,
+ * < 0 is used as is (wrapping around CPUs), 0 means all allowed CPUs.
+ * Pinning starts at allowed CPU "first" so that pools can share CPUs.
+ * Exception thrown by the task is passed on to the main thread from run,
+ * other threads are still allowed to finish the phase.
+ */
+class rt_ThreadPool
+{
+/*  fields */
+
+    private:
+
+    /* number of threads, their data
+     * and NUMA node of each thread */
+    rt_si32             thnum;
+    rt_WORKER          *worker;
+    rt_si32            *thnode;
+
+    /* barrier for signal and completion */
+    rt_Barrier         *barr;
+
+    /* task with its argument,
+     * current command (< 0 - terminate),
+     * number of threads yet to finish it
+     * and error from the last run */
+    rt_FUNC_TASK        f_task;
+    rt_pntr             arg;
+    volatile rt_si32    cmd;
+    volatile rt_si32    busy;
+    rt_pstr volatile    err;
+
+/*  methods */
+
+    private:
+
+    static
+    rt_pntr     worker_thread(rt_pntr p);
+
+    public:
+
+    rt_ThreadPool(rt_si32 thnum, rt_FUNC_TASK f_task, rt_pntr arg,
+                  rt_bool affinity = RT_TRUE, rt_si32 spins = RT_SPIN_COUNT,
+                  rt_si32 first = 0);
+
+    virtual
+   ~rt_ThreadPool();
+
+    rt_si32     get_thnum();
+    rt_si32     get_node(rt_si32 index);
+
+    /* run task with "cmd" on all threads, block until finished */
+    rt_void     run(rt_si32 cmd);
+
+    /* split run: signal threads to start task with "cmd" and return,
+     * check whether all threads are done, block until finished */
+    rt_void     start(rt_si32 cmd);
+    rt_bool     done();
+    rt_void     wait();
+};
+
 /******************************************************************************/
 /*********************************   LOGGING   ********************************/
 /******************************************************************************/
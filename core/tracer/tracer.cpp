@@ -51,6 +51,7 @@
 #define RT_FEAT_CLIPPING_CUSTOM     1   /* <- breaks BB in the engine if 0 */
 #define RT_FEAT_CLIPPING_ACCUM      1   /* <- breaks AC in the engine if 0 */
 #define RT_FEAT_TEXTURING           1
+#define RT_FEAT_TEXTURING_MIPMAP    1   /* bilinear fetch from mip-levels */
 #define RT_FEAT_NORMALS             1   /* <- breaks LT in the engine if 0 */
 #define RT_FEAT_LIGHTS              1
 #define RT_FEAT_LIGHTS_COLORED      1
@@ -71,6 +72,7 @@
 #define RT_FEAT_TRANSFORM           1   /* <- breaks TM in the engine if 0 */
 #define RT_FEAT_TRANSFORM_ARRAY     1   /* <- breaks TA in the engine if 0 */
 #define RT_FEAT_BOUND_VOL_ARRAY     1
+#define RT_FEAT_LANE_COUNTERS       1   /* lane occupancy per bounce level */
 
 #define RT_FEAT_PT                  1
 #define RT_FEAT_PT_SPLIT_DEPTH      1
@@ -168,9 +170,9 @@
         movyx_st(Reax, Mecx, ctx_C_BUF(0x04))                               \
         movyx_st(Reax, Mecx, ctx_C_BUF(0x08))                               \
         movyx_st(Reax, Mecx, ctx_C_BUF(0x0C))                               \
-        PAINT_COLX(10, COL_R(0))                                            \
-        PAINT_COLX(08, COL_G(0))                                            \
-        PAINT_COLX(00, COL_B(0))
+        PAINT_COLX(lb, 10, COL_R(0))                                        \
+        PAINT_COLX(lb, 08, COL_G(0))                                        \
+        PAINT_COLX(lb, 00, COL_B(0))
 
 #elif RT_ELEMENT == 64
 
@@ -178,9 +180,9 @@
         movyx_ri(Reax, IV(cl))                                              \
         movyx_st(Reax, Mecx, ctx_C_BUF(0x00))                               \
         movyx_st(Reax, Mecx, ctx_C_BUF(0x08))                               \
-        PAINT_COLX(10, COL_R(0))                                            \
-        PAINT_COLX(08, COL_G(0))                                            \
-        PAINT_COLX(00, COL_B(0))
+        PAINT_COLX(lb, 10, COL_R(0))                                        \
+        PAINT_COLX(lb, 08, COL_G(0))                                        \
+        PAINT_COLX(lb, 00, COL_B(0))
 
 #endif /* RT_ELEMENT */
 
@@ -198,9 +200,9 @@
         movyx_st(Reax, Mecx, ctx_C_BUF(0x14))                               \
         movyx_st(Reax, Mecx, ctx_C_BUF(0x18))                               \
         movyx_st(Reax, Mecx, ctx_C_BUF(0x1C))                               \
-        PAINT_COLX(10, COL_R(0))                                            \
-        PAINT_COLX(08, COL_G(0))                                            \
-        PAINT_COLX(00, COL_B(0))
+        PAINT_COLX(lb, 10, COL_R(0))                                        \
+        PAINT_COLX(lb, 08, COL_G(0))                                        \
+        PAINT_COLX(lb, 00, COL_B(0))
 
 #elif RT_ELEMENT == 64
 
@@ -210,9 +212,9 @@
         movyx_st(Reax, Mecx, ctx_C_BUF(0x08))                               \
         movyx_st(Reax, Mecx, ctx_C_BUF(0x10))                               \
         movyx_st(Reax, Mecx, ctx_C_BUF(0x18))                               \
-        PAINT_COLX(10, COL_R(0))                                            \
-        PAINT_COLX(08, COL_G(0))                                            \
-        PAINT_COLX(00, COL_B(0))
+        PAINT_COLX(lb, 10, COL_R(0))                                        \
+        PAINT_COLX(lb, 08, COL_G(0))                                        \
+        PAINT_COLX(lb, 00, COL_B(0))
 
 #endif /* RT_ELEMENT */
 
@@ -238,9 +240,9 @@
         movyx_st(Reax, Mecx, ctx_C_BUF(0x34))                               \
         movyx_st(Reax, Mecx, ctx_C_BUF(0x38))                               \
         movyx_st(Reax, Mecx, ctx_C_BUF(0x3C))                               \
-        PAINT_COLX(10, COL_R(0))                                            \
-        PAINT_COLX(08, COL_G(0))                                            \
-        PAINT_COLX(00, COL_B(0))
+        PAINT_COLX(lb, 10, COL_R(0))                                        \
+        PAINT_COLX(lb, 08, COL_G(0))                                        \
+        PAINT_COLX(lb, 00, COL_B(0))
 
 #elif RT_ELEMENT == 64
 
@@ -254,9 +256,9 @@
         movyx_st(Reax, Mecx, ctx_C_BUF(0x28))                               \
         movyx_st(Reax, Mecx, ctx_C_BUF(0x30))                               \
         movyx_st(Reax, Mecx, ctx_C_BUF(0x38))                               \
-        PAINT_COLX(10, COL_R(0))                                            \
-        PAINT_COLX(08, COL_G(0))                                            \
-        PAINT_COLX(00, COL_B(0))
+        PAINT_COLX(lb, 10, COL_R(0))                                        \
+        PAINT_COLX(lb, 08, COL_G(0))                                        \
+        PAINT_COLX(lb, 00, COL_B(0))
 
 #endif /* RT_ELEMENT */
 
@@ -298,9 +300,9 @@
         movyx_st(Reax, Mecx, ctx_C_BUF(0x74))                               \
         movyx_st(Reax, Mecx, ctx_C_BUF(0x78))                               \
         movyx_st(Reax, Mecx, ctx_C_BUF(0x7C))                               \
-        PAINT_COLX(10, COL_R(0))                                            \
-        PAINT_COLX(08, COL_G(0))                                            \
-        PAINT_COLX(00, COL_B(0))
+        PAINT_COLX(lb, 10, COL_R(0))                                        \
+        PAINT_COLX(lb, 08, COL_G(0))                                        \
+        PAINT_COLX(lb, 00, COL_B(0))
 
 #elif RT_ELEMENT == 64
 
@@ -322,9 +324,9 @@
         movyx_st(Reax, Mecx, ctx_C_BUF(0x68))                               \
         movyx_st(Reax, Mecx, ctx_C_BUF(0x70))                               \
         movyx_st(Reax, Mecx, ctx_C_BUF(0x78))                               \
-        PAINT_COLX(10, COL_R(0))                                            \
-        PAINT_COLX(08, COL_G(0))                                            \
-        PAINT_COLX(00, COL_B(0))
+        PAINT_COLX(lb, 10, COL_R(0))                                        \
+        PAINT_COLX(lb, 08, COL_G(0))                                        \
+        PAINT_COLX(lb, 00, COL_B(0))
 
 #endif /* RT_ELEMENT */
 
@@ -398,9 +400,9 @@
         movyx_st(Reax, Mecx, ctx_C_BUF(0xF4))                               \
         movyx_st(Reax, Mecx, ctx_C_BUF(0xF8))                               \
         movyx_st(Reax, Mecx, ctx_C_BUF(0xFC))                               \
-        PAINT_COLX(10, COL_R(0))                                            \
-        PAINT_COLX(08, COL_G(0))                                            \
-        PAINT_COLX(00, COL_B(0))
+        PAINT_COLX(lb, 10, COL_R(0))                                        \
+        PAINT_COLX(lb, 08, COL_G(0))                                        \
+        PAINT_COLX(lb, 00, COL_B(0))
 
 #elif RT_ELEMENT == 64
 
@@ -438,9 +440,9 @@
         movyx_st(Reax, Mecx, ctx_C_BUF(0xE8))                               \
         movyx_st(Reax, Mecx, ctx_C_BUF(0xF0))                               \
         movyx_st(Reax, Mecx, ctx_C_BUF(0xF8))                               \
-        PAINT_COLX(10, COL_R(0))                                            \
-        PAINT_COLX(08, COL_G(0))                                            \
-        PAINT_COLX(00, COL_B(0))
+        PAINT_COLX(lb, 10, COL_R(0))                                        \
+        PAINT_COLX(lb, 08, COL_G(0))                                        \
+        PAINT_COLX(lb, 00, COL_B(0))
 
 #endif /* RT_ELEMENT */
 
@@ -661,15 +663,15 @@
         movyx_st(Reax, Mecx, ctx_C_BUF(0x##pn))                             \
     LBL(lb##pn)
 
-#define PAINT_COLX(cl, pl) /* destroys Reax, Xmm0, reads Xmm2, Xmm7 */      \
+#define PAINT_COLX(lb, cl, pl) /* destroys Reax, Xmm0, reads Xmm2, Xmm7 */  \
         movpx_ld(Xmm0, Mecx, ctx_C_BUF(0))                                  \
         shrpx_ri(Xmm0, IB(0x##cl))                                          \
         andpx_rr(Xmm0, Xmm7)                                                \
         cvnpn_rr(Xmm0, Xmm0)                                                \
         divps_rr(Xmm0, Xmm2)                                                \
-        CHECK_PROP(GM_p##cl, RT_PROP_GAMMA)                                 \
+        CHECK_PROP(lb##_g##cl, RT_PROP_GAMMA)                               \
   GAMMA(mulps_rr(Xmm0, Xmm0)) /* gamma-to-linear colorspace conversion */   \
-    LBL(GM_p##cl)                                                           \
+    LBL(lb##_g##cl)                                                         \
         movpx_st(Xmm0, Mecx, ctx_##pl)
 
 #if   RT_SIMD_QUADS == 1
@@ -684,9 +686,9 @@
         PAINT_FRAG(lb, 0C)                                                  \
         movpx_ld(Xmm2, Medx, mat_CLAMP)                                     \
         movpx_ld(Xmm7, Medx, mat_CMASK)                                     \
-        PAINT_COLX(10, TEX_R)                                               \
-        PAINT_COLX(08, TEX_G)                                               \
-        PAINT_COLX(00, TEX_B)
+        PAINT_COLX(lb, 10, TEX_R)                                           \
+        PAINT_COLX(lb, 08, TEX_G)                                           \
+        PAINT_COLX(lb, 00, TEX_B)
 
 #elif RT_ELEMENT == 64
 
@@ -696,9 +698,9 @@
         PAINT_FRAG(lb, 08)                                                  \
         movpx_ld(Xmm2, Medx, mat_CLAMP)                                     \
         movpx_ld(Xmm7, Medx, mat_CMASK)                                     \
-        PAINT_COLX(10, TEX_R)                                               \
-        PAINT_COLX(08, TEX_G)                                               \
-        PAINT_COLX(00, TEX_B)
+        PAINT_COLX(lb, 10, TEX_R)                                           \
+        PAINT_COLX(lb, 08, TEX_G)                                           \
+        PAINT_COLX(lb, 00, TEX_B)
 
 #endif /* RT_ELEMENT */
 
@@ -718,9 +720,9 @@
         PAINT_FRAG(lb, 1C)                                                  \
         movpx_ld(Xmm2, Medx, mat_CLAMP)                                     \
         movpx_ld(Xmm7, Medx, mat_CMASK)                                     \
-        PAINT_COLX(10, TEX_R)                                               \
-        PAINT_COLX(08, TEX_G)                                               \
-        PAINT_COLX(00, TEX_B)
+        PAINT_COLX(lb, 10, TEX_R)                                           \
+        PAINT_COLX(lb, 08, TEX_G)                                           \
+        PAINT_COLX(lb, 00, TEX_B)
 
 #elif RT_ELEMENT == 64
 
@@ -732,9 +734,9 @@
         PAINT_FRAG(lb, 18)                                                  \
         movpx_ld(Xmm2, Medx, mat_CLAMP)                                     \
         movpx_ld(Xmm7, Medx, mat_CMASK)                                     \
-        PAINT_COLX(10, TEX_R)                                               \
-        PAINT_COLX(08, TEX_G)                                               \
-        PAINT_COLX(00, TEX_B)
+        PAINT_COLX(lb, 10, TEX_R)                                           \
+        PAINT_COLX(lb, 08, TEX_G)                                           \
+        PAINT_COLX(lb, 00, TEX_B)
 
 #endif /* RT_ELEMENT */
 
@@ -762,9 +764,9 @@
         PAINT_FRAG(lb, 3C)                                                  \
         movpx_ld(Xmm2, Medx, mat_CLAMP)                                     \
         movpx_ld(Xmm7, Medx, mat_CMASK)                                     \
-        PAINT_COLX(10, TEX_R)                                               \
-        PAINT_COLX(08, TEX_G)                                               \
-        PAINT_COLX(00, TEX_B)
+        PAINT_COLX(lb, 10, TEX_R)                                           \
+        PAINT_COLX(lb, 08, TEX_G)                                           \
+        PAINT_COLX(lb, 00, TEX_B)
 
 #elif RT_ELEMENT == 64
 
@@ -780,9 +782,9 @@
         PAINT_FRAG(lb, 38)                                                  \
         movpx_ld(Xmm2, Medx, mat_CLAMP)                                     \
         movpx_ld(Xmm7, Medx, mat_CMASK)                                     \
-        PAINT_COLX(10, TEX_R)                                               \
-        PAINT_COLX(08, TEX_G)                                               \
-        PAINT_COLX(00, TEX_B)
+        PAINT_COLX(lb, 10, TEX_R)                                           \
+        PAINT_COLX(lb, 08, TEX_G)                                           \
+        PAINT_COLX(lb, 00, TEX_B)
 
 #endif /* RT_ELEMENT */
 
@@ -826,9 +828,9 @@
         PAINT_FRAG(lb, 7C)                                                  \
         movpx_ld(Xmm2, Medx, mat_CLAMP)                                     \
         movpx_ld(Xmm7, Medx, mat_CMASK)                                     \
-        PAINT_COLX(10, TEX_R)                                               \
-        PAINT_COLX(08, TEX_G)                                               \
-        PAINT_COLX(00, TEX_B)
+        PAINT_COLX(lb, 10, TEX_R)                                           \
+        PAINT_COLX(lb, 08, TEX_G)                                           \
+        PAINT_COLX(lb, 00, TEX_B)
 
 #elif RT_ELEMENT == 64
 
@@ -852,9 +854,9 @@
         PAINT_FRAG(lb, 78)                                                  \
         movpx_ld(Xmm2, Medx, mat_CLAMP)                                     \
         movpx_ld(Xmm7, Medx, mat_CMASK)                                     \
-        PAINT_COLX(10, TEX_R)                                               \
-        PAINT_COLX(08, TEX_G)                                               \
-        PAINT_COLX(00, TEX_B)
+        PAINT_COLX(lb, 10, TEX_R)                                           \
+        PAINT_COLX(lb, 08, TEX_G)                                           \
+        PAINT_COLX(lb, 00, TEX_B)
 
 #endif /* RT_ELEMENT */
 
@@ -930,9 +932,9 @@
         PAINT_FRAG(lb, FC)                                                  \
         movpx_ld(Xmm2, Medx, mat_CLAMP)                                     \
         movpx_ld(Xmm7, Medx, mat_CMASK)                                     \
-        PAINT_COLX(10, TEX_R)                                               \
-        PAINT_COLX(08, TEX_G)                                               \
-        PAINT_COLX(00, TEX_B)
+        PAINT_COLX(lb, 10, TEX_R)                                           \
+        PAINT_COLX(lb, 08, TEX_G)                                           \
+        PAINT_COLX(lb, 00, TEX_B)
 
 #elif RT_ELEMENT == 64
 
@@ -972,14 +974,30 @@
         PAINT_FRAG(lb, F8)                                                  \
         movpx_ld(Xmm2, Medx, mat_CLAMP)                                     \
         movpx_ld(Xmm7, Medx, mat_CMASK)                                     \
-        PAINT_COLX(10, TEX_R)                                               \
-        PAINT_COLX(08, TEX_G)                                               \
-        PAINT_COLX(00, TEX_B)
+        PAINT_COLX(lb, 10, TEX_R)                                           \
+        PAINT_COLX(lb, 08, TEX_G)                                           \
+        PAINT_COLX(lb, 00, TEX_B)
 
 #endif /* RT_ELEMENT */
 
 #endif /* RT_SIMD_QUADS */
 
+/*
+ * Accumulate texel's color from the context's
+ * TEX_R, TEX_G, TEX_B SIMD-fields (set by PAINT_SIMD)
+ * into Xmm3, Xmm4, Xmm5 with the weight given in Xmm2.
+ */
+#define BLEND_TEXL() /* destroys Xmm0, reads Xmm2 */                        \
+        movpx_ld(Xmm0, Mecx, ctx_TEX_R)                                     \
+        mulps_rr(Xmm0, Xmm2)                                                \
+        addps_rr(Xmm3, Xmm0)                                                \
+        movpx_ld(Xmm0, Mecx, ctx_TEX_G)                                     \
+        mulps_rr(Xmm0, Xmm2)                                                \
+        addps_rr(Xmm4, Xmm0)                                                \
+        movpx_ld(Xmm0, Mecx, ctx_TEX_B)                                     \
+        mulps_rr(Xmm0, Xmm2)                                                \
+        addps_rr(Xmm5, Xmm0)
+
 /*
  * Prepare all fragments (in packed integer 3-byte form) of
  * the fully computed color values from the context's
@@ -1005,6 +1023,33 @@
         FRAME_COLX(00, COL_B)                                               \
         movpx_st(Xmm0, Mecx, ctx_C_BUF(0))
 
+/*
+ * Accumulate active lanes (TMASK) of secondary rays entering next bounce
+ * level into occupancy counters (inf_OCC), skipped if counters are NULL,
+ * which is the default unless enabled in the engine with "set_occ".
+ * Counters are indexed by remaining depth, each holds per-lane number of
+ * active rays followed by per-lane number of packets, all in SIMD elements.
+ * Only measured here, lanes of sparse packets aren't compacted as colors
+ * of secondary rays are returned along the context stack of each packet.
+ */
+#define COUNT_LANES(lb) /* destroys Reax, Resi, Xmm0, Xmm7 */               \
+        movxx_ld(Resi, Mebp, inf_OCC)                                       \
+        cmjxx_rz(Resi,                                                      \
+                 EQ_x, lb)                                                  \
+        movxx_ld(Reax, Mebp, inf_DEPTH)                                     \
+        mulxx_ri(Reax, IM(Q*32))                                            \
+        movpx_ld(Xmm0, Mecx, ctx_TMASK(0))                                  \
+        shrpx_ri(Xmm0, IB(RT_ELEMENT-1))                                    \
+        movpx_ld(Xmm7, Iesi, DP(0))                                         \
+        addpx_rr(Xmm7, Xmm0)                                                \
+        movpx_st(Xmm7, Iesi, DP(0))                                         \
+        movpx_ld(Xmm0, Mebp, inf_GPC07)                                     \
+        shrpx_ri(Xmm0, IB(RT_ELEMENT-1))                                    \
+        movpx_ld(Xmm7, Iesi, DP(Q*16))                                      \
+        addpx_rr(Xmm7, Xmm0)                                                \
+        movpx_st(Xmm7, Iesi, DP(Q*16))                                      \
+    LBL(lb)
+
 /*
  * Generate next random number (Xmm0, fp: 0.0-1.0) using XX-bit LCG method.
  * Seed (inf_PRNGS) must be initialized outside along with other constants.
@@ -2309,6 +2354,220 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         mulps_ld(Xmm4, Medx, mat_XSCAL)         /* tex_x *= XSCAL */
         mulps_ld(Xmm5, Medx, mat_YSCAL)         /* tex_y *= YSCAL */
 
+#if RT_FEAT_TEXTURING_MIPMAP
+
+        cmjxx_mz(Mebp, inf_FILT,
+                 EQ_x, MT_tnr)
+
+        movpx_st(Xmm4, Mecx, ctx_TEX_U)         /* tex_x -> TEX_U */
+        movpx_st(Xmm5, Mecx, ctx_TEX_V)         /* tex_y -> TEX_V */
+
+        /* ray cone's footprint in texels (squared),
+         * pixel's spread at hit distance over obliquity,
+         * secondary rays only use their last segment's T_VAL
+         * with camera's pixel spread: cone's width isn't carried
+         * through bounces (nor widened by curved surfaces),
+         * thus textures seen in reflections/refractions
+         * pick finer levels than a true ray cone would */
+        movpx_ld(Xmm0, Mecx, ctx_RAY_X)
+        movpx_rr(Xmm1, Xmm0)
+        mulps_rr(Xmm1, Xmm0)                    /* ray_r <- ray_x^2 */
+        mulps_ld(Xmm0, Mecx, ctx_NRM_X)
+        movpx_rr(Xmm2, Xmm0)                    /* r_dot <- ray_x * nrm_x */
+
+        movpx_ld(Xmm0, Mecx, ctx_RAY_Y)
+        movpx_rr(Xmm3, Xmm0)
+        mulps_rr(Xmm3, Xmm0)
+        addps_rr(Xmm1, Xmm3)                    /* ray_r += ray_y^2 */
+        mulps_ld(Xmm0, Mecx, ctx_NRM_Y)
+        addps_rr(Xmm2, Xmm0)                    /* r_dot += ray_y * nrm_y */
+
+        movpx_ld(Xmm0, Mecx, ctx_RAY_Z)
+        movpx_rr(Xmm3, Xmm0)
+        mulps_rr(Xmm3, Xmm0)
+        addps_rr(Xmm1, Xmm3)                    /* ray_r += ray_z^2 */
+        mulps_ld(Xmm0, Mecx, ctx_NRM_Z)
+        addps_rr(Xmm2, Xmm0)                    /* r_dot += ray_z * nrm_z */
+
+        sqrps_rr(Xmm3, Xmm1)                    /* ray_l sq ray_r */
+        mulps_rr(Xmm1, Xmm3)                    /* ray_r *= ray_l */
+        andpx_ld(Xmm2, Mebp, inf_GPC04)         /* r_dot = |r_dot| */
+        divps_rr(Xmm1, Xmm2)                    /* ray_r /= r_dot */
+
+        movpx_ld(Xmm0, Mecx, ctx_T_VAL(0))
+        mulps_rr(Xmm0, Xmm0)
+        mulps_rr(Xmm1, Xmm0)                    /* ray_r *= t_val^2 */
+
+        movpx_ld(Xmm0, Medx, mat_XSCAL)
+        andpx_ld(Xmm0, Mebp, inf_GPC04)
+        movpx_ld(Xmm2, Medx, mat_YSCAL)
+        andpx_ld(Xmm2, Mebp, inf_GPC04)
+        maxps_rr(Xmm0, Xmm2)
+        mulps_rr(Xmm0, Xmm0)
+        mulps_rr(Xmm1, Xmm0)                    /* ray_r *= scale^2 */
+
+        movxx_ld(Redi, Mebp, inf_CAM)
+        mulps_ld(Xmm1, Medi, cam_PIX_A)         /* ray_r *= PIX_A */
+
+        movpx_rr(Xmm7, Xmm1)
+        cltps_ld(Xmm7, Mebp, inf_GPC01)         /* m_mag <- ray_r < 1.0 */
+        movpx_st(Xmm7, Mecx, ctx_XTMP1)         /* m_mag -> XTMP1 */
+
+        /* level of detail from footprint's exponent,
+         * halved for footprint's squared value */
+        maxps_ld(Xmm1, Mebp, inf_GPC01)         /* ray_r max  +1.0 */
+        minps_ld(Xmm1, Medx, mat_M_MAX)         /* ray_r min M_MAX */
+        subpx_ld(Xmm1, Mebp, inf_GPC01)         /* ray_r -=  +1.0 */
+
+#if   RT_ELEMENT == 32
+
+        shrpx_ri(Xmm1, IB(24))                  /* lod_k <- ray_r */
+        movpx_rr(Xmm0, Xmm1)
+        shlpx_ri(Xmm0, IB(23))
+
+#elif RT_ELEMENT == 64
+
+        shrpx_ri(Xmm1, IB(53))                  /* lod_k <- ray_r */
+        movpx_rr(Xmm0, Xmm1)
+        shlpx_ri(Xmm0, IB(52))
+
+#endif /* RT_ELEMENT */
+
+        movpx_ld(Xmm2, Mebp, inf_GPC01)
+        subpx_rr(Xmm2, Xmm0)                    /* lod_s <- 2^-lod_k */
+
+        /* texture coords at level,
+         * shifted to texel centers */
+        movpx_ld(Xmm4, Mecx, ctx_TEX_U)
+        mulps_rr(Xmm4, Xmm2)                    /* tex_x *= lod_s */
+        addps_ld(Xmm4, Mebp, inf_GPC02)         /* tex_x += -0.5 */
+
+        movpx_ld(Xmm5, Mecx, ctx_TEX_V)
+        mulps_rr(Xmm5, Xmm2)                    /* tex_y *= lod_s */
+        addps_ld(Xmm5, Mebp, inf_GPC02)         /* tex_y += -0.5 */
+
+        rnmps_rr(Xmm3, Xmm4)                    /* tex_i rm tex_x */
+        subps_rr(Xmm4, Xmm3)                    /* tex_x -= tex_i */
+        movpx_st(Xmm4, Mecx, ctx_TEX_U)         /* frc_x -> TEX_U */
+        cvzps_rr(Xmm4, Xmm3)                    /* tex_x ii tex_i */
+
+        rnmps_rr(Xmm3, Xmm5)                    /* tex_j rm tex_y */
+        subps_rr(Xmm5, Xmm3)                    /* tex_y -= tex_j */
+        movpx_st(Xmm5, Mecx, ctx_TEX_V)         /* frc_y -> TEX_V */
+        cvzps_rr(Xmm5, Xmm3)                    /* tex_y ii tex_j */
+
+        /* magnified texels stay sharp, nearest
+         * of 2x2 is picked by rounded fractions */
+        movpx_ld(Xmm7, Mecx, ctx_XTMP1)         /* m_mag <- XTMP1 */
+
+        movpx_ld(Xmm0, Mecx, ctx_TEX_U)
+        rnnps_rr(Xmm2, Xmm0)
+        andpx_rr(Xmm2, Xmm7)
+        movpx_rr(Xmm3, Xmm7)
+        annpx_rr(Xmm3, Xmm0)
+        orrpx_rr(Xmm2, Xmm3)
+        movpx_st(Xmm2, Mecx, ctx_TEX_U)         /* frc_x -> TEX_U */
+
+        movpx_ld(Xmm0, Mecx, ctx_TEX_V)
+        rnnps_rr(Xmm2, Xmm0)
+        andpx_rr(Xmm2, Xmm7)
+        movpx_rr(Xmm3, Xmm7)
+        annpx_rr(Xmm3, Xmm0)
+        orrpx_rr(Xmm2, Xmm3)
+        movpx_st(Xmm2, Mecx, ctx_TEX_V)         /* frc_y -> TEX_V */
+
+        /* wrap 2x2 texels within level */
+        movpx_ld(Xmm2, Medx, mat_XMASK)
+        svrpx_rr(Xmm2, Xmm1)                    /* x_msk >> lod_k */
+        andpx_rr(Xmm4, Xmm2)                    /* tex_x &= x_msk */
+        movpx_rr(Xmm3, Xmm4)
+        subpx_ld(Xmm3, Mebp, inf_GPC07)         /* tex_z <- tex_x + 1 */
+        andpx_rr(Xmm3, Xmm2)                    /* tex_z &= x_msk */
+
+        movpx_ld(Xmm2, Medx, mat_YMASK)
+        svrpx_rr(Xmm2, Xmm1)                    /* y_msk >> lod_k */
+        andpx_rr(Xmm5, Xmm2)                    /* tex_y &= y_msk */
+        movpx_rr(Xmm6, Xmm5)
+        subpx_ld(Xmm6, Mebp, inf_GPC07)         /* tex_w <- tex_y + 1 */
+        andpx_rr(Xmm6, Xmm2)                    /* tex_w &= y_msk */
+
+        movpx_ld(Xmm2, Medx, mat_M_SHF)
+        subpx_rr(Xmm2, Xmm1)                    /* y_shf <- M_SHF - lod_k */
+        svlpx_rr(Xmm5, Xmm2)                    /* tex_y << y_shf */
+        svlpx_rr(Xmm6, Xmm2)                    /* tex_w << y_shf */
+
+        /* level's offset in the chain
+         * (M_OFS - M_OFS >> 2*lod_k) / 3 */
+        addpx_rr(Xmm1, Xmm1)
+        movpx_ld(Xmm0, Medx, mat_M_OFS)
+        svrpx_rr(Xmm0, Xmm1)
+        movpx_ld(Xmm2, Medx, mat_M_OFS)
+        subpx_rr(Xmm2, Xmm0)
+        mulpx_ld(Xmm2, Medx, mat_M_INV)         /* exact division by 3 */
+        addpx_rr(Xmm5, Xmm2)                    /* tex_y += lod_o */
+        addpx_rr(Xmm6, Xmm2)                    /* tex_w += lod_o */
+
+        movpx_rr(Xmm1, Xmm5)
+        addpx_rr(Xmm1, Xmm4)
+        shlpx_ri(Xmm1, IB(2))                   /* tex_p <- (y, x) */
+
+        movpx_rr(Xmm0, Xmm5)
+        addpx_rr(Xmm0, Xmm3)
+        shlpx_ri(Xmm0, IB(2))
+        movpx_st(Xmm0, Mecx, ctx_XTMP1)         /* (y, z) -> XTMP1 */
+
+        movpx_rr(Xmm0, Xmm6)
+        addpx_rr(Xmm0, Xmm4)
+        shlpx_ri(Xmm0, IB(2))
+        movpx_st(Xmm0, Mecx, ctx_XTMP2)         /* (w, x) -> XTMP2 */
+
+        addpx_rr(Xmm6, Xmm3)
+        shlpx_ri(Xmm6, IB(2))                   /* tex_q <- (w, z) */
+
+        /* bilinear blend of 2x2 texels
+         * in linear colorspace */
+        PAINT_SIMD(MT_tx0, Xmm1)
+        movpx_ld(Xmm2, Mebp, inf_GPC01)
+        subps_ld(Xmm2, Mecx, ctx_TEX_U)         /* wgt_v <- 1 - frc_x */
+        movpx_ld(Xmm3, Mecx, ctx_TEX_R)
+        mulps_rr(Xmm3, Xmm2)
+        movpx_ld(Xmm4, Mecx, ctx_TEX_G)
+        mulps_rr(Xmm4, Xmm2)
+        movpx_ld(Xmm5, Mecx, ctx_TEX_B)
+        mulps_rr(Xmm5, Xmm2)
+
+        movpx_ld(Xmm1, Mecx, ctx_XTMP1)
+        PAINT_SIMD(MT_tx1, Xmm1)
+        movpx_ld(Xmm2, Mecx, ctx_TEX_U)         /* wgt_v <- frc_x */
+        BLEND_TEXL()
+        movpx_ld(Xmm2, Mebp, inf_GPC01)
+        subps_ld(Xmm2, Mecx, ctx_TEX_V)         /* wgt_v <- 1 - frc_y */
+        mulps_rr(Xmm3, Xmm2)
+        mulps_rr(Xmm4, Xmm2)
+        mulps_rr(Xmm5, Xmm2)
+
+        movpx_ld(Xmm1, Mecx, ctx_XTMP2)
+        PAINT_SIMD(MT_tx2, Xmm1)
+        movpx_ld(Xmm2, Mebp, inf_GPC01)
+        subps_ld(Xmm2, Mecx, ctx_TEX_U)         /* wgt_v <- 1 - frc_x */
+        mulps_ld(Xmm2, Mecx, ctx_TEX_V)         /* wgt_v *= frc_y */
+        BLEND_TEXL()
+
+        movpx_rr(Xmm1, Xmm6)
+        PAINT_SIMD(MT_tx3, Xmm1)
+        movpx_ld(Xmm2, Mecx, ctx_TEX_U)         /* wgt_v <- frc_x */
+        mulps_ld(Xmm2, Mecx, ctx_TEX_V)         /* wgt_v *= frc_y */
+        BLEND_TEXL()
+
+        movpx_st(Xmm3, Mecx, ctx_TEX_R)
+        movpx_st(Xmm4, Mecx, ctx_TEX_G)
+        movpx_st(Xmm5, Mecx, ctx_TEX_B)
+        jmpxx_lb(MT_txe)
+
+    LBL(MT_tnr)
+
+#endif /* RT_FEAT_TEXTURING_MIPMAP */
+
         /* texture mapping */
         cvmps_rr(Xmm1, Xmm4)                    /* tex_x ii tex_x */
         andpx_ld(Xmm1, Medx, mat_XMASK)         /* tex_y &= XMASK */
@@ -2326,6 +2585,12 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
         PAINT_SIMD(MT_rtx, Xmm1)
 
+#if RT_FEAT_TEXTURING && RT_FEAT_TEXTURING_MIPMAP
+
+    LBL(MT_txe)
+
+#endif /* RT_FEAT_TEXTURING, RT_FEAT_TEXTURING_MIPMAP */
+
 /******************************************************************************/
 /*********************************   LIGHTS   *********************************/
 /******************************************************************************/
@@ -2548,6 +2813,12 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         cmjxx_mz(Mebp, inf_DEPTH,
                  EQ_x, PT_mix)
 
+#if RT_FEAT_LANE_COUNTERS
+
+        COUNT_LANES(PT_occ) /* destroys Reax, Resi, Xmm0, Xmm7 */
+
+#endif /* RT_FEAT_LANE_COUNTERS */
+
         /* consider evaluating multiple samples
          * per hit to speed up image convergence */
 
@@ -2791,6 +3062,20 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         andpx_ld(Xmm7, Mecx, ctx_TMASK(0))      /* lmask &= TMASK */
         CHECK_MASK(LT_amb, NONE, Xmm7)
 
+        /* apply light's range before shadows,
+         * lanes out of range count as shadowed */
+        movpx_ld(Xmm4, Mecx, ctx_NEW_X)
+        mulps_rr(Xmm4, Xmm4)
+        movpx_ld(Xmm5, Mecx, ctx_NEW_Y)
+        mulps_rr(Xmm5, Xmm5)
+        movpx_ld(Xmm6, Mecx, ctx_NEW_Z)
+        mulps_rr(Xmm6, Xmm6)
+        addps_rr(Xmm4, Xmm5)
+        addps_rr(Xmm4, Xmm6)                    /* Xmm4  <-   r^2 */
+        cleps_ld(Xmm4, Medx, lgt_A_RNG)         /* Xmm4  <= rng^2 */
+        andpx_rr(Xmm7, Xmm4)                    /* lmask &= rmask */
+        CHECK_MASK(LT_amb, NONE, Xmm7)
+
 #if RT_FEAT_LIGHTS_SHADOWS
 
         xorpx_rr(Xmm6, Xmm6)                    /* init shadow mask (hmask) */
@@ -3488,6 +3773,12 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         cmjxx_mz(Mebp, inf_DEPTH,
                  EQ_x, TR_mix)
 
+#if RT_FEAT_LANE_COUNTERS
+
+        COUNT_LANES(TR_occ) /* destroys Reax, Resi, Xmm0, Xmm7 */
+
+#endif /* RT_FEAT_LANE_COUNTERS */
+
         FETCH_IPTR(Resi, LST_P(SRF))
 
 #if RT_SHOW_BOUND
@@ -3833,6 +4124,12 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         cmjxx_mz(Mebp, inf_DEPTH,
                  EQ_x, RF_mix)
 
+#if RT_FEAT_LANE_COUNTERS
+
+        COUNT_LANES(RF_occ) /* destroys Reax, Resi, Xmm0, Xmm7 */
+
+#endif /* RT_FEAT_LANE_COUNTERS */
+
         FETCH_XPTR(Resi, LST_P(SRF))
 
         movpx_ld(Xmm0, Mecx, ctx_TMASK(0))      /* load tmask */
@@ -5147,6 +5444,9 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
         xorxx_rr(Reax, Reax)
 
+        cmjxx_mi(Mebp, inf_BLK_H, IB(1),
+                 GT_x, FB_ini)
+
     LBL(FF_cyc)
 
         shlxx_ri(Reax, IB(L-1))
@@ -5164,6 +5464,54 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         shrxx_ri(Reax, IB(2))
         addxx_st(Reax, Mebp, inf_FRM_X)
 
+        jmpxx_lb(FF_end)
+
+    LBL(FB_ini)
+
+        /* write packed block row by row,
+         * rows past frame's end are dropped */
+        movxx_ld(Resi, Mebp, inf_FRM_H)
+        subxx_ld(Resi, Mebp, inf_FRM_Y)
+        cmjxx_rm(Resi, Mebp, inf_BLK_H,
+                 LT_x, FB_rws)
+
+        movxx_ld(Resi, Mebp, inf_BLK_H)
+
+    LBL(FB_rws)
+
+        mulxx_ld(Resi, Mebp, inf_BLK_W)
+        shlxx_ri(Resi, IB(1+L))
+
+    LBL(FB_cyc)
+
+        shlxx_ri(Reax, IB(L-1))
+        movyx_ld(Redx, Iecx, ctx_C_BUF(0))
+        shrxx_ri(Reax, IB(L-1))
+
+        movwx_st(Redx, Iebx, DP(0))
+
+        subxx_ri(Resi, IB(4*L))
+        addxx_ri(Reax, IB(4))
+
+        cmjxx_rz(Resi,
+                 EQ_x, FB_end)
+
+        movxx_rr(Redx, Reax)
+        andxx_ld(Redx, Mebp, inf_BLK_M)
+        cmjxx_rz(Redx,
+                 NE_x, FB_cyc)
+
+        /* step to block's next row in frame */
+        addxx_ld(Rebx, Mebp, inf_BLK_R)
+        jmpxx_lb(FB_cyc)
+
+    LBL(FB_end)
+
+        movxx_ld(Reax, Mebp, inf_BLK_W)
+        addxx_st(Reax, Mebp, inf_FRM_X)
+
+    LBL(FF_end)
+
         movxx_ld(Reax, Mebp, inf_FRM_X)
         cmjxx_rm(Reax, Mebp, inf_FRM_W,
                  GE_x, YY_end)
@@ -235,8 +235,35 @@ struct rt_SIMD_INFOX : public rt_SIMD_INFO
     rt_pntr prngs;
 #define inf_PRNGS           DP(Q*0x100+0x064*P+E)
 
-    rt_word pad11[38];
-#define inf_PAD11           DP(Q*0x100+0x068*P+E)
+    /* packed block of pixels per SIMD vector
+     * (blk_h == 1 - scanline, rest is unused) */
+
+    rt_word blk_w;
+#define inf_BLK_W           DP(Q*0x100+0x068*P+E)
+
+    rt_word blk_h;
+#define inf_BLK_H           DP(Q*0x100+0x06C*P+E)
+
+    rt_word blk_m;
+#define inf_BLK_M           DP(Q*0x100+0x070*P+E)
+
+    rt_cell blk_r;
+#define inf_BLK_R           DP(Q*0x100+0x074*P+E)
+
+    /* lane occupancy counters per bounce level
+     * (rt_elem[S] lanes, rt_elem[S] packets) */
+
+    rt_pntr occ;
+#define inf_OCC             DP(Q*0x100+0x078*P+E)
+
+    /* texture filtering mode
+     * (0 - nearest texel, 1 - bilinear mip-mapped) */
+
+    rt_word filt;
+#define inf_FILT            DP(Q*0x100+0x07C*P+E)
+
+    rt_word pad11[32];
+#define inf_PAD11           DP(Q*0x100+0x080*P+E)
 
     rt_uelm prngf[S];
 #define inf_PRNGF           DP(Q*0x100+0x100*P)
@@ -671,7 +698,7 @@ struct rt_SIMD_CONTEXT
 /*
  * SIMD camera structure with properties for
  * rays horizontal and vertical scanning, color masks,
- * accumulated ambient color.
+ * accumulated ambient color, pixel's spread for texturing.
  * Structure is read-only in backend.
  */
 struct rt_SIMD_CAMERA
@@ -752,6 +779,12 @@ struct rt_SIMD_CAMERA
     rt_real col_b[S];
 #define cam_COL_B           DP(Q*0x130)
 
+    /* pixel's spread angle for texture LOD
+     * (squared and doubled to round levels) */
+
+    rt_real pix_a[S];
+#define cam_PIX_A           DP(Q*0x140)
+
 };
 
 /******************************************************************************/
@@ -1075,6 +1108,20 @@ struct rt_SIMD_MATERIAL
     rt_real gpc10[S];
 #define mat_GPC10           DP(Q*0x1A0)
 
+    /* texture mip-mapping */
+
+    rt_real m_max[S];
+#define mat_M_MAX           DP(Q*0x1B0)
+
+    rt_elem m_shf[S];
+#define mat_M_SHF           DP(Q*0x1C0)
+
+    rt_elem m_ofs[S];
+#define mat_M_OFS           DP(Q*0x1D0)
+
+    rt_elem m_inv[S];
+#define mat_M_INV           DP(Q*0x1E0)
+
 };
 
 /*
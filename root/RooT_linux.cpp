@@ -49,71 +49,6 @@ pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
 #undef  RT_SETAFFINITY /* setting thread affinity is not present on macOS */
 #define RT_SETAFFINITY 0
 
-/*
- * Custom implementation of pthread barriers for macOS found at:
- * http://blog.albertarmea.com/post/47089939939/using-pthreadbarrier-on-mac-os-x
- * copied as is with minor format adjustments.
- */
-#include <errno.h>
-
-typedef int pthread_barrierattr_t;
-typedef struct
-{
-    pthread_mutex_t mutex;
-    pthread_cond_t cond;
-    int count;
-    int tripCount;
-} pthread_barrier_t;
-
-int pthread_barrier_init(pthread_barrier_t *barrier,
-                         const pthread_barrierattr_t *attr, unsigned int count)
-{
-    if(count == 0)
-    {
-        errno = EINVAL;
-        return -1;
-    }
-    if(pthread_mutex_init(&barrier->mutex, 0) < 0)
-    {
-        return -1;
-    }
-    if(pthread_cond_init(&barrier->cond, 0) < 0)
-    {
-        pthread_mutex_destroy(&barrier->mutex);
-        return -1;
-    }
-    barrier->tripCount = count;
-    barrier->count = 0;
-
-    return 0;
-}
-
-int pthread_barrier_destroy(pthread_barrier_t *barrier)
-{
-    pthread_cond_destroy(&barrier->cond);
-    pthread_mutex_destroy(&barrier->mutex);
-    return 0;
-}
-
-int pthread_barrier_wait(pthread_barrier_t *barrier)
-{
-    pthread_mutex_lock(&barrier->mutex);
-    ++(barrier->count);
-    if(barrier->count >= barrier->tripCount)
-    {
-        barrier->count = 0;
-        pthread_cond_broadcast(&barrier->cond);
-        pthread_mutex_unlock(&barrier->mutex);
-        return 1;
-    }
-    else
-    {
-        pthread_cond_wait(&barrier->cond, &(barrier->mutex));
-        pthread_mutex_unlock(&barrier->mutex);
-        return 0;
-    }
-}
-
 #endif /* __APPLE__ */
 
 /******************************************************************************/
@@ -543,188 +478,73 @@ rt_void sys_free(rt_pntr ptr, rt_size size)
 /*****************************   MULTI-THREADING   ****************************/
 /******************************************************************************/
 
-struct rt_THREAD;
-
-/* platform-specific pool
- * of "thnum" threads */
-struct rt_THREAD_POOL
-{
-    rt_Platform        *pfm;
-    rt_si32             cmd;
-    rt_si32             thnum;
-    rt_THREAD          *thread;
-    pthread_barrier_t   barr[2];
-};
-
-/* platform-specific thread */
-struct rt_THREAD
-{
-    rt_THREAD_POOL     *tpool;
-    rt_si32             index;
-    pthread_t           pthr;
-};
-
 /*
- * Worker thread's entry point.
+ * Worker thread's task, run update/render phase on the current scene's slice.
  */
-rt_pntr worker_thread(rt_pntr p)
+rt_void worker_task(rt_pntr arg, rt_si32 ti, rt_si32 cmd)
 {
-    rt_THREAD *thread = (rt_THREAD *)p;
-    rt_si32 ti = thread->index;
+    rt_Platform *pfm = (rt_Platform *)arg;
 
-    while (thread->tpool->cmd < 0) /* <- wait for barriers */
+    /* if one thread throws an exception,
+     * other threads are still allowed to proceed
+     * in the same run, but not in the next one */
+    if (eout == 0)
+    try
     {
-        sched_yield();
-    }
+        rt_Scene *scene = pfm->get_cur_scene();
 
-    while (1)
-    {
-        /* every worker-thread waits signal from main thread */
-        pthread_barrier_wait(&thread->tpool->barr[0]);
-
-        rt_Platform *pfm = thread->tpool->pfm;
-
-        if (pfm == RT_NULL)
+        switch (cmd & 0x3)
         {
+            case 1:
+            scene->update_slice(ti, (cmd >> 2) & 0xFF);
             break;
-        }
-
-        rt_si32 cmd = thread->tpool->cmd;
-
-        /* if one thread throws an exception,
-         * other threads are still allowed to proceed
-         * in the same run, but not in the next one */
-        if (eout == 0)
-        try
-        {
-            rt_Scene *scene = pfm->get_cur_scene();
 
-            switch (cmd & 0x3)
-            {
-                case 1:
-                scene->update_slice(ti, (cmd >> 2) & 0xFF);
-                break;
-
-                case 2:
-                scene->render_slice(ti, (cmd >> 2) & 0xFF);
-                break;
-
-                default:
-                break;
-            };
-        }
-        catch (rt_Exception e)
-        {
-            estr[ti] = e.err;
-            eout = 1;
-        }
+            case 2:
+            scene->render_slice(ti, (cmd >> 2) & 0xFF);
+            break;
 
-        /* every worker-thread signals to main thread when done */
-        pthread_barrier_wait(&thread->tpool->barr[1]);
+            default:
+            break;
+        };
+    }
+    catch (rt_Exception e)
+    {
+        estr[ti] = e.err;
+        eout = 1;
     }
-
-    /* every worker-thread signals to main thread when done */
-    pthread_barrier_wait(&thread->tpool->barr[1]);
-
-    return RT_NULL;
 }
 
 /*
  * Initialize platform-specific pool of "thnum" threads (< 0 - no feedback).
+ * Threads are pinned to allowed CPUs ordered node by node by the pool.
  */
 rt_pntr init_threads(rt_si32 thnum, rt_Platform *pfm)
 {
     rt_bool feedback = thnum < 0 ? RT_FALSE : RT_TRUE;
-    thnum = thnum < 0 ? -thnum : thnum;
+    rt_si32 i, n = thnum < 0 ? -thnum : thnum;
 
-    eout = 0; emax = thnum;
-    estr = (rt_pstr *)malloc(sizeof(rt_pstr) * thnum);
+    eout = 0; emax = n;
+    estr = (rt_pstr *)malloc(sizeof(rt_pstr) * n);
 
     if (estr == RT_NULL)
     {
         throw rt_Exception("out of memory for estr in init_threads");
     }
 
-    memset(estr, 0, sizeof(rt_pstr) * thnum);
-
-#if RT_SETAFFINITY
-
-    cpu_set_t cpuset_pr, cpuset_th;
-    pthread_t pthr = pthread_self();
-    pthread_getaffinity_np(pthr, sizeof(cpu_set_t), &cpuset_pr);
+    memset(estr, 0, sizeof(rt_pstr) * n);
 
-#endif /* RT_SETAFFINITY */
+    rt_ThreadPool *tpool = new rt_ThreadPool(thnum, worker_task, pfm,
+                                             RT_SETAFFINITY, RT_SPIN_COUNT);
 
-    rt_THREAD_POOL *tpool = (rt_THREAD_POOL *)malloc(sizeof(rt_THREAD_POOL));
-
-    if (tpool == RT_NULL)
+    for (i = 0; i < tpool->get_thnum(); i++)
     {
-        throw rt_Exception("out of memory for tpool in init_threads");
-    }
-
-    tpool->pfm = pfm;
-    tpool->cmd = -1;
-    tpool->thnum = thnum;
-    tpool->thread = (rt_THREAD *)malloc(sizeof(rt_THREAD) * thnum);
-
-    if (tpool->thread == RT_NULL)
-    {
-        throw rt_Exception("out of memory for thread data in init_threads");
-    }
-
-    rt_si32 i, a;
-
-    for (i = 0, a = 0; i < thnum; i++, a++)
-    {
-#if RT_SETAFFINITY
-
-        while (!CPU_ISSET(a, &cpuset_pr))
-        {
-            a++;
-            if (a == CPU_SETSIZE)
-            {
-                if (feedback)
-                {
-                    thnum = i;
-                    break;
-                }
-                else
-                {
-                    a = 0;
-                }
-            }
-        }
-        if (thnum == i)
-        {
-            break;
-        }
-
-#endif /* RT_SETAFFINITY */
-
-        rt_THREAD *thread = tpool->thread;
-
-        thread[i].tpool = tpool;
-        thread[i].index = i;
-        pthread_create(&thread[i].pthr, NULL, worker_thread, &thread[i]);
-
-#if RT_SETAFFINITY
-
-        CPU_ZERO(&cpuset_th);
-        CPU_SET(a, &cpuset_th);
-        pthread_setaffinity_np(thread[i].pthr, sizeof(cpu_set_t), &cpuset_th);
-
-#endif /* RT_SETAFFINITY */
+        pfm->set_node(i, tpool->get_node(i));
     }
 
-    pthread_barrier_init(&tpool->barr[0], NULL, thnum + 1);
-    pthread_barrier_init(&tpool->barr[1], NULL, thnum + 1);
-
     if (feedback)
     {
-        pfm->set_thnum(thnum);
+        pfm->set_thnum(tpool->get_thnum());
     }
-    tpool->thnum = thnum;
-    tpool->cmd = 0;
 
     return tpool;
 }
@@ -734,28 +554,7 @@ rt_pntr init_threads(rt_si32 thnum, rt_Platform *pfm)
  */
 rt_void term_threads(rt_pntr tdata, rt_si32 thnum)
 {
-    rt_si32 i;
-    rt_THREAD_POOL *tpool = (rt_THREAD_POOL *)tdata;
-
-    /* signal all worker-threads to terminate */
-    tpool->cmd = 0;
-    tpool->pfm = RT_NULL;
-    pthread_barrier_wait(&tpool->barr[0]);
-    /* wait for all worker-threads to finish */
-    pthread_barrier_wait(&tpool->barr[1]);
-
-    for (i = 0; i < tpool->thnum; i++)
-    {
-        rt_THREAD *thread = tpool->thread;
-
-        pthread_join(thread[i].pthr, NULL);
-    }
-
-    pthread_barrier_destroy(&tpool->barr[0]);
-    pthread_barrier_destroy(&tpool->barr[1]);
-
-    free(tpool->thread);
-    free(tpool);
+    delete (rt_ThreadPool *)tdata;
 
     free(estr);
     estr = RT_NULL;
@@ -768,13 +567,7 @@ rt_void term_threads(rt_pntr tdata, rt_si32 thnum)
  */
 rt_void update_scene(rt_pntr tdata, rt_si32 thnum, rt_si32 phase)
 {
-    rt_THREAD_POOL *tpool = (rt_THREAD_POOL *)tdata;
-
-    /* signal all worker-threads to update scene */
-    tpool->cmd = 1 | ((phase & 0xFF) << 2);
-    pthread_barrier_wait(&tpool->barr[0]);
-    /* wait for all worker-threads to finish */
-    pthread_barrier_wait(&tpool->barr[1]);
+    ((rt_ThreadPool *)tdata)->run(1 | ((phase & 0xFF) << 2));
 }
 
 /*
@@ -783,13 +576,7 @@ rt_void update_scene(rt_pntr tdata, rt_si32 thnum, rt_si32 phase)
  */
 rt_void render_scene(rt_pntr tdata, rt_si32 thnum, rt_si32 phase)
 {
-    rt_THREAD_POOL *tpool = (rt_THREAD_POOL *)tdata;
-
-    /* signal all worker-threads to render scene */
-    tpool->cmd = 2 | ((phase & 0xFF) << 2);
-    pthread_barrier_wait(&tpool->barr[0]);
-    /* wait for all worker-threads to finish */
-    pthread_barrier_wait(&tpool->barr[1]);
+    ((rt_ThreadPool *)tdata)->run(2 | ((phase & 0xFF) << 2));
 }
 
 /******************************************************************************/
@@ -40,7 +40,8 @@ LIB_PATH =
 LIB_LIST =                                  \
         -lm                                 \
         -lstdc++                            \
-        -lgdi32
+        -lgdi32                             \
+        -lsynchronization
 
 
 build: RooT_w64_32 RooT_w64_64 RooT_w64f32 RooT_w64f64
@@ -53,7 +54,7 @@ clean:
 
 
 RooT_w64_32:
-	g++ -O3 -g -D_WIN32_WINNT=0x0601 -static -m64 \
+	g++ -O3 -g -D_WIN32_WINNT=0x0602 -static -m64 \
         -DRT_WIN64 -DRT_X64 -DRT_128=2+4+8 -DRT_256_R8=4 -DRT_256=1+2+8 \
         -DRT_512_R8=1+2 -DRT_512=1+2 -DRT_1K4=1+2 -DRT_2K8_R8=0 \
         -DRT_POINTER=64 -DRT_ADDRESS=32 -DRT_ELEMENT=32 -DRT_ENDIAN=0 \
@@ -62,7 +63,7 @@ RooT_w64_32:
         ${INC_PATH} ${SRC_LIST} ${LIB_PATH} ${LIB_LIST} -o RooT_w64_32.exe
 
 RooT_w64_64:
-	g++ -O3 -g -D_WIN32_WINNT=0x0601 -static -m64 \
+	g++ -O3 -g -D_WIN32_WINNT=0x0602 -static -m64 \
         -DRT_WIN64 -DRT_X64 -DRT_128=2+4+8 -DRT_256_R8=4 -DRT_256=1+2+8 \
         -DRT_512_R8=1+2 -DRT_512=1+2 -DRT_1K4=1+2 -DRT_2K8_R8=0 \
         -DRT_POINTER=64 -DRT_ADDRESS=32 -DRT_ELEMENT=64 -DRT_ENDIAN=0 \
@@ -71,7 +72,7 @@ RooT_w64_64:
         ${INC_PATH} ${SRC_LIST} ${LIB_PATH} ${LIB_LIST} -o RooT_w64_64.exe
 
 RooT_w64f32:
-	g++ -O3 -g -D_WIN32_WINNT=0x0601 -static -m64 \
+	g++ -O3 -g -D_WIN32_WINNT=0x0602 -static -m64 \
         -DRT_WIN64 -DRT_X64 -DRT_128=2+4+8 -DRT_256_R8=4 -DRT_256=1+2+8 \
         -DRT_512_R8=1+2 -DRT_512=1+2 -DRT_1K4=1+2 -DRT_2K8_R8=0 \
         -DRT_POINTER=64 -DRT_ADDRESS=64 -DRT_ELEMENT=32 -DRT_ENDIAN=0 \
@@ -80,7 +81,7 @@ RooT_w64f32:
         ${INC_PATH} ${SRC_LIST} ${LIB_PATH} ${LIB_LIST} -o RooT_w64f32.exe
 
 RooT_w64f64:
-	g++ -O3 -g -D_WIN32_WINNT=0x0601 -static -m64 \
+	g++ -O3 -g -D_WIN32_WINNT=0x0602 -static -m64 \
         -DRT_WIN64 -DRT_X64 -DRT_128=2+4+8 -DRT_256_R8=4 -DRT_256=1+2+8 \
         -DRT_512_R8=1+2 -DRT_512=1+2 -DRT_1K4=1+2 -DRT_2K8_R8=0 \
         -DRT_POINTER=64 -DRT_ADDRESS=64 -DRT_ELEMENT=64 -DRT_ENDIAN=0 \
@@ -92,8 +93,9 @@ RooT_w64f64:
 # Prerequisites for the build:
 # TDM64-GCC compiler for Win32/64 is installed and in the PATH variable.
 # Download tdm64-gcc-5.1.0-2.exe from sourceforge and run the installer.
-# The multi-group threading implementation requires Windows 7 or newer.
-# Remove -D_WIN32_WINNT=0x0601 for compatibility with Windows XP/Vista.
+# The multi-group threading implementation requires Windows 7 or newer,
+# the barrier's WaitOnAddress-based sleep requires Windows 8 or newer.
+# Remove -D_WIN32_WINNT=0x0602 for compatibility with Windows XP/Vista/7.
 #
 # Compiling/running RooT demo:
 # run RooT_make_w64.bat from Windows Explorer or
@@ -685,6 +685,12 @@ rt_pntr init_threads(rt_si32 thnum, rt_Platform *pfm)
 #if (_WIN32_WINNT < 0x0601) /* Windows XP, Vista */
 
         SetThreadAffinityMask(thread[i].pthr, (rt_uptr)(ULL(1) << g));
+
+        UCHAR node;
+        if (GetNumaProcessorNode((UCHAR)g, &node) != FALSE)
+        {
+            pfm->set_node(i, node != 0xFF ? (rt_si32)node : -1);
+        }
 #if RT_DEBUG >= 2
         RT_LOGI("ThreadAffinityMask: %016" PR_Z "X\n",
                                               (rt_full)(ULL(1) << g));
@@ -694,6 +700,16 @@ rt_pntr init_threads(rt_si32 thnum, rt_Platform *pfm)
 
         ga.Reserved[0] = ga.Reserved[1] = ga.Reserved[2] = 0;
         SetThreadGroupAffinity(thread[i].pthr, &ga, NULL);
+
+        PROCESSOR_NUMBER pn;
+        USHORT node;
+        pn.Group = ga.Group;
+        pn.Reserved = 0;
+        for (pn.Number = 0; (ga.Mask >> pn.Number) > 1; pn.Number++);
+        if (GetNumaProcessorNodeEx(&pn, &node) != FALSE)
+        {
+            pfm->set_node(i, node != 0xFFFF ? (rt_si32)node : -1);
+        }
 #if RT_DEBUG >= 2
         RT_LOGI("ThreadGroupAffinity: Mask = %016" PR_Z "X, Group = %d\n",
                                               (rt_full)ga.Mask, ga.Group);
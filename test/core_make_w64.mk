@@ -39,7 +39,8 @@ LIB_PATH =
 
 LIB_LIST =                                  \
         -lm                                 \
-        -lstdc++
+        -lstdc++                            \
+        -lsynchronization
 
 
 build: core_test_w64_32 core_test_w64_64 core_test_w64f32 core_test_w64f64
@@ -54,6 +55,7 @@ clean:
 core_test_w64_32:
 	g++ -O3 -g -static -m64 \
         -DRT_WIN64 -DRT_X64 -DRT_128=2+4+8 -DRT_256_R8=4 -DRT_256=1+2+8 \
+        -D_WIN32_WINNT=0x0602 \
         -DRT_512_R8=1+2 -DRT_512=1+2 -DRT_1K4=1+2 -DRT_2K8_R8=0 \
         -DRT_POINTER=64 -DRT_ADDRESS=32 -DRT_ELEMENT=32 -DRT_ENDIAN=0 \
         -DRT_DEBUG=0 -DRT_PATH="../" \
@@ -63,6 +65,7 @@ core_test_w64_32:
 core_test_w64_64:
 	g++ -O3 -g -static -m64 \
         -DRT_WIN64 -DRT_X64 -DRT_128=2+4+8 -DRT_256_R8=4 -DRT_256=1+2+8 \
+        -D_WIN32_WINNT=0x0602 \
         -DRT_512_R8=1+2 -DRT_512=1+2 -DRT_1K4=1+2 -DRT_2K8_R8=0 \
         -DRT_POINTER=64 -DRT_ADDRESS=32 -DRT_ELEMENT=64 -DRT_ENDIAN=0 \
         -DRT_DEBUG=0 -DRT_PATH="../" \
@@ -72,6 +75,7 @@ core_test_w64_64:
 core_test_w64f32:
 	g++ -O3 -g -static -m64 \
         -DRT_WIN64 -DRT_X64 -DRT_128=2+4+8 -DRT_256_R8=4 -DRT_256=1+2+8 \
+        -D_WIN32_WINNT=0x0602 \
         -DRT_512_R8=1+2 -DRT_512=1+2 -DRT_1K4=1+2 -DRT_2K8_R8=0 \
         -DRT_POINTER=64 -DRT_ADDRESS=64 -DRT_ELEMENT=32 -DRT_ENDIAN=0 \
         -DRT_DEBUG=0 -DRT_PATH="../" \
@@ -81,6 +85,7 @@ core_test_w64f32:
 core_test_w64f64:
 	g++ -O3 -g -static -m64 \
         -DRT_WIN64 -DRT_X64 -DRT_128=2+4+8 -DRT_256_R8=4 -DRT_256=1+2+8 \
+        -D_WIN32_WINNT=0x0602 \
         -DRT_512_R8=1+2 -DRT_512=1+2 -DRT_1K4=1+2 -DRT_2K8_R8=0 \
         -DRT_POINTER=64 -DRT_ADDRESS=64 -DRT_ELEMENT=64 -DRT_ENDIAN=0 \
         -DRT_DEBUG=0 -DRT_PATH="../" \
@@ -39,7 +39,8 @@ LIB_PATH =
 
 LIB_LIST =                                  \
         -lm                                 \
-        -lstdc++
+        -lstdc++                            \
+        -lpthread
 
 
 build: core_test_x64_32 core_test_x64_64 core_test_x64f32 core_test_x64f64
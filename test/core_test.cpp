@@ -16,6 +16,7 @@
 
 #define RUN_LEVEL           18
 #define CYC_SIZE            3
+#define MIP_DIFF            64
 
 #define RT_X_RES            800
 #define RT_Y_RES            480
@@ -59,6 +60,14 @@ rt_bool     i_mode      = RT_FALSE;     /* imaging mode (from command-line) */
 rt_bool     h_mode      = RT_FALSE;     /* shownum mode (from command-line) */
 rt_bool     o_mode      = RT_FALSE;     /* optimal mode (from command-line) */
 rt_bool     q_mode      = RT_FALSE;     /* quality mode (from command-line) */
+rt_bool     u_mode      = RT_FALSE;     /* pipeline mode (from command-line) */
+rt_bool     r_mode      = RT_FALSE;     /* async-run mode (from command-line) */
+rt_bool     l_mode      = RT_FALSE;     /* split-run mode (from command-line) */
+rt_bool     y_mode      = RT_FALSE;     /* dirty-run mode (from command-line) */
+rt_bool     x_mode      = RT_FALSE;     /* packed-run mode (from command-line) */
+rt_bool     m_mode      = RT_FALSE;     /* mipmap-run mode (from command-line) */
+rt_bool     b_mode      = RT_FALSE;     /* tilebuf-run mode (from command-line) */
+rt_bool     e_mode      = RT_FALSE;     /* linked-run mode (from command-line) */
 rt_si32     a_mode      = RT_FSAA_NO;   /* antialiasing (from command-line) */
 
 /*
@@ -76,6 +85,22 @@ rt_pntr sys_alloc(rt_size size);
  */
 rt_void sys_free(rt_pntr ptr, rt_size size);
 
+/*
+ * Bytes currently allocated from system heap,
+ * updated atomically as scene threads' heaps alloc concurrently.
+ */
+extern volatile rt_si64 s_size;
+
+/*
+ * Start system thread running "func" with given "arg".
+ */
+rt_pntr thr_start(rt_pntr (*func)(rt_pntr), rt_pntr arg);
+
+/*
+ * Wait for system thread to finish and release its handle.
+ */
+rt_void thr_join(rt_pntr thr);
+
 /*
  * Copy frames.
  */
@@ -178,6 +203,232 @@ rt_void frame_max(rt_ui32 *fd)
     }
 }
 
+/*
+ * Barrier benchmark's per-thread data.
+ */
+struct rt_BENCH
+{
+    rt_Barrier         *barr;
+    rt_si32             cycles;
+};
+
+/*
+ * Barrier benchmark's worker thread,
+ * crosses the barrier twice per phase (signal and completion)
+ * as worker threads in platform-specific thread pools do.
+ */
+rt_pntr bench_thread(rt_pntr p)
+{
+    rt_BENCH *bench = (rt_BENCH *)p;
+    rt_si32 i;
+
+    for (i = 0; i < bench->cycles; i++)
+    {
+        bench->barr->wait();
+        bench->barr->wait();
+    }
+
+    return RT_NULL;
+}
+
+/*
+ * Measure average phase dispatch latency (in ns) of the thread-pool barrier
+ * for "thnum" worker threads with given number of "spins" before sleeping.
+ */
+rt_si32 bench_phase(rt_pntr *thr, rt_si32 thnum, rt_si32 spins)
+{
+    rt_si32 i, cycles = 10000;
+
+    rt_Barrier barr(thnum + 1, spins);
+    rt_BENCH bench = {&barr, cycles};
+
+    for (i = 0; i < thnum; i++)
+    {
+        thr[i] = thr_start(bench_thread, &bench);
+    }
+
+    rt_time time1 = get_usec();
+
+    for (i = 0; i < cycles; i++)
+    {
+        barr.wait(); /* signal worker-threads */
+        barr.wait(); /* wait for worker-threads */
+    }
+
+    rt_time time2 = get_usec();
+
+    for (i = 0; i < thnum; i++)
+    {
+        thr_join(thr[i]);
+    }
+
+    return (rt_si32)((time2 - time1) * 1000 / cycles);
+}
+
+/*
+ * Measure phase dispatch latency of the thread-pool barrier
+ * for thread counts from 1 to "thmax" (in addition to main thread),
+ * both with spin-then-sleep (default) and sleep-only waiting.
+ */
+rt_void bench_barrier(rt_si32 thmax)
+{
+    rt_si32 n;
+    rt_pntr *thr = (rt_pntr *)malloc(sizeof(rt_pntr) * thmax);
+
+    for (n = 1; n <= thmax; n++)
+    {
+        RT_LOGI("Threads = %3d, phase dispatch (ns): spin = %7d, sleep = %7d\n",
+                n, bench_phase(thr, n, RT_SPIN_COUNT), bench_phase(thr, n, 0));
+    }
+
+    free(thr);
+}
+
+/*
+ * NUMA benchmark's per-thread data.
+ */
+struct rt_NUMA
+{
+    rt_si32            *buf;
+    rt_size             size;
+    rt_si32             cpu;
+    rt_si32             node;
+    rt_bool             touch;
+    rt_time             time;
+};
+
+/*
+ * NUMA benchmark's worker thread, pinned to its CPU,
+ * optionally places its buffer on thread's node before first touch,
+ * then streams over the buffer (read-modify-write)
+ * as rendering threads do over their framebuffer's rows.
+ */
+rt_pntr numa_thread(rt_pntr p)
+{
+    rt_NUMA *numa = (rt_NUMA *)p;
+    rt_si32 i, k, n = (rt_si32)(numa->size / sizeof(rt_si32));
+
+    cpu_bind(numa->cpu);
+
+    if (numa->touch)
+    {
+        numa_bind(numa->buf, numa->size, numa->node);
+        memset(numa->buf, 0, numa->size);
+    }
+
+    rt_time time1 = get_usec();
+
+    for (k = 0; k < 8; k++)
+    {
+        for (i = 0; i < n; i++)
+        {
+            numa->buf[i] += k;
+        }
+    }
+
+    rt_time time2 = get_usec();
+
+    numa->time = time2 - time1;
+
+    return RT_NULL;
+}
+
+/*
+ * Measure aggregate streaming bandwidth (in MB/s) of "thnum" threads,
+ * each over its own buffer first-touched either by the main thread
+ * or by the owner thread on its node.
+ */
+rt_si32 numa_phase(rt_NUMA *numa, rt_pntr *thr, rt_si32 thnum, rt_bool touch)
+{
+    rt_si32 i;
+    rt_size size = 16 * 1024 * 1024;
+    rt_time t_max = 1;
+
+    for (i = 0; i < thnum; i++)
+    {
+        numa[i].buf = (rt_si32 *)sys_alloc(size);
+        numa[i].size = size;
+        numa[i].touch = touch;
+
+        if (!touch)
+        {
+            memset(numa[i].buf, 0, size);
+        }
+    }
+
+    for (i = 0; i < thnum; i++)
+    {
+        thr[i] = thr_start(numa_thread, &numa[i]);
+    }
+
+    for (i = 0; i < thnum; i++)
+    {
+        thr_join(thr[i]);
+
+        t_max = RT_MAX(t_max, numa[i].time);
+        sys_free(numa[i].buf, size);
+    }
+
+    return (rt_si32)((rt_time)size * 8 * 2 * thnum / t_max);
+}
+
+/*
+ * Measure streaming bandwidth of threads placed node by node for thread
+ * counts from 1 to "thmax", with buffers first-touched by the main thread
+ * and placed on threads' own nodes, simulate two nodes if only one exists.
+ */
+rt_void bench_numa(rt_si32 thmax)
+{
+    rt_si32 cpu_max = 1024, i, n, c, cpus = 0;
+    rt_si32 *cpu_node = (rt_si32 *)malloc(sizeof(rt_si32) * cpu_max * 2);
+    rt_si32 *cpu_list = cpu_node + cpu_max;
+
+    rt_si32 ndnum = numa_nodes(cpu_node, cpu_max);
+    rt_bool sim = ndnum == 1;
+
+    if (sim)
+    {
+        ndnum = numa_nodes(cpu_node, cpu_max, 2);
+    }
+
+    for (n = 0; n < ndnum; n++)
+    {
+        for (c = 0; c < cpu_max; c++)
+        {
+            if (cpu_node[c] == n)
+            {
+                cpu_list[cpus++] = c;
+            }
+        }
+    }
+
+    RT_LOGI("Nodes = %d%s, CPUs = %d\n", ndnum, sim ? " (simulated)" : "", cpus);
+
+    rt_NUMA *numa = (rt_NUMA *)malloc(sizeof(rt_NUMA) * thmax);
+    rt_pntr *thr = (rt_pntr *)malloc(sizeof(rt_pntr) * thmax);
+
+    /* spread threads over nodes the way thread-pools group them */
+    for (i = 0; i < thmax; i++)
+    {
+        c = cpu_list[(i * cpus / thmax) % cpus];
+
+        numa[i].cpu = c;
+        numa[i].node = cpu_node[c];
+    }
+
+    for (n = 1; n <= thmax; n++)
+    {
+        RT_LOGI("Threads = %3d, stream (MB/s): "
+                "main-touch = %7d, node-touch = %7d\n",
+                n, numa_phase(numa, thr, n, RT_FALSE),
+                   numa_phase(numa, thr, n, RT_TRUE));
+    }
+
+    free(thr);
+    free(numa);
+    free(cpu_node);
+}
+
 /*
  * Common instance of platform container.
  */
@@ -553,92 +804,647 @@ testXX o_test[RUN_LEVEL] =
 };
 
 /******************************************************************************/
-/**********************************   MAIN   **********************************/
+/**********************************   SORTING   *******************************/
 /******************************************************************************/
 
-rt_si32 main(rt_si32 argc, rt_char *argv[])
+rt_SPHERE sp_sort01 =
 {
-    rt_si32 k, l, r, t;
+    {      /*   RT_I,       RT_J,       RT_K    */
+/* min */   {  -RT_INF,    -RT_INF,    -RT_INF  },
+/* max */   {  +RT_INF,    +RT_INF,    +RT_INF  },
+        {
+/* OUTER        RT_U,       RT_V    */
+/* scl */   {    1.0,        1.0    },
+/* rot */              0.0           ,
+/* pos */   {    0.0,        0.0    },
 
-    if (argc >= 2)
+/* mat */   &mt_plain01_gray01,
+        },
+        {
+/* INNER        RT_U,       RT_V    */
+/* scl */   {    1.0,        1.0    },
+/* rot */              0.0           ,
+/* pos */   {    0.0,        0.0    },
+
+/* mat */   &mt_plain01_gray02,
+        },
+    },
+/* rad */   0.4,
+};
+
+rt_SPHERE sp_bound01 =
+{
+    {      /*   RT_I,       RT_J,       RT_K    */
+/* min */   {  -RT_INF,    -RT_INF,    -RT_INF  },
+/* max */   {  +RT_INF,    +RT_INF,    +RT_INF  },
+        {
+/* OUTER        RT_U,       RT_V    */
+/* scl */   {    1.0,        1.0    },
+/* rot */              0.0           ,
+/* pos */   {    0.0,        0.0    },
+
+/* mat */   &mt_metal01_pink01,
+        },
+        {
+/* INNER        RT_U,       RT_V    */
+/* scl */   {    1.0,        1.0    },
+/* rot */              0.0           ,
+/* pos */   {    0.0,        0.0    },
+
+/* mat */   &mt_plain01_gray02,
+        },
+    },
+/* rad */   0.4,
+};
+
+rt_RELATION rl_sort01[] =
+{
+    {  -1,  RT_REL_BOUND_ARRAY,  -1   },
+};
+
+typedef rt_void (*leafXX)(rt_OBJECT *obj, rt_si32 idx, rt_si32 row);
+
+/*
+ * Fill "obj" with sphere at grid index "idx" laid out in rows of "row".
+ */
+rt_void sort_leaf(rt_OBJECT *obj, rt_si32 idx, rt_si32 row)
+{
+    obj->trm.pos[RT_X] = (rt_real)(idx % row);
+    obj->trm.pos[RT_Y] = (rt_real)(idx / row);
+
+    obj->obj.tag = RT_TAG_SPHERE;
+    obj->obj.pobj = &sp_sort01;
+    obj->obj.obj_num = 1;
+}
+
+/*
+ * Fill "obj" with "num" leaves made by "leaf" starting from grid index "idx"
+ * laid out in rows of "row", group them into nested arrays of up to "cap"
+ * elements, bounded in scene data if "bnd" is non-zero,
+ * new arrays are taken from the object pool "pool".
+ */
+rt_void grid_tree(rt_OBJECT *obj, rt_OBJECT **pool, rt_si32 idx, rt_si32 num,
+                  rt_si32 row, rt_si32 cap, rt_si32 bnd, leafXX leaf)
+{
+    rt_si32 i, n, sz;
+
+    memset(obj, 0, sizeof(rt_OBJECT));
+    obj->trm.scl[RT_X] = obj->trm.scl[RT_Y] = obj->trm.scl[RT_Z] = 1.0f;
+
+    if (num == 1)
     {
-        RT_LOGI("--------------------------------------------------------\n");
-        RT_LOGI("Usage options are given below:\n");
-        RT_LOGI(" -b n, specify subtest # at which testing begins, n >= 1\n");
-        RT_LOGI(" -e n, specify subtest # at which testing ends, n <= max\n");
-        RT_LOGI(" -f n, specify # of consecutive frames to render, n >= 0\n");
-        RT_LOGI(" -g n, specify delta (ms) for consecutive frames, n >= 0\n");
-        RT_LOGI(" -n n, override SIMD-native-size, where new simd is 1.16\n");
-        RT_LOGI(" -k n, override SIMD-size-factor, where new size is 1..4\n");
-        RT_LOGI(" -s n, override SIMD-sub-variant, where new type is 1.32\n");
-        RT_LOGI(" -w n, override window-rect-size, where new size is 1..9\n");
-        RT_LOGI(" -x n, override x-resolution, where new x-value <= 65535\n");
-        RT_LOGI(" -y n, override y-resolution, where new y-value <= 65535\n");
-        RT_LOGI(" -d n, override diff-threshold for qualification, n >= 0\n");
-        RT_LOGI(" -c n, override counter of redundant test cycles, n >= 1\n");
-        RT_LOGI(" -v, enable verbose mode, print all pixel spots (> diff)\n");
-        RT_LOGI(" -p, enable pixhunt mode, print isolated pixels (> diff)\n");
-        RT_LOGI(" -i, enable imaging mode, save images before-after-diffs\n");
-        RT_LOGI(" -h, enable shownum mode, activate screen-number drawing\n");
-        RT_LOGI(" -o, enable optimal mode, omit unoptimized rendering run\n");
-        RT_LOGI(" -q, enable quality mode, activate path-tracing lighting\n");
-        RT_LOGI(" -a n, enable antialiasing, 2 for 2x, 4 for 4x, 8 for 8x\n");
-        RT_LOGI(" -t tex1 tex2 texn, convert images in data/textures/tex*\n");
-        RT_LOGI(" -z, plot Fresnel/Gamma functions & antialiasing samples\n");
-        RT_LOGI("options -b, .., -a can be combined, -t/-z are standalone\n");
-        RT_LOGI("--------------------------------------------------------\n");
+        leaf(obj, idx, row);
+        return;
     }
 
-    if (argc >= 2 && strcmp(argv[1], "-z") == 0)
+    for (sz = 1; sz * cap < num; sz *= cap);
+
+    n = (num + sz - 1) / sz;
+
+    obj->obj.tag = RT_TAG_ARRAY;
+    obj->obj.pobj = *pool;
+    obj->obj.obj_num = n;
+    obj->obj.prel = bnd != 0 ? rl_sort01 : RT_NULL;
+    obj->obj.rel_num = bnd != 0 ? RT_ARR_SIZE(rl_sort01) : 0;
+
+    rt_OBJECT *arr = *pool;
+   *pool += n;
+
+    for (i = 0; i < n; i++)
     {
-        RT_LOGI("Plotting samples/functions: ");
-        o_test[0]();
-        scene->plot_frags();
-        scene->plot_funcs();
-        delete scene;
-        scene = RT_NULL;
-        RT_LOGI("Done!\n");
-        return 0;
+        grid_tree(&arr[i], pool, idx + i * sz,
+                  RT_MIN(sz, num - i * sz), row, cap, bnd, leaf);
     }
+}
 
-    if (argc >= 3 && strcmp(argv[1], "-t") == 0)
+/*
+ * Fill "obj" with camera above the grid of rows of "row" with spacing "spc"
+ * looking at its middle, and "obj + 1" with light above the grid's middle
+ * if "lgt" is non-zero.
+ */
+rt_void bench_view(rt_OBJECT *obj, rt_si32 row, rt_real spc, rt_si32 lgt)
+{
+    memset(&obj[0], 0, sizeof(rt_OBJECT));
+    obj[0].trm.scl[RT_X] = obj[0].trm.scl[RT_Y] =
+    obj[0].trm.scl[RT_Z] = 1.0f;
+    obj[0].trm.rot[RT_X] = -135.0f;
+    obj[0].trm.pos[RT_X] = ((rt_real)row * 0.5f) * spc;
+    obj[0].trm.pos[RT_Y] = -2.0f * spc;
+    obj[0].trm.pos[RT_Z] = ((rt_real)row * 0.5f + 2.0f) * spc;
+    obj[0].obj.tag = RT_TAG_CAMERA;
+    obj[0].obj.pobj = &cm_camera01;
+    obj[0].obj.obj_num = 1;
+
+    if (lgt == 0)
     {
-        RT_LOGI("Converting textures:\n[");
-        rt_Heap *hp = new rt_Heap(sys_alloc, sys_free);
-        for (k = 2; k < argc; k++)
+        return;
+    }
+
+    memset(&obj[1], 0, sizeof(rt_OBJECT));
+    obj[1].trm.scl[RT_X] = obj[1].trm.scl[RT_Y] =
+    obj[1].trm.scl[RT_Z] = 1.0f;
+    obj[1].trm.pos[RT_X] = ((rt_real)row * 0.5f) * spc;
+    obj[1].trm.pos[RT_Y] = ((rt_real)row * 0.5f) * spc;
+    obj[1].trm.pos[RT_Z] = ((rt_real)row * 0.25f + 1.0f) * spc;
+    obj[1].obj.tag = RT_TAG_LIGHT;
+    obj[1].obj.pobj = &lt_light01;
+    obj[1].obj.obj_num = 1;
+}
+
+/*
+ * Measure update time of a scene with spheres either nested into arrays
+ * of up to 10 or kept flat in a single array (where every sorted list
+ * is as long as the scene), for surface counts doubling up to "srfmax",
+ * as hlist/slist and camera's sorted list are built from scratch
+ * in the first frame, both with bbox sorting on and off
+ * (if enabled in format.h).
+ */
+rt_void bench_sort(rt_si32 srfmax)
+{
+    rt_si32 n, k, f, row;
+    rt_time t_sort[2];
+
+    rt_OBJECT *pool = (rt_OBJECT *)malloc(sizeof(rt_OBJECT) * srfmax * 2 + 4);
+
+    for (n = srfmax; n > 100 && n % 2 == 0; n /= 2);
+
+    for (; n <= srfmax; n *= 2)
+    for (f = 0; f < 2; f++)
+    {
+        for (row = 1; row * row < n; row++);
+
+        rt_OBJECT *obj = pool, *ptr = pool + 2;
+
+        bench_view(&obj[1], row, 1.0f, 0);
+        grid_tree(&obj[0], &ptr, 0, n, row, f == 0 ? 10 : n, 1, sort_leaf);
+
+        rt_SCENE sc_sort =
         {
-            r = convert_image(hp, argv[k]);
-            if (r == 0)
-            {
-                RT_LOGI("x");
-            }
-            else
-            {
-                RT_LOGI(".");
-            }
+            {RT_TAG_ARRAY, pool, 2, RT_NULL, 0, RT_NULL, RT_NULL},
+            RT_OPTS_PT,
+            RT_NULL
+        };
+
+        for (k = 0; k < 2; k++)
+        {
+            scene = new(&pfm) rt_Scene(&sc_sort,
+                                       x_res, y_res, x_row, RT_NULL, &pfm);
+
+            scene->set_opts(k == 0 ? scene->get_opts() | RT_OPTS_RENDER_EXT0 :
+                 (scene->get_opts() | RT_OPTS_RENDER_EXT0) & ~RT_OPTS_INSERT);
+
+            scene->render(0);
+            t_sort[k] = scene->get_t_update();
+
+            delete scene;
+            scene = RT_NULL;
         }
-        delete hp;
-        RT_LOGI("]\nDone!\n");
-        return 0;
+
+        RT_LOGI("Surfaces = %6d, %s, first update (us): sorted = %9d, "
+                "unsorted = %9d\n", n, f == 0 ? "nested" : "flat  ",
+                (rt_si32)t_sort[0], (rt_si32)t_sort[1]);
     }
 
-    for (k = 1; k < argc; k++)
+    free(pool);
+}
+
+/*
+ * Move sphere up and down along its vertical axis.
+ */
+rt_void an_list01(rt_time time, rt_time /* last_time */,
+                  rt_TRANSFORM3D *trm, rt_pntr /* pobj */)
+{
+    trm->pos[RT_Z] = (rt_real)(time % 1000) / 2000.0f;
+}
+
+/*
+ * Measure update time of a scene with "srfnum" spheres nested into arrays
+ * of up to 10 under a light source, when a growing share of spheres
+ * moves every frame, the first update builds all cross-frame lists,
+ * the next ones are averaged over 32 frames, which include full rebuilds
+ * every RT_LISTS_AGE frames (engine.h).
+ */
+rt_void bench_list(rt_si32 srfnum)
+{
+    rt_si32 i, j, c, row;
+    rt_time t_list[2];
+
+    rt_si32 pct[] = {0, 1, 2, 5, 10, 20, 50, 100};
+
+    rt_OBJECT *pool = (rt_OBJECT *)malloc(sizeof(rt_OBJECT) * srfnum * 2 + 6);
+
+    for (row = 1; row * row < srfnum; row++);
+
+    for (i = 0; i < (rt_si32)RT_ARR_SIZE(pct); i++)
     {
-        if (k < argc && strcmp(argv[k], "-b") == 0 && ++k < argc)
+        rt_OBJECT *obj = pool, *ptr = pool + 3;
+
+        bench_view(&obj[1], row, 1.0f, 1);
+        grid_tree(&obj[0], &ptr, 0, srfnum, row, 10, 1, sort_leaf);
+
+        /* animate spheres evenly spread across the grid */
+        for (c = 0, j = 0; j < ptr - pool; j++)
         {
-            for (l = strlen(argv[k]), r = 1, t = 0; l > 0; l--, r *= 10)
+            if (pool[j].obj.tag != RT_TAG_SPHERE)
             {
-                t += (argv[k][l-1] - '0') * r;
+                continue;
             }
-            if (t >= 1 && t <= RUN_LEVEL)
+            if (c * pct[i] / 100 != (c + 1) * pct[i] / 100)
             {
-                RT_LOGI("Subtest-index-init overridden: %d\n", t);
-                n_init = t-1;
+                pool[j].f_anim = an_list01;
             }
-            else
-            {
-                RT_LOGI("Subtest-index-init value out of range\n");
-                return 0;
+            c++;
+        }
+
+        rt_SCENE sc_list =
+        {
+            {RT_TAG_ARRAY, pool, 3, RT_NULL, 0, RT_NULL, RT_NULL},
+            RT_OPTS_PT,
+            RT_NULL
+        };
+
+        scene = new(&pfm) rt_Scene(&sc_list,
+                                   x_res, y_res, x_row, RT_NULL, &pfm);
+
+        scene->set_opts(scene->get_opts() | RT_OPTS_RENDER_EXT0);
+
+        scene->render(0);
+        t_list[0] = scene->get_t_update();
+
+        for (t_list[1] = 0, j = 1; j <= 32; j++)
+        {
+            scene->render(j * f_time);
+            t_list[1] += scene->get_t_update();
+        }
+
+        delete scene;
+        scene = RT_NULL;
+
+        RT_LOGI("Surfaces = %6d, changed = %3d%%, update (us): "
+                "first = %8d, next = %8d\n", srfnum, pct[i],
+                (rt_si32)t_list[0], (rt_si32)(t_list[1] / 32));
+    }
+
+    free(pool);
+}
+
+/*
+ * Measure render time of 10 frames of a scene with "srfnum" reflective
+ * spheres nested into arrays of up to 10 under a light source, where
+ * arrays are bounded in scene data, not bounded (volumes selected by
+ * the engine), or not bounded at all (RT_OPTS_VARRAY off), spheres move
+ * every frame, thus selected volumes are revisited with full rebuilds.
+ */
+rt_void bench_bound(rt_si32 srfnum)
+{
+    rt_si32 j, k, row;
+    rt_time t_bound[3];
+
+    rt_OBJECT *pool = (rt_OBJECT *)malloc(sizeof(rt_OBJECT) * srfnum * 2 + 6);
+
+    for (row = 1; row * row < srfnum; row++);
+
+    for (k = 0; k < 3; k++)
+    {
+        rt_OBJECT *obj = pool, *ptr = pool + 3;
+
+        bench_view(&obj[1], row, 1.0f, 1);
+        grid_tree(&obj[0], &ptr, 0, srfnum, row, 10, k == 0, sort_leaf);
+
+        /* reflective spheres trace secondary rays through all arrays */
+        for (j = 0; j < ptr - pool; j++)
+        {
+            if (pool[j].obj.tag == RT_TAG_SPHERE)
+            {
+                pool[j].obj.pobj = &sp_bound01;
+                pool[j].f_anim = an_list01;
+            }
+        }
+
+        rt_SCENE sc_bound =
+        {
+            {RT_TAG_ARRAY, pool, 3, RT_NULL, 0, RT_NULL, RT_NULL},
+            RT_OPTS_PT,
+            RT_NULL
+        };
+
+        scene = new(&pfm) rt_Scene(&sc_bound,
+                                   x_res, y_res, x_row, RT_NULL, &pfm);
+
+        scene->set_opts(k < 2 ? scene->get_opts() :
+                                scene->get_opts() & ~RT_OPTS_VARRAY);
+
+        t_bound[k] = get_time();
+
+        for (j = 0; j < 10; j++)
+        {
+            scene->render(j * f_time);
+        }
+
+        t_bound[k] = get_time() - t_bound[k];
+
+        delete scene;
+        scene = RT_NULL;
+    }
+
+    RT_LOGI("Surfaces = %6d, render 10 frames (ms): bounded = %7d, "
+            "auto = %7d, none = %7d\n", srfnum, (rt_si32)t_bound[0],
+            (rt_si32)t_bound[1], (rt_si32)t_bound[2]);
+
+    free(pool);
+}
+
+/*
+ * Spin instance around its vertical axis.
+ */
+rt_void an_inst01(rt_time time, rt_time last_time,
+                  rt_TRANSFORM3D *trm, rt_pntr /* pobj */)
+{
+    rt_real t = (time - last_time) / 50.0f;
+
+    trm->rot[RT_Z] += t;
+
+    if (trm->rot[RT_Z] >= 360.0f)
+    {
+        trm->rot[RT_Z] -= 360.0f;
+    }
+}
+
+/*
+ * Fill "obj" with instance of ob_aliencube01 at grid index "idx"
+ * laid out in rows of "row", turned to have its own trnode.
+ */
+rt_void inst_leaf(rt_OBJECT *obj, rt_si32 idx, rt_si32 row)
+{
+    obj->trm.scl[RT_X] = obj->trm.scl[RT_Y] = obj->trm.scl[RT_Z] = 0.4f;
+    obj->trm.rot[RT_Z] = (rt_real)(idx % 90);
+    obj->trm.pos[RT_X] = (rt_real)(idx % row) * 1.5f;
+    obj->trm.pos[RT_Y] = (rt_real)(idx / row) * 1.5f;
+
+    obj->obj.tag = RT_TAG_ARRAY;
+    obj->obj.pobj = ob_aliencube01;
+    obj->obj.obj_num = RT_ARR_SIZE(ob_aliencube01);
+    obj->obj.prel = rl_aliencube01;
+    obj->obj.rel_num = RT_ARR_SIZE(rl_aliencube01);
+    obj->f_anim = an_inst01;
+}
+
+/*
+ * Measure memory and update time of a scene with instances of
+ * ob_aliencube01 for instance counts doubling up to "instmax",
+ * memory is taken from the system heap once the scene is built,
+ * update time is taken in the first frame and in the next one,
+ * where every instance spins.
+ */
+rt_void bench_inst(rt_si32 instmax)
+{
+    rt_si32 n, row;
+    rt_si64 m_size;
+    rt_time t_inst[2];
+
+    rt_OBJECT *pool = (rt_OBJECT *)malloc(sizeof(rt_OBJECT) * instmax * 2 + 4);
+
+    for (n = instmax; n > 100 && n % 2 == 0; n /= 2);
+
+    for (; n <= instmax; n *= 2)
+    {
+        for (row = 1; row * row < n; row++);
+
+        rt_OBJECT *obj = pool, *ptr = pool + 2;
+
+        bench_view(&obj[1], row, 1.5f, 0);
+        grid_tree(&obj[0], &ptr, 0, n, row, 10, 1, inst_leaf);
+
+        rt_SCENE sc_inst =
+        {
+            {RT_TAG_ARRAY, pool, 2, RT_NULL, 0, RT_NULL, RT_NULL},
+            RT_OPTS_PT,
+            RT_NULL
+        };
+
+        m_size = s_size;
+
+        scene = new(&pfm) rt_Scene(&sc_inst,
+                                   x_res, y_res, x_row, RT_NULL, &pfm);
+
+        m_size = s_size - m_size;
+
+        scene->set_opts(scene->get_opts() | RT_OPTS_RENDER_EXT0);
+
+        scene->render(0);
+        t_inst[0] = scene->get_t_update();
+
+        scene->render(f_time);
+        t_inst[1] = scene->get_t_update();
+
+        delete scene;
+        scene = RT_NULL;
+
+        RT_LOGI("Instances = %5d, memory (KB) = %7d, update (us): "
+                "first = %8d, next = %8d\n", n, (rt_si32)(m_size / 1024),
+                                 (rt_si32)t_inst[0], (rt_si32)t_inst[1]);
+    }
+
+    free(pool);
+}
+
+/******************************************************************************/
+/**********************************   MAIN   **********************************/
+/******************************************************************************/
+
+rt_si32 main(rt_si32 argc, rt_char *argv[])
+{
+    rt_si32 k, l, r, t;
+
+    if (argc >= 2)
+    {
+        RT_LOGI("--------------------------------------------------------\n");
+        RT_LOGI("Usage options are given below:\n");
+        RT_LOGI(" -b n, specify subtest # at which testing begins, n >= 1\n");
+        RT_LOGI(" -e n, specify subtest # at which testing ends, n <= max\n");
+        RT_LOGI(" -f n, specify # of consecutive frames to render, n >= 0\n");
+        RT_LOGI(" -g n, specify delta (ms) for consecutive frames, n >= 0\n");
+        RT_LOGI(" -n n, override SIMD-native-size, where new simd is 1.16\n");
+        RT_LOGI(" -k n, override SIMD-size-factor, where new size is 1..4\n");
+        RT_LOGI(" -s n, override SIMD-sub-variant, where new type is 1.32\n");
+        RT_LOGI(" -w n, override window-rect-size, where new size is 1..9\n");
+        RT_LOGI(" -x n, override x-resolution, where new x-value <= 65535\n");
+        RT_LOGI(" -y n, override y-resolution, where new y-value <= 65535\n");
+        RT_LOGI(" -d n, override diff-threshold for qualification, n >= 0\n");
+        RT_LOGI(" -c n, override counter of redundant test cycles, n >= 1\n");
+        RT_LOGI(" -v, enable verbose mode, print all pixel spots (> diff)\n");
+        RT_LOGI(" -p, enable pixhunt mode, print isolated pixels (> diff)\n");
+        RT_LOGI(" -i, enable imaging mode, save images before-after-diffs\n");
+        RT_LOGI(" -h, enable shownum mode, activate screen-number drawing\n");
+        RT_LOGI(" -o, enable optimal mode, omit unoptimized rendering run\n");
+        RT_LOGI(" -q, enable quality mode, activate path-tracing lighting\n");
+        RT_LOGI(" -u, enable pipeline mode, overlap update with rendering\n");
+        RT_LOGI(" -r, enable async-run mode, render to swap-chain in bkgnd\n");
+        RT_LOGI(" -l, enable split-run mode, async-run on own thread-group\n");
+        RT_LOGI(" -R, enable dirty-run mode, re-render changed tile rows\n");
+        RT_LOGI(" -P, enable packed-run mode, SIMD lanes in pixel blocks\n");
+        RT_LOGI(" -M, enable mipmap-run mode, filter textures by ray cone\n");
+        RT_LOGI(" -T, enable tilebuf-run mode, set non-default tile sizes\n");
+        RT_LOGI(" -L, enable linked-run mode, compare rays/s to tile runs\n");
+        RT_LOGI(" -a n, enable antialiasing, 2 for 2x, 4 for 4x, 8 for 8x\n");
+        RT_LOGI(" -t tex1 tex2 texn, convert images in data/textures/tex*\n");
+        RT_LOGI(" -m n, measure barrier phase dispatch for 1..n threads\n");
+        RT_LOGI(" -j n, measure NUMA placement of buffers for 1..n threads\n");
+        RT_LOGI(" -S n, measure bbox sorting of nested/flat n spheres\n");
+        RT_LOGI(" -I n, measure memory/update of n aliencube instances\n");
+        RT_LOGI(" -U n, measure list updates of n spheres by moving share\n");
+        RT_LOGI(" -B n, measure render of n spheres in bounded/auto arrays\n");
+        RT_LOGI(" -z, plot Fresnel/Gamma functions & antialiasing samples\n");
+        RT_LOGI("options -b, .., -a combine, -t/-m/-j/-S/-I/-U/-B/-z alone\n");
+        RT_LOGI("--------------------------------------------------------\n");
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "-z") == 0)
+    {
+        RT_LOGI("Plotting samples/functions: ");
+        o_test[0]();
+        scene->plot_frags();
+        scene->plot_funcs();
+        delete scene;
+        scene = RT_NULL;
+        RT_LOGI("Done!\n");
+        return 0;
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "-t") == 0)
+    {
+        RT_LOGI("Converting textures:\n[");
+        rt_Heap *hp = new rt_Heap(sys_alloc, sys_free);
+        for (k = 2; k < argc; k++)
+        {
+            r = convert_image(hp, argv[k]);
+            if (r == 0)
+            {
+                RT_LOGI("x");
+            }
+            else
+            {
+                RT_LOGI(".");
+            }
+        }
+        delete hp;
+        RT_LOGI("]\nDone!\n");
+        return 0;
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "-m") == 0)
+    {
+        t = atoi(argv[2]);
+        if (t >= 1 && t <= 1024)
+        {
+            RT_LOGI("Measuring barrier latency:\n");
+            bench_barrier(t);
+            RT_LOGI("Done!\n");
+        }
+        else
+        {
+            RT_LOGI("Thread-count value out of range\n");
+        }
+        return 0;
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "-j") == 0)
+    {
+        t = atoi(argv[2]);
+        if (t >= 1 && t <= 256)
+        {
+            RT_LOGI("Measuring NUMA placement:\n");
+            bench_numa(t);
+            RT_LOGI("Done!\n");
+        }
+        else
+        {
+            RT_LOGI("Thread-count value out of range\n");
+        }
+        return 0;
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "-S") == 0)
+    {
+        t = atoi(argv[2]);
+        if (t >= 1 && t <= 100000)
+        {
+            RT_LOGI("Measuring bbox sorting:\n");
+            bench_sort(t);
+            RT_LOGI("Done!\n");
+        }
+        else
+        {
+            RT_LOGI("Surface-count value out of range\n");
+        }
+        return 0;
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "-U") == 0)
+    {
+        t = atoi(argv[2]);
+        if (t >= 1 && t <= 100000)
+        {
+            RT_LOGI("Measuring list updates:\n");
+            bench_list(t);
+            RT_LOGI("Done!\n");
+        }
+        else
+        {
+            RT_LOGI("Surface-count value out of range\n");
+        }
+        return 0;
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "-B") == 0)
+    {
+        t = atoi(argv[2]);
+        if (t >= 1 && t <= 100000)
+        {
+            RT_LOGI("Measuring array bounds:\n");
+            bench_bound(t);
+            RT_LOGI("Done!\n");
+        }
+        else
+        {
+            RT_LOGI("Surface-count value out of range\n");
+        }
+        return 0;
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "-I") == 0)
+    {
+        t = atoi(argv[2]);
+        if (t >= 1 && t <= 100000)
+        {
+            RT_LOGI("Measuring instancing:\n");
+            bench_inst(t);
+            RT_LOGI("Done!\n");
+        }
+        else
+        {
+            RT_LOGI("Instance-count value out of range\n");
+        }
+        return 0;
+    }
+
+    for (k = 1; k < argc; k++)
+    {
+        if (k < argc && strcmp(argv[k], "-b") == 0 && ++k < argc)
+        {
+            for (l = strlen(argv[k]), r = 1, t = 0; l > 0; l--, r *= 10)
+            {
+                t += (argv[k][l-1] - '0') * r;
+            }
+            if (t >= 1 && t <= RUN_LEVEL)
+            {
+                RT_LOGI("Subtest-index-init overridden: %d\n", t);
+                n_init = t-1;
+            }
+            else
+            {
+                RT_LOGI("Subtest-index-init value out of range\n");
+                return 0;
             }
         }
         if (k < argc && strcmp(argv[k], "-e") == 0 && ++k < argc)
@@ -853,6 +1659,46 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
             q_mode = RT_TRUE;
             RT_LOGI("Quality mode enabled: %d\n", q_mode);
         }
+        if (k < argc && strcmp(argv[k], "-u") == 0 && !u_mode)
+        {
+            u_mode = RT_TRUE;
+            RT_LOGI("Pipeline mode enabled: %d\n", u_mode);
+        }
+        if (k < argc && strcmp(argv[k], "-r") == 0 && !r_mode)
+        {
+            r_mode = RT_TRUE;
+            RT_LOGI("Async-run mode enabled: %d\n", r_mode);
+        }
+        if (k < argc && strcmp(argv[k], "-l") == 0 && !l_mode)
+        {
+            l_mode = RT_TRUE;
+            RT_LOGI("Split-run mode enabled: %d\n", l_mode);
+        }
+        if (k < argc && strcmp(argv[k], "-R") == 0 && !y_mode)
+        {
+            y_mode = RT_TRUE;
+            RT_LOGI("Dirty-run mode enabled: %d\n", y_mode);
+        }
+        if (k < argc && strcmp(argv[k], "-P") == 0 && !x_mode)
+        {
+            x_mode = RT_TRUE;
+            RT_LOGI("Packed-run mode enabled: %d\n", x_mode);
+        }
+        if (k < argc && strcmp(argv[k], "-M") == 0 && !m_mode)
+        {
+            m_mode = RT_TRUE;
+            RT_LOGI("Mipmap-run mode enabled: %d\n", m_mode);
+        }
+        if (k < argc && strcmp(argv[k], "-T") == 0 && !b_mode)
+        {
+            b_mode = RT_TRUE;
+            RT_LOGI("Tilebuf-run mode enabled: %d\n", b_mode);
+        }
+        if (k < argc && strcmp(argv[k], "-L") == 0 && !e_mode)
+        {
+            e_mode = RT_TRUE;
+            RT_LOGI("Linked-run mode enabled: %d\n", e_mode);
+        }
         if (k < argc && strcmp(argv[k], "-a") == 0)
         {
             rt_si32 aa_map[10] =
@@ -892,6 +1738,7 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
     rt_time time2 = 0;
     rt_time tN = 0;
     rt_time tF = 0;
+    rt_time tO = 0;
 
     x_res = x_res * (w_size != 0 ? w_size : 1);
     y_res = y_res * (w_size != 0 ? w_size : 1);
@@ -994,18 +1841,69 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
 
             scene->set_opts(RT_OPTS_FULL);
             q_test = scene->set_pton(q_mode);
+            scene->set_occ(v_mode);
+
+            rt_time tU = 0, tR = 0;
 
             time1 = get_time();
 
             for (j = 0; j < r_test; j++)
             {
                 scene->render(q_test ? 0 : j * f_time);
+
+                /* first frame builds all lists, not counted */
+                tU += j > 0 ? scene->get_t_update() : 0;
             }
 
             time2 = get_time();
             tF = time2 - time1;
+            tO = tF;
             RT_LOGI("Time F = %d\n", (rt_si32)tF);
 
+            if (v_mode)
+            {
+                rt_si32 k, thnum = (&pfm)->get_thnum();
+
+                /* compare update time with cross-frame lists kept
+                 * for unchanged objects to rebuilding them every frame
+                 * over the same animated frames (first one excluded),
+                 * replay ends on the last frame, keeping the image */
+                scene->set_keep(0);
+
+                for (j = 0; j < r_test; j++)
+                {
+                    scene->render(q_test ? 0 : j * f_time);
+                    tR += j > 0 ? scene->get_t_update() : 0;
+                }
+
+                scene->set_keep(1);
+
+                RT_LOGI("Update time (us/frame): kept = %d, rebuilt = %d\n",
+                                (rt_si32)(tU / RT_MAX(r_test - 1, 1)),
+                                (rt_si32)(tR / RT_MAX(r_test - 1, 1)));
+
+                /* print per-thread render load (busy/idle in ms) */
+                for (k = 0; k < thnum; k++)
+                {
+                    RT_LOGI("Thread %2d: busy = %d, idle = %d\n", k,
+                                (rt_si32)(scene->get_t_busy(k) / 1000),
+                                (rt_si32)(scene->get_t_idle(k) / 1000));
+                }
+
+                /* print update imbalance (max/avg of threads' time) */
+                RT_LOGI("Update imbalance: phase2 = %.2f, phase3 = %.2f\n",
+                                (rt_real)scene->get_imbalance(2),
+                                (rt_real)scene->get_imbalance(3));
+
+                /* print lane occupancy of secondary rays per bounce */
+                for (k = 1; scene->get_packets(k) > 0; k++)
+                {
+                    RT_LOGI("Bounce %2d: packets = %7d, lanes = %.2f\n", k,
+                                scene->get_packets(k),
+                                (rt_real)scene->get_occupancy(k));
+                }
+            }
+
             if (h_mode)
             {
                 scene->render_num(x_res-30, 10, -1, 2, 0);
@@ -1044,6 +1942,312 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
 
             delete scene;
             scene = RT_NULL;
+
+            if (u_mode)
+            { /* -->---->-- skip run2 -->---->-- */
+
+            /* ------------ test run2 ---------- */
+
+            o_test[i]();
+
+            scene->set_opts(RT_OPTS_FULL);
+            scene->set_pipe(RT_TRUE);
+            q_test = scene->set_pton(q_mode);
+
+            rt_time tP = 0;
+
+            time1 = get_time();
+
+            for (j = 0; j < r_test; j++)
+            {
+                scene->render(q_test ? 0 : j * f_time);
+
+                /* first update ahead builds all lists, not counted */
+                tP += j > 0 ? scene->get_t_update() : 0;
+            }
+
+            time2 = get_time();
+            tF = time2 - time1;
+            RT_LOGI("Time P = %d\n", (rt_si32)tF);
+
+            if (v_mode)
+            {
+                /* compare with the update before the render above */
+                RT_LOGI("Update time (us/frame): pipelined = %d\n",
+                                (rt_si32)(tP / RT_MAX(r_test - 1, 1)));
+            }
+
+            /* drain the pipeline to display the last frame */
+            scene->render(q_test ? 0 : (r_test - 1) * f_time);
+
+            if (!o_mode)
+            {
+                frame_cmp(frame, scene->get_frame());
+            }
+
+            delete scene;
+            scene = RT_NULL;
+
+            } /* --<----<-- skip run2 --<----<-- */
+
+            if (r_mode || l_mode)
+            { /* -->---->-- skip run3 -->---->-- */
+
+            /* ------------ test run3 ---------- */
+
+            /* render on scene's own thread-group */
+            (&pfm)->set_split(l_mode);
+
+            o_test[i]();
+
+            scene->set_opts(RT_OPTS_FULL);
+            scene->set_frames(2);
+            q_test = scene->set_pton(q_mode);
+
+            rt_si32 fence = 0;
+            rt_ui32 sum = 0;
+
+            time1 = get_time();
+
+            for (j = 0; j < r_test; j++)
+            {
+                fence = scene->render_async(q_test ? 0 : j * f_time);
+
+                /* read the previous frame while the next one renders */
+                sum += scene->get_frame()[j % (y_res * x_row)];
+            }
+
+            scene->wait_fence(fence);
+
+            time2 = get_time();
+            tF = time2 - time1;
+            RT_LOGI("Time A = %d (%08X)\n", (rt_si32)tF, sum);
+
+            if (!o_mode)
+            {
+                frame_cmp(frame, scene->get_frame());
+            }
+
+            delete scene;
+            scene = RT_NULL;
+
+            (&pfm)->set_split(RT_FALSE);
+
+            } /* --<----<-- skip run3 --<----<-- */
+
+            if (y_mode)
+            { /* -->---->-- skip run4 -->---->-- */
+
+            /* ------------ test run4 ---------- */
+
+            o_test[i]();
+
+            scene->set_opts(RT_OPTS_FULL | RT_OPTS_RENDER_EXT2);
+            q_test = scene->set_pton(q_mode);
+
+            time1 = get_time();
+
+            for (j = 0; j < r_test; j++)
+            {
+                scene->render(q_test ? 0 : j * f_time);
+            }
+
+            time2 = get_time();
+            tF = time2 - time1;
+            RT_LOGI("Time D = %d\n", (rt_si32)tF);
+
+            if (!o_mode)
+            {
+                frame_cmp(frame, scene->get_frame());
+            }
+
+            delete scene;
+            scene = RT_NULL;
+
+            } /* --<----<-- skip run4 --<----<-- */
+
+            if (x_mode)
+            { /* -->---->-- skip run5 -->---->-- */
+
+            /* ------------ test run5 ---------- */
+
+            /* map SIMD lanes to square pixel blocks,
+             * same rays as scanline, frames must match */
+            (&pfm)->set_pack(RT_TRUE);
+
+            o_test[i]();
+
+            scene->set_opts(RT_OPTS_FULL);
+            q_test = scene->set_pton(q_mode);
+            scene->set_occ(v_mode);
+
+            time1 = get_time();
+
+            for (j = 0; j < r_test; j++)
+            {
+                scene->render(q_test ? 0 : j * f_time);
+            }
+
+            time2 = get_time();
+            tF = time2 - time1;
+            RT_LOGI("Time B = %d\n", (rt_si32)tF);
+
+            if (v_mode)
+            {
+                rt_si32 k;
+
+                /* print lane occupancy of secondary rays per bounce */
+                for (k = 1; scene->get_packets(k) > 0; k++)
+                {
+                    RT_LOGI("Bounce %2d: packets = %7d, lanes = %.2f\n", k,
+                                scene->get_packets(k),
+                                (rt_real)scene->get_occupancy(k));
+                }
+            }
+
+            if (!o_mode)
+            {
+                frame_cmp(frame, scene->get_frame());
+            }
+
+            delete scene;
+            scene = RT_NULL;
+
+            (&pfm)->set_pack(RT_FALSE);
+
+            } /* --<----<-- skip run5 --<----<-- */
+
+            if (m_mode)
+            { /* -->---->-- skip run6 -->---->-- */
+
+            /* ------------ test run6 ---------- */
+
+            /* bilinear fetch from mip-levels picked by ray footprint,
+             * textured frames differ from nearest texel by design */
+            (&pfm)->set_filt(RT_TRUE);
+
+            o_test[i]();
+
+            scene->set_opts(RT_OPTS_FULL);
+            q_test = scene->set_pton(q_mode);
+
+            time1 = get_time();
+
+            for (j = 0; j < r_test; j++)
+            {
+                scene->render(q_test ? 0 : j * f_time);
+            }
+
+            time2 = get_time();
+            tF = time2 - time1;
+            RT_LOGI("Time M = %d\n", (rt_si32)tF);
+
+            if (i_mode)
+            {
+                scene->save_frame((i+1) * 10 + 4);
+            }
+
+            /* untextured frames must match nearest texel,
+             * textured frames are compared within a wider
+             * threshold to catch gross filtering errors */
+            if (!o_mode)
+            {
+                rt_si32 t_save = t_diff;
+
+                if (scene->get_mips() > 0)
+                {
+                    t_diff = RT_MAX(t_diff, MIP_DIFF);
+                }
+
+                frame_cmp(frame, scene->get_frame());
+
+                t_diff = t_save;
+            }
+
+            delete scene;
+            scene = RT_NULL;
+
+            (&pfm)->set_filt(RT_FALSE);
+
+            } /* --<----<-- skip run6 --<----<-- */
+
+            if (b_mode)
+            { /* -->---->-- skip run7 -->---->-- */
+
+            /* ------------ test run7 ---------- */
+
+            /* wider tiles with height not dividing the frame,
+             * same rays as default tiles, frames must match */
+            (&pfm)->set_tile(RT_TILE_W * 3, RT_TILE_H - 1);
+
+            o_test[i]();
+
+            scene->set_opts(RT_OPTS_FULL);
+            q_test = scene->set_pton(q_mode);
+
+            time1 = get_time();
+
+            for (j = 0; j < r_test; j++)
+            {
+                scene->render(q_test ? 0 : j * f_time);
+            }
+
+            time2 = get_time();
+            tF = time2 - time1;
+            RT_LOGI("Time T = %d (%dx%d)\n", (rt_si32)tF,
+                        (&pfm)->get_tile_w(), (&pfm)->get_tile_h());
+
+            if (!o_mode)
+            {
+                frame_cmp(frame, scene->get_frame());
+            }
+
+            delete scene;
+            scene = RT_NULL;
+
+            (&pfm)->set_tile(RT_TILE_W, RT_TILE_H);
+
+            } /* --<----<-- skip run7 --<----<-- */
+
+            if (e_mode)
+            { /* -->---->-- skip run8 -->---->-- */
+
+            /* ------------ test run8 ---------- */
+
+            /* tile lists as linked elements instead of contiguous runs,
+             * same elements in the same order, frames must match */
+            o_test[i]();
+
+            scene->set_opts(RT_OPTS_FULL & ~RT_OPTS_TILING_RUNS);
+            q_test = scene->set_pton(q_mode);
+
+            time1 = get_time();
+
+            for (j = 0; j < r_test; j++)
+            {
+                scene->render(q_test ? 0 : j * f_time);
+            }
+
+            time2 = get_time();
+            tF = time2 - time1;
+
+            /* primary rays (per sample) in millions per second
+             * for tile lists in runs (run1) and linked (run8) */
+            rt_real rays = (rt_real)x_res * y_res * (1 << a_mode) * r_test;
+
+            RT_LOGI("Time L = %d, Mrays/s: runs = %.2f, linked = %.2f\n",
+                        (rt_si32)tF, rays / 1000 / RT_MAX(tO, 1),
+                                     rays / 1000 / RT_MAX(tF, 1));
+
+            if (!o_mode)
+            {
+                frame_cmp(frame, scene->get_frame());
+            }
+
+            delete scene;
+            scene = RT_NULL;
+
+            } /* --<----<-- skip run8 --<----<-- */
         }
         catch (rt_Exception e)
         {
@@ -1090,6 +2294,9 @@ rt_byte *s_ptr = RT_ADDRESS_MIN;
 
 #endif /* RT_POINTER */
 
+/* bytes currently allocated from system heap */
+volatile rt_si64 s_size = 0;
+
 
 #if (defined RT_WIN32) || (defined RT_WIN64) /* Win32, MSVC -- Win64, GCC --- */
 
@@ -1107,6 +2314,42 @@ rt_time get_time()
     return (rt_time)(tm.QuadPart * 1000 / fr.QuadPart);
 }
 
+/*
+ * Start system thread running "func" with given "arg".
+ */
+struct rt_THR_START
+{
+    rt_pntr           (*func)(rt_pntr);
+    rt_pntr             arg;
+};
+
+DWORD WINAPI thr_entry(rt_pntr p)
+{
+    rt_THR_START *start = (rt_THR_START *)p;
+    rt_pntr (*func)(rt_pntr) = start->func;
+    rt_pntr arg = start->arg;
+    free(start);
+    func(arg);
+    return 0;
+}
+
+rt_pntr thr_start(rt_pntr (*func)(rt_pntr), rt_pntr arg)
+{
+    rt_THR_START *start = (rt_THR_START *)malloc(sizeof(rt_THR_START));
+    start->func = func;
+    start->arg = arg;
+    return CreateThread(NULL, 0, thr_entry, start, 0, NULL);
+}
+
+/*
+ * Wait for system thread to finish and release its handle.
+ */
+rt_void thr_join(rt_pntr thr)
+{
+    WaitForSingleObject((HANDLE)thr, INFINITE);
+    CloseHandle((HANDLE)thr);
+}
+
 DWORD s_step = 0;
 
 SYSTEM_INFO s_sys = {0};
@@ -1163,6 +2406,8 @@ rt_pntr sys_alloc(rt_size size)
         throw rt_Exception("alloc failed with NULL address in sys_alloc");
     }
 
+    atomic_add64(&s_size, (rt_si64)size);
+
     return ptr;
 }
 
@@ -1181,6 +2426,8 @@ rt_void sys_free(rt_pntr ptr, rt_size size)
 
 #endif /* RT_POINTER */
 
+    atomic_add64(&s_size, -(rt_si64)size);
+
 #if RT_DEBUG >= 2
 
     RT_LOGI("FREED PTR = %016" PR_Z "X, size = %ld\n", (rt_full)ptr, size);
@@ -1202,6 +2449,27 @@ rt_time get_time()
     return (rt_time)(tm.tv_sec * 1000 + tm.tv_usec / 1000);
 }
 
+#include <pthread.h>
+
+/*
+ * Start system thread running "func" with given "arg".
+ */
+rt_pntr thr_start(rt_pntr (*func)(rt_pntr), rt_pntr arg)
+{
+    pthread_t *pthr = (pthread_t *)malloc(sizeof(pthread_t));
+    pthread_create(pthr, NULL, func, arg);
+    return pthr;
+}
+
+/*
+ * Wait for system thread to finish and release its handle.
+ */
+rt_void thr_join(rt_pntr thr)
+{
+    pthread_join(*(pthread_t *)thr, NULL);
+    free(thr);
+}
+
 #if RT_POINTER == 64
 
 #include <sys/mman.h>
@@ -1262,6 +2530,8 @@ rt_pntr sys_alloc(rt_size size)
         throw rt_Exception("alloc failed with NULL address in sys_alloc");
     }
 
+    atomic_add64(&s_size, (rt_si64)size);
+
     return ptr;
 }
 
@@ -1280,6 +2550,8 @@ rt_void sys_free(rt_pntr ptr, rt_size size)
 
 #endif /* RT_POINTER */
 
+    atomic_add64(&s_size, -(rt_si64)size);
+
 #if RT_DEBUG >= 2
 
     RT_LOGI("FREED PTR = %016" PR_Z "X, size = %ld\n", (rt_full)ptr, size);